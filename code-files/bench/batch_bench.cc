@@ -0,0 +1,100 @@
+// Items/sec for ingesting small JSON objects one POST at a time versus through
+// POST /api/<Entity>/_batch, on each backend with and without durable writes.
+// Requests go straight through the handler (no sockets), so the single-request numbers
+// don't even include the per-request TCP connection a real client pays for.
+//
+// Usage: ./bin/batch_bench [items] [batch_size] [data_dir]
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <boost/log/core.hpp>
+#include "crud_handler.h"
+#include "file_system.h"
+#include "group_commit.h"
+#include "log_file_system.h"
+#include "request.h"
+#include "response.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const std::string kItem = "{\"name\": \"Mouse\", \"price\": 25, \"tags\": [\"usb\", \"wireless\"]}";
+
+request make_request(const std::string& uri, const std::string& body) {
+    request req;
+    req.method = "POST";
+    req.uri = uri;
+    req.http_version = "HTTP/1.1";
+    req.body = body;
+    return req;
+}
+
+// Prints items/sec for ingesting n items with one request per item and with batches.
+void run(const std::string& backend, const std::function<std::shared_ptr<FileSystemInterface>(const std::string&)>& open,
+         const fs::path& dir, size_t n, size_t batch_size) {
+    double single_rate = 0;
+    {
+        CrudHandler handler(open((dir / "single").string()));
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            handler.handle_request(make_request("/api/Products", kItem));
+        }
+        single_rate = n / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    double batch_rate = 0;
+    {
+        CrudHandler handler(open((dir / "batch").string()));
+        std::string ndjson;
+        for (size_t i = 0; i < batch_size; ++i) {
+            ndjson += "{\"op\": \"create\", \"body\": " + kItem + "}\n";
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (size_t done = 0; done < n; done += batch_size) {
+            handler.handle_request(make_request("/api/Products/_batch", ndjson));
+        }
+        batch_rate = n / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::cout << std::left << std::setw(14) << backend << std::right << std::fixed << std::setprecision(0)
+              << std::setw(12) << single_rate << std::setw(12) << batch_rate
+              << std::setprecision(1) << std::setw(9) << batch_rate / single_rate << "x\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // Keep per-request logging out of the measurements
+    boost::log::core::get()->set_logging_enabled(false);
+
+    size_t n = argc > 1 ? std::stoul(argv[1]) : 5000;
+    size_t batch_size = argc > 2 ? std::stoul(argv[2]) : 100;
+    fs::path root = argc > 3 ? fs::path(argv[3]) : fs::temp_directory_path() / "batch_bench";
+    fs::remove_all(root);
+
+    // Durable runs use a zero window: a lone sequential client gains nothing from waiting
+    const auto no_window = std::chrono::microseconds(0);
+    std::cout << std::left << std::setw(14) << "backend" << std::right << std::setw(12) << "single/s"
+              << std::setw(12) << "batch/s" << std::setw(10) << "speedup" << "\n";
+    run("file", [](const std::string& path) {
+        return std::make_shared<FileSystem>(path);
+    }, root / "file", n, batch_size);
+    run("file durable", [no_window](const std::string& path) {
+        fs::create_directories(path);
+        return std::make_shared<FileSystem>(path, GroupCommit::for_directory(path, no_window));
+    }, root / "file_durable", n, batch_size);
+    run("log", [](const std::string& path) {
+        return std::make_shared<LogFileSystem>(path);
+    }, root / "log", n, batch_size);
+    run("log durable", [no_window](const std::string& path) {
+        return std::make_shared<LogFileSystem>(path, LogFileSystem::kDefaultCheckpointMinBytes, true, no_window);
+    }, root / "log_durable", n, batch_size);
+    fs::remove_all(root);
+    return 0;
+}
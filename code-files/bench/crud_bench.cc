@@ -0,0 +1,105 @@
+// Compares CrudHandler throughput on the file-per-entity and log-structured backends,
+// on the file backend behind the entity cache, and with time-ordered (ULID) ids.
+// The in-memory backend does no I/O at all, so its numbers are the handler's own cost.
+// Each phase runs N requests straight through the handler (no sockets) against a
+// fresh data directory: POST N entities, GET each twice, PUT each, DELETE each.
+//
+// Usage: ./bin/crud_bench [entities] [data_dir]
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/log/core.hpp>
+#include "caching_file_system.h"
+#include "crud_handler.h"
+#include "file_system.h"
+#include "log_file_system.h"
+#include "memory_file_system.h"
+#include "request.h"
+#include "response.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+request make_request(const std::string& method, const std::string& uri, const std::string& body = "") {
+    request req;
+    req.method = method;
+    req.uri = uri;
+    req.http_version = "HTTP/1.1";
+    req.body = body;
+    return req;
+}
+
+// Pulls the id out of {"id": "..."}
+std::string parse_id(const std::string& body) {
+    size_t start = body.find(": \"") + 3;
+    return body.substr(start, body.find('"', start) - start);
+}
+
+// Times one phase and prints requests/sec.
+void phase(const std::string& backend, const std::string& name, size_t n,
+           const std::function<void(size_t)>& op) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        op(i);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::left << std::setw(10) << backend << std::setw(8) << name
+              << std::right << std::fixed << std::setprecision(0)
+              << std::setw(10) << n / seconds << " req/s\n";
+}
+
+void run(const std::string& backend, std::shared_ptr<FileSystemInterface> store, size_t n) {
+    CrudHandler handler(store);
+    std::vector<std::string> ids(n);
+    const std::string body = "{\"name\": \"Mouse\", \"price\": 25, \"tags\": [\"usb\", \"wireless\"]}";
+    const std::string updated = "{\"name\": \"Mouse\", \"price\": 20, \"tags\": [\"usb\", \"wireless\"]}";
+
+    phase(backend, "POST", n, [&](size_t i) {
+        auto res = handler.handle_request(make_request("POST", "/api/Products", body));
+        ids[i] = parse_id(res->body);
+    });
+    phase(backend, "GET", n, [&](size_t i) {
+        handler.handle_request(make_request("GET", "/api/Products/" + ids[i]));
+    });
+    // Second pass: every entity has been read once, so a cache serves all of these
+    phase(backend, "GET2", n, [&](size_t i) {
+        handler.handle_request(make_request("GET", "/api/Products/" + ids[i]));
+    });
+    phase(backend, "PUT", n, [&](size_t i) {
+        handler.handle_request(make_request("PUT", "/api/Products/" + ids[i], updated));
+    });
+    phase(backend, "DELETE", n, [&](size_t i) {
+        handler.handle_request(make_request("DELETE", "/api/Products/" + ids[i]));
+    });
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // Keep per-request logging out of the measurements
+    boost::log::core::get()->set_logging_enabled(false);
+
+    size_t n = argc > 1 ? std::stoul(argv[1]) : 10000;
+    fs::path root = argc > 2 ? fs::path(argv[2]) : fs::temp_directory_path() / "crud_bench";
+
+    fs::remove_all(root);
+    run("file", std::make_shared<FileSystem>((root / "file").string()), n);
+    run("log", std::make_shared<LogFileSystem>((root / "log").string()), n);
+    run("memory", std::make_shared<MemoryFileSystem>((root / "memory").string()), n);
+    run("cached", std::make_shared<CachingFileSystem>(std::make_shared<FileSystem>((root / "cached").string()),
+                                                      std::make_shared<EntityCache>(64 << 20)), n);
+    run("file-ulid", std::make_shared<FileSystem>((root / "file-ulid").string(), nullptr, FileSystem::Layout::kFlat,
+                                                  IdGenerator::Scheme::kUlid), n);
+    run("log-ulid", std::make_shared<LogFileSystem>((root / "log-ulid").string(),
+                                                    LogFileSystem::kDefaultCheckpointMinBytes, false,
+                                                    GroupCommit::kDefaultWindow, IdGenerator::Scheme::kUlid), n);
+    fs::remove_all(root);
+    return 0;
+}
@@ -0,0 +1,106 @@
+// Throughput of durable CrudHandler PUTs as a function of the group commit window.
+// A fixed number of concurrent clients (threads calling the handler directly, as the
+// commit pool does) overwrite their own entities for a fixed time; each configuration
+// gets its own data directory. The first row is the non-durable baseline.
+//
+// Usage: ./bin/group_commit_bench [clients] [seconds] [data_dir]
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/log/core.hpp>
+#include "crud_handler.h"
+#include "file_system.h"
+#include "group_commit.h"
+#include "request.h"
+#include "response.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void run(const std::string& label, const fs::path& dir, std::shared_ptr<GroupCommit> commit,
+         int clients, int seconds) {
+    auto store = std::make_shared<FileSystem>(dir.string(), commit);
+    CrudHandler handler(store, commit != nullptr);
+
+    std::vector<std::string> ids;
+    for (int i = 0; i < clients; ++i) {
+        ids.push_back(store->create_entity("Products").second);
+    }
+    GroupCommit::Stats before = commit ? commit->stats() : GroupCommit::Stats{};
+
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> failed{0};
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < clients; ++i) {
+        threads.emplace_back([&, i]() {
+            request req;
+            req.method = "PUT";
+            req.uri = "/api/Products/" + ids[i];
+            req.http_version = "HTTP/1.1";
+            for (uint64_t n = 0; std::chrono::steady_clock::now() < deadline; ++n) {
+                req.body = "{\"name\": \"Mouse\", \"price\": " + std::to_string(n) + "}";
+                if (handler.handle_request(req)->status_code == 200) {
+                    ++completed;
+                } else {
+                    ++failed;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::left << std::setw(14) << label
+              << std::right << std::fixed << std::setprecision(0)
+              << std::setw(9) << completed / elapsed << " req/s"
+              << std::setprecision(2) << std::setw(9) << 1000.0 * clients * elapsed / std::max<uint64_t>(completed, 1)
+              << " ms/req";
+    if (commit) {
+        GroupCommit::Stats after = commit->stats();
+        uint64_t flushes = after.flushes - before.flushes;
+        std::cout << std::setw(8) << flushes << " flushes"
+                  << std::setprecision(1) << std::setw(7)
+                  << static_cast<double>(after.requests - before.requests) / std::max<uint64_t>(flushes, 1)
+                  << " syncs/flush";
+    }
+    if (failed > 0) {
+        std::cout << "  (" << failed << " failed)";
+    }
+    std::cout << "\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // Keep per-request logging out of the measurements
+    boost::log::core::get()->set_logging_enabled(false);
+
+    int clients = argc > 1 ? std::stoi(argv[1]) : 32;
+    int seconds = argc > 2 ? std::stoi(argv[2]) : 3;
+    fs::path root = argc > 3 ? fs::path(argv[3]) : fs::temp_directory_path() / "group_commit_bench";
+
+    fs::remove_all(root);
+    fs::create_directories(root / "baseline");
+    run("no fsync", root / "baseline", nullptr, clients, seconds);
+    const int windows_us[] = {0, 250, 500, 1000, 2000, 5000};
+    for (int window : windows_us) {
+        fs::path dir = root / ("window_" + std::to_string(window));
+        fs::create_directories(dir);
+        auto commit = GroupCommit::for_directory(dir.string(), std::chrono::microseconds(window));
+        run("window " + std::to_string(window) + "us", dir, commit, clients, seconds);
+    }
+    fs::remove_all(root);
+    return 0;
+}
@@ -0,0 +1,83 @@
+// Throughput of validating CRUD request bodies: boost::property_tree::read_json (what
+// CrudHandler used to do), nlohmann::json::accept (SAX parse without building a DOM),
+// and JsonValidator, on generated documents of about 1KB, 100KB and 10MB.
+//
+// Usage: ./bin/json_validate_bench [min_seconds_per_case]
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <nlohmann/json.hpp>
+#include "json_validator.h"
+
+namespace {
+
+// Pretty-printed array of product records, grown until it reaches target bytes
+std::string make_document(size_t target) {
+    std::string doc = "{\n  \"products\": [\n";
+    for (int i = 0; doc.size() < target; ++i) {
+        if (i > 0) doc += ",\n";
+        doc += "    {\n      \"id\": " + std::to_string(i) +
+               ",\n      \"name\": \"Wireless Mouse model " + std::to_string(i) +
+               "\",\n      \"price\": 25.99,\n      \"in_stock\": true,\n"
+               "      \"description\": \"Ergonomic mouse with \\\"silent\\\" clicks and a 2.4GHz receiver\",\n"
+               "      \"tags\": [\"usb\", \"wireless\", \"office\"]\n    }";
+    }
+    doc += "\n  ]\n}\n";
+    return doc;
+}
+
+// Runs validate until min_seconds have passed and prints MB/s
+void measure(const std::string& label, const std::string& doc, double min_seconds,
+             const std::function<bool(const std::string&)>& validate) {
+    size_t runs = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    do {
+        if (!validate(doc)) {
+            std::cerr << label << " rejected the document\n";
+            return;
+        }
+        ++runs;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < min_seconds);
+    double mb_per_s = static_cast<double>(doc.size()) * runs / elapsed / (1024 * 1024);
+    std::cout << std::left << std::setw(16) << label << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << mb_per_s << " MB/s" << std::setw(14) << std::setprecision(2)
+              << elapsed / runs * 1e6 << " us/doc\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    double min_seconds = argc > 1 ? std::stod(argv[1]) : 1.0;
+
+    for (size_t size : {size_t{1024}, size_t{100 * 1024}, size_t{10 * 1024 * 1024}}) {
+        std::string doc = make_document(size);
+        std::cout << "--- " << doc.size() << " bytes ---\n";
+        measure("property_tree", doc, min_seconds, [](const std::string& body) {
+            // Same steps CrudHandler used to take
+            std::stringstream ss;
+            ss << body;
+            boost::property_tree::ptree pt;
+            try {
+                boost::property_tree::read_json(ss, pt);
+            } catch (const boost::property_tree::json_parser_error&) {
+                return false;
+            }
+            return true;
+        });
+        measure("nlohmann accept", doc, min_seconds, [](const std::string& body) {
+            return nlohmann::json::accept(body);
+        });
+        measure("JsonValidator", doc, min_seconds, [](const std::string& body) {
+            return JsonValidator::validate(body);
+        });
+    }
+    return 0;
+}
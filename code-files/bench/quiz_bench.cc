@@ -0,0 +1,116 @@
+// Quiz submissions and share-link views/sec through ResultHandler, and quiz page and
+// listing views/sec through QuizHandler, with the quiz catalog warm and with the quiz
+// dropped from it before every request. Cold runs read and parse the quiz file (and render the page) per request, which
+// is what every request cost before the catalog and the page cache.
+// Requests go straight through the handler (no sockets); the handler is created per
+// request like the dispatcher does.
+//
+// Usage: ./bin/quiz_bench [requests] [quiz_dir]
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <boost/log/core.hpp>
+#include "quiz_catalog.h"
+#include "quiz_handler.h"
+#include "request.h"
+#include "response.h"
+#include "result_handler.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// A quiz the size of the ones users create: 10 questions of 4 options, 4 results
+void write_quiz(const fs::path& path) {
+    const std::string keys[] = {"bplate", "epicuria", "de-neve", "rende-west"};
+    std::ofstream file(path);
+    file << "{\"title\": \"Which dining hall are you?\", \"questions\": [";
+    for (int q = 0; q < 10; ++q) {
+        file << (q ? ", " : "") << "{\"prompt\": \"Question " << q << ": pick the one that fits you best\", "
+             << "\"image\": \"q" << q << ".jpg\", \"options\": [";
+        for (int o = 0; o < 4; ++o) {
+            file << (o ? ", " : "") << "{\"text\": \"Answer " << o << " to question " << q
+                 << "\", \"value\": \"" << keys[o] << "\"}";
+        }
+        file << "]}";
+    }
+    file << "], \"results\": {";
+    for (int r = 0; r < 4; ++r) {
+        file << (r ? ", " : "") << "\"" << keys[r] << "\": {\"title\": \"You're " << keys[r]
+             << "!\", \"description\": \"" << std::string(300, 'x') << "\", \"image\": \"" << keys[r] << ".jpg\"}";
+    }
+    file << "}}";
+}
+
+request make_request(const std::string& method, const std::string& uri, const std::string& body = "") {
+    request req;
+    req.method = method;
+    req.uri = uri;
+    req.http_version = "HTTP/1.1";
+    req.body = body;
+    return req;
+}
+
+// Times n requests and prints requests/sec.
+void run(const std::string& name, size_t n, const std::function<void()>& before_each,
+         const std::function<std::unique_ptr<response>()>& handle) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        before_each();
+        if (handle()->status_code != 200) {
+            std::cerr << name << " failed\n";
+            return;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::left << std::setw(14) << name
+              << std::right << std::fixed << std::setprecision(0)
+              << std::setw(10) << n / seconds << " req/s\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // Keep per-request logging out of the measurements
+    boost::log::core::get()->set_logging_enabled(false);
+
+    size_t n = argc > 1 ? std::stoul(argv[1]) : 20000;
+    fs::path dir = argc > 2 ? fs::path(argv[2]) : fs::temp_directory_path() / "quiz_bench";
+
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    write_quiz(dir / "dining.json");
+    // Age the files past the catalog's racy window so warm runs measure steady state
+    auto old = fs::file_time_type::clock::now() - std::chrono::hours(1);
+    fs::last_write_time(dir / "dining.json", old);
+    fs::last_write_time(dir, old);
+    auto catalog = QuizCatalog::shared(dir.string());
+
+    auto cold = [&catalog]() { catalog->invalidate("dining"); };
+    auto warm = []() {};
+    request submit = make_request("POST", "/quiz/submit",
+                                  "q0=epicuria&q1=bplate&q2=epicuria&q3=de-neve&q4=epicuria&q5=bplate&q6=epicuria"
+                                  "&q7=rende-west&q8=epicuria&q9=bplate&quiz_id=dining");
+    auto submit_once = [&]() { return ResultHandler(dir.string()).handle_request(submit); };
+    request share = make_request("GET", "/quiz/submit?quiz_id=dining&result=epicuria");
+    auto share_once = [&]() { return ResultHandler(dir.string()).handle_request(share); };
+    request view = make_request("GET", "/quiz/dining");
+    auto view_once = [&]() { return QuizHandler(dir.string()).handle_request(view); };
+    request listing = make_request("GET", "/quiz");
+    auto list_once = [&]() { return QuizHandler(dir.string()).handle_request(listing); };
+
+    run("submit cold", n, cold, submit_once);
+    run("submit warm", n, warm, submit_once);
+    run("share warm", n, warm, share_once);
+    run("view cold", n, cold, view_once);
+    run("view warm", n, warm, view_once);
+    run("list warm", n, warm, list_once);
+    fs::remove_all(dir);
+    return 0;
+}
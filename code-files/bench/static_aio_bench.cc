@@ -0,0 +1,142 @@
+// Measures /health latency while another client streams large files that are
+// evicted from the page cache before every request. With aio off, each cold read
+// blocks the io_service thread and /health waits behind it; with aio on, the read
+// runs on the disk read pool and /health keeps being answered.
+//
+// Usage: ./bin/static_aio_bench [seconds] [file_mb] [port]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/log/core.hpp>
+#include "server.h"
+#include "health_handler.h"
+#include "not_found_handler.h"
+#include "static_file_handler.h"
+
+namespace fs = std::filesystem;
+using boost::asio::ip::tcp;
+
+namespace {
+
+constexpr int kFiles = 4;
+
+// Sends one request on a fresh connection and drains the response.
+// @return: bytes received.
+size_t fetch(unsigned short port, const std::string& uri) {
+    boost::asio::io_context io;
+    tcp::socket socket(io);
+    socket.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), port));
+    std::string req = "GET " + uri + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    boost::asio::write(socket, boost::asio::buffer(req));
+    size_t total = 0;
+    char buffer[64 * 1024];
+    boost::system::error_code ec;
+    while (!ec) {
+        total += socket.read_some(boost::asio::buffer(buffer), ec);
+    }
+    return total;
+}
+
+// Drops a file from the page cache so the next read has to go to disk.
+void evict(const fs::path& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        ::fdatasync(fd);
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+}
+
+double percentile(std::vector<double>& samples, double p) {
+    if (samples.empty()) {
+        return 0;
+    }
+    size_t index = std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+void run(const std::string& label, bool aio, const fs::path& root, unsigned short port, int seconds) {
+    ConfigStruct health{"/health", "HealthHandler", {}};
+    ConfigStruct files{"/files", "StaticFileHandler",
+                       {{"mount_point", "/files"}, {"doc_root", root.string()}, {"aio", aio ? "on" : "off"}}};
+    TrieNode trie_root;
+    trie_root.insert(health.uri, &health);
+    trie_root.insert(files.uri, &files);
+
+    RequestHandlerFactory factory;
+    factory.register_factory("HealthHandler", &HealthHandler::create);
+    factory.register_factory("StaticFileHandler", &StaticFileHandler::create);
+    factory.register_factory("NotFoundHandler", &NotFoundHandler::create);
+
+    boost::asio::io_service io_service;
+    server srv(io_service, static_cast<short>(port), &trie_root, factory);
+    std::thread loop([&io_service] { io_service.run(); });
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+    std::atomic<size_t> streamed{0};
+    std::thread streamer([&] {
+        for (int i = 0; std::chrono::steady_clock::now() < deadline; i = (i + 1) % kFiles) {
+            std::string name = "large" + std::to_string(i) + ".bin";
+            evict(root / name);
+            streamed += fetch(port, "/files/" + name);
+        }
+    });
+
+    std::vector<double> latencies;
+    while (std::chrono::steady_clock::now() < deadline) {
+        auto start = std::chrono::steady_clock::now();
+        fetch(port, "/health");
+        latencies.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    streamer.join();
+    io_service.stop();
+    loop.join();
+
+    double p50 = percentile(latencies, 0.50);
+    double p99 = percentile(latencies, 0.99);
+    double max = percentile(latencies, 1.0);
+    std::cout << std::left << std::setw(10) << label
+              << std::right << std::fixed << std::setprecision(2)
+              << " /health n=" << latencies.size()
+              << " p50=" << p50 << "ms p99=" << p99 << "ms max=" << max << "ms"
+              << "  streamed=" << streamed / (1024 * 1024) << "MB\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // Keep per-request logging out of the measurements
+    boost::log::core::get()->set_logging_enabled(false);
+
+    int seconds = argc > 1 ? std::stoi(argv[1]) : 5;
+    size_t file_mb = argc > 2 ? std::stoul(argv[2]) : 64;
+    unsigned short port = argc > 3 ? static_cast<unsigned short>(std::stoi(argv[3])) : 18089;
+
+    fs::path root = fs::temp_directory_path() / "static_aio_bench";
+    fs::create_directories(root);
+    std::string chunk(1024 * 1024, 'x');
+    for (int i = 0; i < kFiles; ++i) {
+        std::ofstream out(root / ("large" + std::to_string(i) + ".bin"), std::ios::binary);
+        for (size_t mb = 0; mb < file_mb; ++mb) {
+            out << chunk;
+        }
+    }
+
+    run("aio off", false, root, port, seconds);
+    run("aio on", true, root, port + 1, seconds);
+    fs::remove_all(root);
+    return 0;
+}
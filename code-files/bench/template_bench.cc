@@ -0,0 +1,163 @@
+// Render time and heap allocations per quiz page for the compiled HtmlTemplates in
+// quiz_pages against the ostringstream rendering the quiz handlers used before. Both
+// render the same 10-question quiz and the same result page; allocations are counted by
+// replacing the global operator new in this binary.
+//
+// Usage: ./bin/template_bench [renders]
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include "asset_manifest.h"
+#include "quiz_catalog.h"
+#include "quiz_pages.h"
+
+namespace {
+
+std::atomic<size_t> allocations{0};
+
+} // namespace
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+// Same shape as quiz_bench's quiz: 10 questions of 4 options, 4 results
+Quiz make_quiz() {
+    const std::string keys[] = {"bplate", "epicuria", "de-neve", "rende-west"};
+    Quiz quiz;
+    quiz.title = "Which dining hall are you?";
+    for (int q = 0; q < 10; ++q) {
+        QuizQuestion question;
+        question.prompt = "Question " + std::to_string(q) + ": pick the one that fits you best";
+        question.image = "q" + std::to_string(q) + ".jpg";
+        for (int o = 0; o < 4; ++o) {
+            question.options.push_back({"Answer " + std::to_string(o) + " to question " + std::to_string(q), keys[o]});
+        }
+        quiz.questions.push_back(question);
+    }
+    for (const auto& key : keys) {
+        quiz.results[key] = {"You're " + key + "!", std::string(300, 'x'), key + ".jpg"};
+    }
+    return quiz;
+}
+
+std::string escape_html(const std::string& input) {
+    std::ostringstream out;
+    for (char c : input) {
+        switch (c) {
+            case '&': out << "&amp;"; break;
+            case '<': out << "&lt;"; break;
+            case '>': out << "&gt;"; break;
+            case '"': out << "&quot;"; break;
+            case '\'': out << "&#39;"; break;
+            default: out << c;
+        }
+    }
+    return out.str();
+}
+
+// The quiz form as QuizHandler rendered it before the templates
+std::string stream_quiz_page(const std::string& quiz_id, const Quiz& quiz) {
+    std::ostringstream body;
+    body << "<html><head><link rel=\"stylesheet\" href=\"" << AssetManifest::url("/static/quizzes/styles.css") << "\"></head><body><div class='container'>";
+    body << "<h1>" << escape_html(quiz.title) << "</h1>";
+    body << "<form action=\"/quiz/submit\" method=\"POST\">";
+    int q_num = 0;
+    for (const auto& question : quiz.questions) {
+        if (!question.image.empty()) {
+            body << "<div style='text-align: center; margin-bottom: 15px;'>";
+            body << "<img src=\"" << escape_html(AssetManifest::url("/static/quizzes/" + question.image))
+                 << "\" style=\"max-width: 100%; width: 400px; height: auto; border-radius: 8px; box-shadow: 0 4px 8px rgba(0,0,0,0.1);\" />";
+            body << "</div>";
+        }
+        body << "<p>" << escape_html(question.prompt) << "</p>";
+        body << "<div class='quiz-options'>";
+        for (const auto& option : question.options) {
+            body << "<label class='quiz-option'>";
+            body << "<input type=\"radio\" name=\"q" << q_num << "\" value='" << escape_html(option.value) << "' />";
+            body << "<span>" << escape_html(option.text) << "</span>";
+            body << "</label>";
+        }
+        body << "</div>";
+        ++q_num;
+    }
+    body << "<input type=\"hidden\" name=\"quiz_id\" value=\"" << quiz_id << "\">";
+    body << "<input type=\"submit\" value=\"Submit\">";
+    body << "</form></div></body></html>";
+    return body.str();
+}
+
+// A result page as ResultHandler rendered it before the templates
+std::string stream_result_page(const std::string& quiz_id, const std::string& result_key, const QuizResult& result) {
+    std::ostringstream body;
+    body << "<html><head><link rel=\"stylesheet\" href=\"" << AssetManifest::url("/static/quizzes/styles.css") << "\"></head><body><div class='container'>";
+    body << "<h1>" << escape_html(result.title) << "</h1>";
+    body << "<p>" << escape_html(result.description) << "</p>";
+    if (!result.image.empty()) {
+        body << "<div style='text-align: center; margin-bottom: 15px;'>";
+        body << "<img src=\"" << escape_html(AssetManifest::url("/static/quizzes/" + result.image))
+             << "\" style=\"max-width: 100%; width: 400px; height: auto; border-radius: 8px; box-shadow: 0 4px 8px rgba(0,0,0,0.1);\" />";
+        body << "</div>";
+    }
+    body << "<br><a href=\"/quiz\">Take another quiz</a>";
+    std::string share_link = "/quiz/submit?quiz_id=" + quiz_id + "&result=" + result_key;
+    body << "<div class='share-section'>";
+    body << "<p>Want to share your result?</p>";
+    body << "<input type=\"text\" value=\"" << share_link << "\" id=\"shareLink\" readonly>";
+    body << "<br>";
+    body << "<button onclick=\"navigator.clipboard.writeText(document.getElementById('shareLink').value)\">Copy Link</button>";
+    body << "</div></body></html>";
+    return body.str();
+}
+
+// Times n renders and prints the time and allocations per render.
+void run(const std::string& name, size_t n, const std::function<std::string()>& render) {
+    size_t bytes = 0;
+    size_t before = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        bytes += render().size();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double allocs = double(allocations.load() - before) / n;
+    std::cout << std::left << std::setw(22) << name
+              << std::right << std::fixed << std::setprecision(0)
+              << std::setw(8) << seconds * 1e9 / n << " ns/render"
+              << std::setprecision(1) << std::setw(8) << allocs << " allocs/render"
+              << std::setw(8) << bytes / n << " bytes\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t n = argc > 1 ? std::stoul(argv[1]) : 50000;
+    Quiz quiz = make_quiz();
+    const QuizResult& result = quiz.results.at("epicuria");
+
+    run("quiz ostringstream", n, [&]() { return stream_quiz_page("dining", quiz); });
+    run("quiz template", n, [&]() { return render_quiz_page("dining", quiz); });
+    run("result ostringstream", n, [&]() { return stream_result_page("dining", "epicuria", result); });
+    run("result template", n, [&]() { return render_result_page("dining", "epicuria", result); });
+    return 0;
+}
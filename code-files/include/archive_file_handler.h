@@ -0,0 +1,39 @@
+#ifndef ARCHIVE_FILE_HANDLER_H
+#define ARCHIVE_FILE_HANDLER_H
+
+#include "request_handler.h"
+#include "zip_archive.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+class ArchiveFileHandler : public RequestHandler {
+public:
+
+    // Constructs an ArchiveFileHandler to serve files out of a zip archive.
+    // @param mount_point: URL prefix to match (e.g., "/assets/").
+    // @param archive_path: path of the .zip file on disk (e.g. "/app/static/images.zip").
+    // @throws std::runtime_error if the archive can't be mapped or indexed.
+    ArchiveFileHandler(const std::string& mount_point,
+                       const std::string& archive_path);
+
+    // Factory method 
+    // @param args: dictionary of argument names to values 
+    static std::unique_ptr<RequestHandler> create(const std::unordered_map<std::string, std::string>& args); 
+
+    // Serves an archive entry under mount_point_ based on the request URI.
+    // Stored entries are copied straight from the mapping; deflated entries are sent
+    // as-is with Content-Encoding: gzip when the client accepts it, else inflated.
+    // @return: Unique pointer to HTTP response with 200 OK and entry content, or 404 Not Found.
+    virtual std::unique_ptr<response> handle_request(const request& req) override;
+
+private:
+    // Wraps a zip entry's raw deflate stream in a gzip member without recompressing.
+    // The gzip trailer needs the CRC-32 and size, which the central directory already has.
+    static std::string gzip_wrap(const ZipArchive::Entry& entry, std::string_view deflated);
+
+    std::string mount_point_; // URI prefix this handler responds to.
+    std::shared_ptr<ZipArchive> archive_; // Shared mapping and central directory index.
+};
+
+#endif // ARCHIVE_FILE_HANDLER_H
@@ -0,0 +1,108 @@
+#ifndef ASSET_MANIFEST_H
+#define ASSET_MANIFEST_H
+
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <sys/stat.h>
+#include "open_file_cache.h"
+
+// Content-hashed names for the files under a static mount point.
+// Built once at startup: every file under doc_root gets a fingerprinted alias
+// ("quizzes/styles.css" -> "quizzes/styles.1a2b3c4d5e6f.css") whose URL changes
+// whenever the file's contents change, so it can be cached as immutable.
+//
+// Each alias remembers the size, mtime and inode of the file it was hashed from. A file
+// changed after startup no longer matches, so its old alias stops being served as
+// immutable and the file is hashed again to get a new alias.
+class AssetManifest {
+public:
+    // Cache-Control sent with fingerprinted responses (one year, never revalidated).
+    static constexpr const char* kImmutableCacheControl = "public, max-age=31536000, immutable";
+
+    // Scans and hashes every regular file under doc_root.
+    // @param mount_point: URL prefix the files are served under (e.g., "/static").
+    // @param doc_root: directory the StaticFileHandler serves from.
+    AssetManifest(const std::string& mount_point, const std::string& doc_root);
+
+    AssetManifest(const AssetManifest&) = delete;
+    AssetManifest& operator=(const AssetManifest&) = delete;
+
+    // Maps a fingerprinted path relative to the mount point back to the file it names.
+    // @param rel_path: e.g. "quizzes/styles.1a2b3c4d5e6f.css".
+    // @param original: receives the original relative path, e.g. "quizzes/styles.css".
+    // @return: false if rel_path isn't fingerprinted.
+    bool resolve(const std::string& rel_path, std::string& original) const;
+
+    // Checks that a fingerprinted name still describes the file now open under it, with one
+    // fstat of its descriptor (the open file cache may hold stat results up to its validity
+    // window old). If the file changed, it is hashed again so fingerprinted_url() and url()
+    // hand out a name for the new contents.
+    // @param rel_path: the fingerprinted path, e.g. "quizzes/styles.1a2b3c4d5e6f.css".
+    // @param file: the original file, opened.
+    // @return: true if the file still has the hashed contents and may be sent as immutable.
+    bool is_current(const std::string& rel_path, const OpenFile& file) const;
+
+    // Returns the fingerprinted URL for a path relative to the mount point.
+    // @param rel_path: e.g. "quizzes/styles.css".
+    // @return: full fingerprinted URL, or empty string if the file wasn't fingerprinted.
+    std::string fingerprinted_url(const std::string& rel_path) const;
+
+    // Number of fingerprinted files.
+    size_t size() const;
+
+    // Inserts the content hash before the extension.
+    // @param rel_path: e.g. "quizzes/styles.css".
+    // @param hash: hex content hash.
+    // @return: e.g. "quizzes/styles.<hash>.css".
+    static std::string fingerprint_name(const std::string& rel_path, const std::string& hash);
+
+    // Registers a manifest for its mount point so handlers can look it up.
+    static void install(std::shared_ptr<const AssetManifest> manifest);
+
+    // Returns the manifest installed for a mount point, or nullptr.
+    // @param mount_point: with or without a trailing slash.
+    static std::shared_ptr<const AssetManifest> for_mount(const std::string& mount_point);
+
+    // Lookup API for handlers that emit asset links: rewrites a static URL to its
+    // fingerprinted form if a manifest covers it, and returns it unchanged otherwise.
+    // The longest installed mount point that prefixes the URL is used.
+    // @param url: e.g. "/static/quizzes/styles.css".
+    // @return: e.g. "/static/quizzes/styles.1a2b3c4d5e6f.css".
+    static std::string url(const std::string& url);
+
+    // Removes every installed manifest (used by tests).
+    static void clear();
+
+private:
+    // What identifies the version of a file that was hashed
+    struct Stamp {
+        off_t size = 0;
+        struct timespec mtime = {0, 0};
+        ino_t ino = 0;
+
+        static Stamp of(const struct stat& st);
+        bool operator==(const Stamp& other) const;
+    };
+
+    // One side of an alias: the name on the other side and the file version hashed
+    struct Asset {
+        std::string name;
+        Stamp stamp;
+    };
+
+    // Hashes rel_path and records its alias. Caller holds no lock.
+    // @param expected: if set, the alias is only recorded if the file still has this stamp.
+    // @return: the fingerprinted name, or empty string if the file couldn't be hashed
+    //          or changed while being read.
+    std::string fingerprint(const std::string& rel_path, const Stamp* expected) const;
+
+    std::string mount_point_; // URL prefix without trailing slash
+    std::string doc_root_;
+    mutable std::shared_mutex mutex_;
+    mutable std::unordered_map<std::string, Asset> by_path_;        // "a/b.css" -> "a/b.<hash>.css"
+    mutable std::unordered_map<std::string, Asset> by_fingerprint_; // "a/b.<hash>.css" -> "a/b.css"
+};
+
+#endif // ASSET_MANIFEST_H
@@ -0,0 +1,61 @@
+#ifndef CACHING_FILE_SYSTEM_H
+#define CACHING_FILE_SYSTEM_H
+
+#include <memory>
+#include "entity_cache.h"
+#include "file_system_interface.h"
+
+// Read-through cache in front of another entity store.
+// Reads are served from an EntityCache when possible and fill it on a miss;
+// every mutation goes to the wrapped store first and then invalidates the entity.
+class CachingFileSystem : public FileSystemInterface {
+public:
+    // @param inner: the store that owns the data.
+    // @param cache: cache shared by every handler using the same data path.
+    CachingFileSystem(std::shared_ptr<FileSystemInterface> inner, std::shared_ptr<EntityCache> cache);
+
+    std::pair<bool, std::string> create_entity(const std::string &name) override;
+
+    std::pair<bool, std::string> read_entity(const std::string &name, const std::string &id) const override;
+
+    // Same as read_entity, also reporting whether the cache answered.
+    // @param hit: set to true if the body came from the cache.
+    std::pair<bool, std::string> read_entity(const std::string &name, const std::string &id, bool &hit) const;
+
+    // Bypasses the cache, which only holds plain bodies, so a compressed body is still
+    // read as stored rather than from a decoded copy.
+    bool read_entity_stored(const std::string &name, const std::string &id, StoredEntity &entity) const override;
+
+    bool write_entity(const std::string &name, const std::string &id, const std::string &data) override;
+
+    bool delete_entity(const std::string &name, const std::string &id) override;
+
+    std::pair<bool, std::vector<std::string>> list_entities(const std::string &name) const override;
+
+    bool exists(const std::string& entity, const std::string& id) const override;
+
+    bool put_entity(const std::string &name, const std::string &id, const std::string &data, bool &created) override;
+
+    bool update_entity(const std::string &name, const std::string &id,
+                       const std::function<bool(std::string &data)> &mutate, bool &found) override;
+
+    bool delete_entity_if(const std::string &name, const std::string &id,
+                          const std::function<bool(const std::string &data)> &precondition, bool &found) override;
+
+    bool apply_batch(std::vector<BatchOp>& ops) override;
+
+    bool list_entities_page(const std::string &name, const std::string &after, size_t limit,
+                            std::vector<std::string> &ids, bool &more) const override;
+
+    std::vector<std::string> list_entity_types() const override;
+
+    const std::string& get_data_path() const override;
+
+    const EntityCache& cache() const { return *cache_; }
+
+private:
+    std::shared_ptr<FileSystemInterface> inner_;
+    std::shared_ptr<EntityCache> cache_;
+};
+
+#endif // CACHING_FILE_SYSTEM_H
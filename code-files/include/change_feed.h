@@ -0,0 +1,99 @@
+#ifndef CHANGE_FEED_H
+#define CHANGE_FEED_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Sequenced log of entity changes for one data path, behind GET /api/<Entity>/_changes.
+// Every successful create, PUT and DELETE through a CrudHandler, and every entity the ttl
+// reaper removes, is recorded with the next sequence number, so a client holding the last
+// seq it saw can ask for just what changed since. Changes made outside the server (by
+// another process, or by hand) aren't seen; migrate_entities only moves files.
+// Only the most recent changes are kept in memory; a client that falls further behind
+// (or asks across a restart, when numbering starts again) has to relist.
+// Clients waiting for the next change are parked as callbacks, not threads: a change
+// runs them on the writer's thread, and one timer thread per feed runs expired ones.
+class ChangeFeed {
+public:
+    struct Change {
+        uint64_t seq;
+        std::string name; // entity type
+        std::string id;
+        bool deleted;
+    };
+
+    // Changes kept for catching up.
+    static constexpr size_t kDefaultRetention = 10000;
+
+    // Called once, with no lock held, when a parked wait ends.
+    // @param timed_out: true if no change arrived before the deadline.
+    using Callback = std::function<void(bool timed_out)>;
+
+    explicit ChangeFeed(size_t retention = kDefaultRetention);
+    // Ends every parked wait as timed out.
+    ~ChangeFeed();
+
+    ChangeFeed(const ChangeFeed&) = delete;
+    ChangeFeed& operator=(const ChangeFeed&) = delete;
+
+    // Appends a change and wakes the waits parked on its entity type.
+    // @return: the change's sequence number.
+    uint64_t record(const std::string& name, const std::string& id, bool deleted);
+
+    // Collects the changes to a type after a sequence number, oldest first.
+    // @param since: last seq the client has seen; 0 for everything retained.
+    // @param changes: receives the changes.
+    // @param last_seq: receives the newest seq in the feed; resuming from it misses nothing.
+    // @return: false if changes after since may have been dropped, or since is from the future.
+    bool changes_since(const std::string& name, uint64_t since, std::vector<Change>& changes,
+                       uint64_t& last_seq) const;
+
+    // Runs callback once the type changes after since, or once timeout passes.
+    // Runs it right away if such a change already exists.
+    // @return: a token for cancel(), or 0 if callback already ran.
+    uint64_t wait(const std::string& name, uint64_t since, std::chrono::milliseconds timeout, Callback callback);
+
+    // Ends a parked wait early, running its callback as timed out; does nothing if it already ended.
+    // @param token: returned by wait().
+    void cancel(const std::string& name, uint64_t token);
+
+    // Sequence number of the newest change; 0 before the first.
+    uint64_t last_seq() const;
+
+    // Number of parked waits.
+    size_t waiting() const;
+
+    // Returns the process-wide feed for a data path; handlers are created per request.
+    static std::shared_ptr<ChangeFeed> shared(const std::string& data_path);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Ends waits whose deadline has passed; runs until the feed is destroyed.
+    void run_timer();
+
+    size_t retention_;
+    mutable std::mutex mutex_;
+    std::condition_variable timer_cv_;
+    std::deque<Change> changes_;   // oldest first
+    uint64_t last_seq_ = 0;
+    uint64_t last_token_ = 0;
+    // type -> token -> parked callback
+    std::unordered_map<std::string, std::map<uint64_t, Callback>> waiting_;
+    // deadline -> (type, token); entries whose wait already ended are skipped
+    std::multimap<Clock::time_point, std::pair<std::string, uint64_t>> deadlines_;
+    bool stopping_ = false;
+    std::thread timer_; // started by the first wait
+};
+
+#endif // CHANGE_FEED_H
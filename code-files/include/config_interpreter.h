@@ -26,6 +26,21 @@ void process_config_file(std::ifstream& config_file, NginxConfig& config);
 // @return: value string if found, else empty string.
 std::string find_value_for_key(const NginxConfig* config_block, const std::string& key);
 
+// Copies an optional directive from a location block into the handler args.
+// Leaves config.args untouched if the directive is absent.
+// @param config_block: pointer to the location's child block (may be null).
+// @param key: the directive name to look up.
+// @param config: ConfigStruct whose args receive the value under the same key.
+void copy_optional_arg(const NginxConfig* config_block, const std::string& key, ConfigStruct& config);
+
+// Collects a directive that may repeat or take several values (e.g. "index name price;")
+// into one comma-separated arg. Only the block's own statements are searched.
+// Leaves config.args untouched if the directive is absent.
+// @param config_block: pointer to the location's child block (may be null).
+// @param key: the directive name to look up.
+// @param config: ConfigStruct whose args receive the values under the same key.
+void copy_list_arg(const NginxConfig* config_block, const std::string& key, ConfigStruct& config);
+
 // Extracts the port number from the "listen" directive.
 // @param config_block: pointer to the config block to search.
 // @return: port number as a short; returns -1 if not found or invalid.
@@ -5,25 +5,144 @@
 #include "logger.h" 
 #include "file_system.h"
 #include "file_system_interface.h"
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/json_parser.hpp>
+#include "caching_file_system.h"
+#include "field_index.h"
+#include "change_feed.h"
+#include "expiry_index.h"
 
 class CrudHandler : public RequestHandler {
 public:
-    CrudHandler(std::shared_ptr<FileSystemInterface> file_system);
+    // @param file_system: entity storage backend.
+    // @param durable: file_system waits for group commits, so requests are run on the commit
+    //                 pool where concurrent ones can share a flush instead of blocking the event loop.
+    // @param index: secondary field indexes kept current on every write; null if none are configured.
+    // @param feed: change feed every write is recorded in; null disables _changes.
+    // @param expiry: deadlines of entities written with a TTL; null ignores TTLs.
+    // @param default_ttl: TTL for writes without an X-TTL header; zero means they don't expire.
+    // @param compressed: file_system stores compressed bodies, so GETs negotiate Content-Encoding.
+    CrudHandler(std::shared_ptr<FileSystemInterface> file_system, bool durable = false,
+                std::shared_ptr<FieldIndex> index = nullptr, std::shared_ptr<ChangeFeed> feed = nullptr,
+                std::shared_ptr<ExpiryIndex> expiry = nullptr, std::chrono::seconds default_ttl = std::chrono::seconds(0),
+                bool compressed = false);
 
     static std::unique_ptr<RequestHandler> create(const std::unordered_map<std::string, std::string>& args); 
 
     virtual std::unique_ptr<response> handle_request(const request& req) override;
+
+    // Runs durable requests on the commit pool; done is called once the write is durable.
+    // Long-poll change requests are parked on the change feed until there is something to send.
+    virtual void handle_request_async(const request& req, Completion done) override;
+
+    // Ends a parked long poll right away, answering with whatever changed so far.
+    virtual void cancel() override;
+
+    // Threads available to durable requests; bounds how many can share one group commit.
+    static constexpr size_t kCommitPoolThreads = 32;
+
+    // Page size when a listing has a cursor but no limit.
+    static constexpr size_t kDefaultPageLimit = 100;
+
+    // Largest page a paginated listing returns; bigger limits are clamped.
+    static constexpr size_t kMaxPageLimit = 1000;
+
+    // Ids fetched per chunk of a streamed listing.
+    static constexpr size_t kStreamPageSize = 1000;
+
+    // Most operations accepted in one batch request.
+    static constexpr size_t kMaxBatchOps = 10000;
+
+    // How long a long-poll change request waits without a timeout parameter, and the most it may ask for.
+    static constexpr std::chrono::milliseconds kDefaultFeedTimeout{30000};
+    static constexpr std::chrono::milliseconds kMaxFeedTimeout{300000};
+
+    // Import lines written per storage batch, and so per group commit.
+    static constexpr size_t kImportBatchOps = 1000;
+
+    // Failed import lines reported individually; the rest are only counted.
+    static constexpr size_t kMaxImportErrors = 100;
+
+    // Quiet time after which an event stream sends a heartbeat comment, unless ?heartbeat=ms says otherwise.
+    static constexpr std::chrono::milliseconds kHeartbeatInterval{15000};
+
+    // Parses an entity_cache budget such as "65536", "512k", "64m" or "1g".
+    // @return: the budget in bytes; 0 disables the cache.
+    // @throws std::invalid_argument if the value isn't a size.
+    static size_t parse_cache_size(const std::string& value);
+
+    // Whether a path segment can name an entity type or id: not empty, no '/', and not
+    // "." or "..", so it always maps to one file directly under its type's directory.
+    static bool valid_id(const std::string& id);
 private:
     // Holds the root directory for where CRUD handler stores files
     std::shared_ptr<FileSystemInterface> file_system_; 
+    bool durable_; // writes wait for a group commit
+    std::shared_ptr<CachingFileSystem> cache_; // file_system_ when it is cached, else null
+    bool compressed_; // entity GETs may be sent gzip-encoded
+    std::shared_ptr<FieldIndex> index_; // null unless fields are indexed
+    std::shared_ptr<ChangeFeed> feed_; // null if the change feed is disabled
+    std::shared_ptr<ExpiryIndex> expiry_; // null if TTLs are ignored
+    std::chrono::seconds default_ttl_; // zero if entities don't expire by default
+    std::string parked_name_; // entity type of the parked long poll
+    uint64_t parked_token_ = 0; // its change feed token; 0 if none is parked
+
+    // Brings the field indexes and change feed up to date after a successful write.
+    void changed(const std::string& name, const std::string& id, bool deleted);
 
+    // Reads the TTL of a write from X-TTL (whole seconds), falling back to the default.
+    // @param ttl: receives the TTL; zero means the entity doesn't expire.
+    // @param given: set to true if the request carried X-TTL.
+    // @return: false if X-TTL isn't a whole number of seconds.
+    bool parse_ttl(const request& req, std::chrono::seconds& ttl, bool& given) const;
+    // Records when an entity expires, or that it doesn't. Writes that replace an existing
+    // entity call it before writing, so the reaper can't delete the new contents.
+    void set_expiry(const std::string& name, const std::string& id, std::chrono::seconds ttl);
+    // Whether an entity has expired but not been reaped yet; reads treat it as missing.
+    bool expired(const std::string& name, const std::string& id) const;
+    // Removes ids that have expired but not been reaped yet from a listing.
+    void drop_expired(const std::string& name, std::vector<std::string>& ids) const;
+    // ETag of an entity sent with a content coding: the plain tag with "-<coding>" inside the quotes,
+    // so caches never take one representation's validator for the other's.
+    static std::string encoded_etag(const std::string& etag, const std::string& encoding);
+    // Whether an If-Match list names the current version, by its plain tag or its gzip one.
+    bool matches_current(const std::string& if_match, const std::string& current) const;
+    // 400 for an X-TTL that isn't a number of seconds
+    std::unique_ptr<response> invalid_ttl();
     // Request Actions
     std::unique_ptr<response> post(const request& req, const std::string& name);
-    std::unique_ptr<response> get(const std::string& name, const std::string& id);
+    // GET /api/<Entity>/<id> sends the entity's ETag, and 304 if If-None-Match lists it
+    std::unique_ptr<response> get(const request& req, const std::string& name, const std::string& id,
+                                  const std::unordered_map<std::string, std::string>& query);
+    // GET /api/<Entity>?limit=N[&after=cursor]: one page of ids from a sorted index
+    std::unique_ptr<response> list_page(const std::string& name, const std::string& limit, const std::string& after);
+    // GET /api/<Entity>?stream=true: every id, sent in chunks as they are read
+    std::unique_ptr<response> list_stream(const std::string& name);
+    // GET /api/<Entity>?field=value[&...]: ids matching every filter, from the field indexes
+    std::unique_ptr<response> list_matching(const std::string& name, const std::map<std::string, std::string>& filters);
+    // PUT, PATCH and DELETE with If-Match only apply if the entity still has a listed ETag
     std::unique_ptr<response> put(const request& req, const std::string& name, const std::string& id);
-    std::unique_ptr<response> delete_req(const std::string& name, const std::string& id);
+    // PATCH /api/<Entity>/<id>: applies an RFC 7386 merge patch atomically in the storage layer
+    std::unique_ptr<response> patch(const request& req, const std::string& name, const std::string& id);
+    std::unique_ptr<response> delete_req(const request& req, const std::string& name, const std::string& id);
+    // 412 for a failed If-Match, carrying the entity's current ETag; empty current means it doesn't exist
+    std::unique_ptr<response> precondition_failed(const std::string& name, const std::string& id,
+                                                  const std::string& current);
+    // GET /api/<Entity>/_changes?since=N[&feed=longpoll|eventsource]: changes after seq N.
+    // Long polls take ?timeout=ms and event streams ?heartbeat=ms.
+    // A long poll only waits when it comes through handle_request_async.
+    std::unique_ptr<response> changes(const request& req, const std::string& name,
+                                      const std::unordered_map<std::string, std::string>& query);
+    // Reads since (or, for event streams, Last-Event-ID); "now" means the current seq.
+    // @return: false if it isn't a sequence number.
+    bool parse_since(const request& req, const std::unordered_map<std::string, std::string>& query,
+                     uint64_t& since) const;
+    // The non-streamed _changes body for everything after since.
+    std::unique_ptr<response> changes_since(const std::string& name, uint64_t since);
+    // POST /api/<Entity>/_batch: a JSON array or NDJSON of operations run as one storage batch
+    std::unique_ptr<response> batch(const request& req, const std::string& name);
+    // GET /api/<Entity>/_export: every entity as NDJSON {"id", "body"} lines, streamed a page at a time
+    std::unique_ptr<response> export_entities(const std::string& name);
+    // POST /api/<Entity>/_import: NDJSON in _export's format, written kImportBatchOps lines per batch
+    std::unique_ptr<response> import_entities(const request& req, const std::string& name);
 };
 
 #endif
@@ -0,0 +1,86 @@
+#ifndef ENTITY_CACHE_H
+#define ENTITY_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Bounded in-memory cache of entity bodies keyed by (entity type, id).
+// Split into independently locked shards, each an LRU list with its share of the
+// byte budget, so concurrent lookups of different entities rarely contend.
+class EntityCache {
+public:
+    static constexpr size_t kShards = 16;
+
+    // Counters reported in the [CacheMetrics] log line.
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t bytes = 0;   // charged bytes currently cached
+        size_t entries = 0;
+    };
+
+    // @param max_bytes: total memory budget across all shards.
+    explicit EntityCache(size_t max_bytes);
+
+    EntityCache(const EntityCache&) = delete;
+    EntityCache& operator=(const EntityCache&) = delete;
+
+    // Looks up an entity body.
+    // @param value: receives the body on a hit.
+    // @param generation: on a miss, receives the token to pass to insert().
+    // @return: true on a hit.
+    bool lookup(const std::string& entity, const std::string& id, std::string& value, uint64_t& generation);
+
+    // Caches a body read after a miss, unless the shard was invalidated since the lookup
+    // (a write could have landed between our disk read and now, making value stale).
+    void insert(const std::string& entity, const std::string& id, const std::string& value, uint64_t generation);
+
+    // Drops an entity after it was written or deleted.
+    void invalidate(const std::string& entity, const std::string& id);
+
+    // Returns a snapshot of the counters without taking any shard lock.
+    Stats stats() const;
+
+    // Returns the process-wide cache for a data path, creating it on first use.
+    // Keyed by data path alone so every location writing that data invalidates the same cache;
+    // max_bytes only applies when the cache is first created.
+    static std::shared_ptr<EntityCache> shared(const std::string& data_path, size_t max_bytes);
+
+private:
+    struct Entry {
+        std::string value;
+        size_t charge;
+        std::list<std::string>::iterator lru_it;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::list<std::string> lru; // most recently used first
+        std::unordered_map<std::string, Entry> entries;
+        size_t bytes = 0;
+        uint64_t generation = 0; // bumped on every invalidation
+    };
+
+    static std::string make_key(const std::string& entity, const std::string& id);
+    Shard& shard_for(const std::string& key);
+    void erase_locked(Shard& shard, std::unordered_map<std::string, Entry>::iterator it);
+
+    size_t shard_budget_;
+    std::vector<Shard> shards_;
+
+    // Read on every request for metrics, so kept outside the shard locks
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<size_t> bytes_{0};
+    std::atomic<size_t> entries_{0};
+};
+
+#endif // ENTITY_CACHE_H
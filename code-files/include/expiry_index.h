@@ -0,0 +1,97 @@
+#ifndef EXPIRY_INDEX_H
+#define EXPIRY_INDEX_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "file_system_interface.h"
+
+// When entities with a TTL expire, for one data path, ordered by deadline.
+// Deadlines are wall-clock times so they survive restarts: every change is appended to a
+// journal in the data path, replayed (and compacted) when the index is opened. The journal
+// is only created once the first deadline is set.
+// A reaper thread started on the first deadline deletes expired entities in batches; until
+// it gets to one, expired() lets reads treat it as gone.
+class ExpiryIndex {
+public:
+    using Clock = std::chrono::system_clock;
+
+    // Expired entities the reaper deletes before looking for more.
+    static constexpr size_t kReapBatch = 1000;
+
+    // Called by the reaper, with no lock held, for every entity it deleted.
+    using Reaped = std::function<void(const std::string& name, const std::string& id)>;
+
+    // @param journal_path: file the deadlines are kept in; empty keeps them in memory only.
+    explicit ExpiryIndex(const std::string& journal_path = "");
+    // Stops the reaper.
+    ~ExpiryIndex();
+
+    ExpiryIndex(const ExpiryIndex&) = delete;
+    ExpiryIndex& operator=(const ExpiryIndex&) = delete;
+
+    // Sets when an entity expires, replacing any earlier deadline.
+    void set(const std::string& name, const std::string& id, Clock::time_point deadline);
+
+    // Forgets an entity's deadline, so it no longer expires.
+    void clear(const std::string& name, const std::string& id);
+
+    // Whether an entity's deadline has passed. Cheap when nothing has a deadline.
+    bool expired(const std::string& name, const std::string& id, Clock::time_point now = Clock::now()) const;
+
+    // Deletes up to kReapBatch expired entities from store, oldest deadline first.
+    // An entity whose deadline moves while it's being deleted is left alone.
+    // @return: the number of entities deleted.
+    size_t reap(FileSystemInterface& store, const Reaped& on_reaped, Clock::time_point now = Clock::now());
+
+    // Sets the store the reaper deletes from; the thread starts with the first deadline.
+    // Only the first call has any effect.
+    void start_reaper(std::shared_ptr<FileSystemInterface> store, Reaped on_reaped);
+
+    // Number of entities with a deadline.
+    size_t size() const;
+
+    // Returns the process-wide index for a data path.
+    // @param journaled: keep deadlines in data_path/.expiry; false for stores that don't
+    //                   outlive the process. Only applies when the index is first created.
+    static std::shared_ptr<ExpiryIndex> shared(const std::string& data_path, bool journaled = true);
+
+private:
+    using Entry = std::pair<Clock::time_point, std::string>; // deadline, "name/id"
+
+    // Deadlines as journal records, ms since the epoch; 0 means cleared
+    static int64_t to_ms(Clock::time_point deadline);
+    void load_locked();
+    void append_locked(const std::string& key, int64_t ms);
+    // Rewrites the journal with just the live deadlines
+    void compact_locked();
+    void erase_locked(const std::string& key);
+    // Deletes expired batches until the index is stopped
+    void run_reaper();
+
+    std::string journal_path_;
+    mutable std::mutex mutex_;
+    std::condition_variable reaper_cv_;
+    std::unordered_map<std::string, Clock::time_point> deadlines_; // "name/id" -> deadline
+    std::set<Entry> by_deadline_;
+    std::atomic<size_t> count_{0}; // deadlines_.size(), read without the lock
+    std::ofstream journal_;
+    size_t journal_records_ = 0;
+    bool journal_failed_ = false; // the last append failed; warned once until one succeeds
+    std::shared_ptr<FileSystemInterface> store_;
+    Reaped on_reaped_;
+    bool stopping_ = false;
+    std::thread reaper_; // started by the first deadline once there is a store
+};
+
+#endif // EXPIRY_INDEX_H
@@ -0,0 +1,91 @@
+#ifndef FIELD_INDEX_H
+#define FIELD_INDEX_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "file_system_interface.h"
+#include "striped_lock_table.h"
+
+// Secondary indexes over top-level fields of stored entities, so
+// GET /api/Products?name=Mouse is one lookup instead of a GET per id.
+// Every entity type gets its own index over the configured fields. Strings, numbers and
+// booleans are indexed by their text, with numbers (and numeric strings) in one canonical
+// spelling, so ?price=10 matches 10, 10.0 and "10"; objects, arrays and null are skipped.
+// A type is built from storage the first time it is used (or by warm() at startup);
+// after that every write calls refresh() to keep it current.
+class FieldIndex {
+public:
+    // @param fields: top-level field names to index.
+    explicit FieldIndex(std::vector<std::string> fields);
+
+    FieldIndex(const FieldIndex&) = delete;
+    FieldIndex& operator=(const FieldIndex&) = delete;
+
+    const std::vector<std::string>& fields() const { return fields_; }
+
+    // Whether a field is one of the indexed ones.
+    bool indexes(const std::string& field) const;
+
+    // Returns ids of a type whose fields all equal the given values, in ascending order.
+    // @param filters: field -> value; every field must be indexed.
+    // @param ids: receives the matching ids.
+    // @param store: read from to build the type if it isn't loaded yet.
+    // @return: false if the type doesn't exist.
+    bool find(const std::string& name, const std::map<std::string, std::string>& filters,
+              std::vector<std::string>& ids, const FileSystemInterface& store);
+
+    // Re-indexes one entity from its current contents in storage; a missing entity is
+    // dropped. The read and parse happen outside the index lock, under a per-id lock that
+    // keeps racing writes to the same id from leaving a stale value behind.
+    // Ignored until the type has been loaded, since the load will read the entity itself.
+    void refresh(const std::string& name, const std::string& id, const FileSystemInterface& store);
+
+    // Builds every type in storage. Only the first call does any work.
+    void warm(const FileSystemInterface& store);
+
+    // Canonical key for a query value: numbers are respelled the way stored numbers are
+    // indexed, anything else is returned unchanged.
+    static std::string normalize(const std::string& value);
+
+    // Splits an index directive value ("name,price" or "name price") into field names.
+    static std::vector<std::string> parse_fields(const std::string& value);
+
+    // Returns the process-wide index for a data path; handlers are created per request.
+    // The field list only applies when the index is first created; the config loader
+    // rejects locations on one data path that declare different lists.
+    static std::shared_ptr<FieldIndex> shared(const std::string& data_path, const std::vector<std::string>& fields);
+
+private:
+    struct TypeIndex {
+        // field -> value -> ids
+        std::unordered_map<std::string, std::unordered_map<std::string, std::set<std::string>>> postings;
+        // id -> (field, value) pairs currently indexed for it
+        std::unordered_map<std::string, std::vector<std::pair<std::string, std::string>>> values;
+    };
+
+    // Loads a type from storage. Caller holds mutex_ exclusively.
+    // @return: nullptr if the type doesn't exist.
+    TypeIndex* load_locked(const std::string& name, const FileSystemInterface& store);
+
+    // Parses a body into the (field, key) pairs to index for it.
+    std::vector<std::pair<std::string, std::string>> extract(const std::string& data) const;
+
+    // Replaces whatever was indexed for an id; null values drop the id.
+    // Caller holds mutex_ exclusively.
+    void index_locked(TypeIndex& type, const std::string& id,
+                      std::vector<std::pair<std::string, std::string>>* values);
+
+    std::vector<std::string> fields_;
+    std::atomic<bool> warmed_{false};
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, TypeIndex> types_; // only loaded types
+    StripedLockTable refresh_locks_; // serializes refresh() per id
+};
+
+#endif // FIELD_INDEX_H
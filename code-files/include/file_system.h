@@ -4,14 +4,28 @@
 #include <fstream>
 #include <sstream>
 #include <filesystem>
-#include <boost/uuid/uuid.hpp>
-#include <boost/uuid/uuid_generators.hpp>
-#include <boost/uuid/uuid_io.hpp>
 #include "file_system_interface.h"
+#include "group_commit.h"
+#include "id_generator.h"
+#include "sorted_id_index.h"
+#include "striped_lock_table.h"
 
 class FileSystem : public FileSystemInterface {
 public:
-    FileSystem(const std::string& data_path);
+    // Where an entity's file lives under its type's directory.
+    enum class Layout {
+        kFlat,    // <data_path>/<name>/<id>
+        kSharded, // <data_path>/<name>/ab/cd/<id>, ab/cd taken from a hash of the id
+    };
+
+    // @param data_path: root directory; each entity type is a subdirectory, each entity a file.
+    // @param group_commit: if set, writes are durable: data goes to a temp file that is
+    //                      renamed into place, and each step waits for a group commit.
+    //                      A new entity becomes durable with its first write.
+    // @param layout: directory layout of the existing data; see migrate() to change it.
+    // @param id_scheme: how create_entity names new entities.
+    FileSystem(const std::string& data_path, std::shared_ptr<GroupCommit> group_commit = nullptr,
+               Layout layout = Layout::kFlat, IdGenerator::Scheme id_scheme = IdGenerator::Scheme::kUuid);
 
     // CRUD operations on entity
     std::pair<bool, std::string> create_entity(const std::string &name) override;
@@ -26,11 +40,87 @@ public:
 
     bool exists(const std::string& entity, const std::string& id) const override;
 
+    bool put_entity(const std::string &name, const std::string &id, const std::string &data, bool &created) override;
+
+    // Reads, mutates and rewrites the file while holding the entity's lock exclusively.
+    // With durable writes the lock is only held to check and rename; see update_entity_durable().
+    bool update_entity(const std::string &name, const std::string &id,
+                       const std::function<bool(std::string &data)> &mutate, bool &found) override;
+
+    // Checks and removes the file while holding the entity's lock exclusively.
+    bool delete_entity_if(const std::string &name, const std::string &id,
+                          const std::function<bool(const std::string &data)> &precondition, bool &found) override;
+
+    // With durable writes, stages every body first so the whole batch costs two group
+    // commits; otherwise runs the operations one by one.
+    bool apply_batch(std::vector<BatchOp>& ops) override;
+
+    // Pages through a sorted id index shared by every FileSystem on data_path, built
+    // from a directory scan the first time a type is paged.
+    bool list_entities_page(const std::string &name, const std::string &after, size_t limit,
+                            std::vector<std::string> &ids, bool &more) const override;
+
+    std::vector<std::string> list_entity_types() const override;
+
     // Getter for data_path_
     const std::string& get_data_path() const override;
 
+    Layout layout() const { return layout_; }
+
+    // Parses a layout directive value.
+    // @param value: "flat" or "sharded".
+    // @throws std::invalid_argument for anything else.
+    static Layout parse_layout(const std::string& value);
+
+    // Hashed subdirectory an id is stored under in the sharded layout.
+    // @return: e.g. "3f/a2"; the same id always maps to the same directory.
+    static std::string shard_dir(const std::string& id);
+
+    // Moves every entity under data_path into the given layout. Entities already in place
+    // are left alone, so an interrupted migration can simply be run again. Files being moved
+    // pass through <type>/.migrating, so ids named like a shard directory don't collide.
+    // Must not run while a server is using data_path.
+    // @return: number of entity files moved.
+    // @throws std::filesystem::filesystem_error if a file can't be moved.
+    static size_t migrate(const std::string& data_path, Layout to);
+
 private:
+    // Directory an entity's file goes in: its type's directory, or the shard under it.
+    // Writes create only this, never directories an id might name.
+    std::filesystem::path entity_dir(const std::string& name, const std::string& id) const;
+
+    // Path of an entity's file under the configured layout.
+    std::filesystem::path entity_file(const std::string& name, const std::string& id) const;
+
+    // Replaces a file's contents; caller holds the entity's lock exclusively.
+    bool write_file(const std::filesystem::path& file, const std::string& data);
+
+    // Reads a whole file; caller holds the entity's lock.
+    // @return: false if the file can't be opened.
+    static bool read_file(const std::filesystem::path& file, std::string& data);
+
+    // Writes data to a uniquely named file under <data_path>/.tmp, ready to be renamed into place.
+    // @return: the temp file, or an empty path on failure.
+    std::filesystem::path stage_file(const std::string& id, const std::string& data);
+
+    // Durable write: temp file, group commit, rename, group commit. Only the rename runs
+    // under the entity's lock.
+    // @param before_rename: called under the lock; returning false abandons the write.
+    // @param after_rename: called under the lock once the new contents are in place.
+    bool write_entity_durable(const std::string& name, const std::string& id, const std::string& data,
+                              const std::function<bool()>& before_rename,
+                              const std::function<void()>& after_rename = nullptr);
+
+    // update_entity() for durable writes: optimistic, retried if another write intervenes.
+    bool update_entity_durable(const std::string& name, const std::string& id,
+                               const std::function<bool(std::string& data)>& mutate, bool& found);
+
     std::string data_path_;
+    Layout layout_;
+    IdGenerator::Scheme id_scheme_;
+    std::shared_ptr<GroupCommit> group_commit_; // null unless durable writes are enabled
+    std::shared_ptr<StripedLockTable> locks_; // per-entity locks shared by every FileSystem on data_path_
+    std::shared_ptr<SortedIdIndex> sorted_ids_; // ids in order, for paged listings
 };
 
 #endif
\ No newline at end of file
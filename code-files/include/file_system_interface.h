@@ -1,6 +1,44 @@
 #ifndef FILE_SYSTEM_INTERFACE_H
 #define FILE_SYSTEM_INTERFACE_H
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "fnv_hash.h"
+
+// One operation of a batch; see FileSystemInterface::apply_batch.
+struct BatchOp {
+    enum Type { kCreate, kGet, kPut, kDelete };
+
+    Type type;
+    std::string name;     // entity type
+    std::string id;       // target id; filled in for kCreate
+    std::string data;     // body for kCreate/kPut; receives the body for kGet
+    bool ok = false;      // set if the operation succeeded
+    bool created = false; // kPut only: the entity did not exist before
+};
+
+// Version tag of an entity's contents, quotes included, as sent in ETag headers.
+// It's a 64-bit FNV-1a of the stored bytes, so every backend agrees on it, it survives
+// restarts without being stored, and any write that changes the contents changes it.
+inline std::string entity_etag(const std::string& data) {
+    uint64_t hash = fnv1a_64(data);
+    char out[19];
+    std::snprintf(out, sizeof(out), "\"%016llx\"", static_cast<unsigned long long>(hash));
+    return out;
+}
+
+// An entity as a backend stores it, so it can be served without being decoded.
+struct StoredEntity {
+    std::string data;     // stored bytes
+    std::string encoding; // HTTP content coding of data, e.g. "gzip"; empty if it's the plain JSON
+    std::string etag;     // entity_etag() of the plain contents
+};
+
 class FileSystemInterface {
 public:
     virtual ~FileSystemInterface() = default;
@@ -12,6 +50,116 @@ public:
     virtual std::pair<bool, std::vector<std::string>> list_entities(const std::string &name) const = 0;
     virtual const std::string& get_data_path() const = 0;
     virtual bool exists(const std::string& entity, const std::string& id) const = 0;
+
+    // Creates or overwrites an entity under a caller-chosen id as one atomic step.
+    // The default is only as atomic as exists() followed by write_entity(); backends
+    // that can run requests concurrently override it.
+    // @param created: set to true if the entity did not exist before.
+    // @return: true on success.
+    virtual bool put_entity(const std::string& name, const std::string& id, const std::string& data, bool& created) {
+        created = !exists(name, id);
+        return write_entity(name, id, data);
+    }
+
+    // Rewrites an entity from its current contents as one atomic step: no other write to the
+    // entity can land between the read and the write. The default is only as atomic as
+    // read_entity() followed by write_entity(); backends override it to hold the entity's lock.
+    // @param mutate: edits the current contents in place; returning false leaves the entity as it was.
+    // @param found: set to true if the entity exists.
+    // @return: true if the entity was rewritten.
+    virtual bool update_entity(const std::string& name, const std::string& id,
+                               const std::function<bool(std::string& data)>& mutate, bool& found) {
+        auto [exists, data] = read_entity(name, id);
+        found = exists;
+        return exists && mutate(data) && write_entity(name, id, data);
+    }
+
+    // Reads an entity without undoing any compression the backend applied, so a client that
+    // accepts the encoding can be sent the stored bytes as-is. The default reads the plain body.
+    // @return: false if the entity doesn't exist.
+    virtual bool read_entity_stored(const std::string& name, const std::string& id, StoredEntity& entity) const {
+        auto [found, data] = read_entity(name, id);
+        if (!found) {
+            return false;
+        }
+        entity.etag = entity_etag(data);
+        entity.encoding.clear();
+        entity.data = std::move(data);
+        return true;
+    }
+
+    // Deletes an entity only if its current contents pass a check, as one atomic step.
+    // Used for compare-and-delete; the default is only as atomic as read_entity()
+    // followed by delete_entity(), and backends override it like update_entity().
+    // @param precondition: decides from the current contents whether to delete.
+    // @param found: set to true if the entity exists.
+    // @return: true if the entity was deleted.
+    virtual bool delete_entity_if(const std::string& name, const std::string& id,
+                                  const std::function<bool(const std::string& data)>& precondition, bool& found) {
+        auto [exists, data] = read_entity(name, id);
+        found = exists;
+        return exists && precondition(data) && delete_entity(name, id);
+    }
+
+    // Runs a sequence of operations in order; each sees the effects of the ones before it.
+    // Backends override this to make the whole batch durable with a single commit instead
+    // of one per operation. Per-operation results are reported through each op's ok flag.
+    // @return: false if the batch's changes could not be made durable.
+    virtual bool apply_batch(std::vector<BatchOp>& ops) {
+        for (auto& op : ops) {
+            switch (op.type) {
+                case BatchOp::kCreate: {
+                    auto [created, id] = create_entity(op.name);
+                    op.ok = created && write_entity(op.name, id, op.data);
+                    op.id = created ? id : "";
+                    break;
+                }
+                case BatchOp::kGet: {
+                    auto [found, data] = read_entity(op.name, op.id);
+                    op.ok = found;
+                    op.data = std::move(data);
+                    break;
+                }
+                case BatchOp::kPut:
+                    op.ok = put_entity(op.name, op.id, op.data, op.created);
+                    break;
+                case BatchOp::kDelete:
+                    op.ok = delete_entity(op.name, op.id);
+                    break;
+            }
+        }
+        return true;
+    }
+
+    // Lists ids of a type in ascending order, one page at a time.
+    // The default sorts a full listing; backends with a sorted index override it.
+    // @param after: cursor; only ids greater than it are returned (empty starts at the first id).
+    // @param limit: maximum number of ids to return.
+    // @param ids: receives the page.
+    // @param more: set to true if ids beyond this page exist.
+    // @return: false if the entity type does not exist.
+    virtual bool list_entities_page(const std::string& name, const std::string& after, size_t limit,
+                                    std::vector<std::string>& ids, bool& more) const {
+        auto [found, all] = list_entities(name);
+        ids.clear();
+        more = false;
+        if (!found) {
+            return false;
+        }
+        std::sort(all.begin(), all.end());
+        auto it = after.empty() ? all.begin() : std::upper_bound(all.begin(), all.end(), after);
+        for (; it != all.end() && ids.size() < limit; ++it) {
+            ids.push_back(*it);
+        }
+        more = it != all.end();
+        return true;
+    }
+
+    // Names of every entity type in storage, used to rebuild in-memory indexes at startup.
+    // The default reports none, leaving those indexes to be built the first time they're used.
+    virtual std::vector<std::string> list_entity_types() const {
+        return {};
+    }
 };
 
 #endif
\ No newline at end of file
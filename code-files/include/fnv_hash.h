@@ -0,0 +1,30 @@
+#ifndef FNV_HASH_H
+#define FNV_HASH_H
+
+#include <cstdint>
+#include <string_view>
+
+// FNV-1a, the hash behind ETags, asset fingerprints and shard directories. It's fast on
+// short keys and stable across builds and platforms, so its output can be persisted.
+// Pass the previous result back in as hash to continue over bytes read in pieces.
+
+constexpr uint64_t kFnv1a64Basis = 0xcbf29ce484222325ULL;
+constexpr uint32_t kFnv1a32Basis = 0x811c9dc5u;
+
+inline uint64_t fnv1a_64(std::string_view bytes, uint64_t hash = kFnv1a64Basis) {
+    for (unsigned char c : bytes) {
+        hash ^= c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+inline uint32_t fnv1a_32(std::string_view bytes, uint32_t hash = kFnv1a32Basis) {
+    for (unsigned char c : bytes) {
+        hash ^= c;
+        hash *= 0x01000193u;
+    }
+    return hash;
+}
+
+#endif // FNV_HASH_H
@@ -0,0 +1,57 @@
+#ifndef GROUP_COMMIT_H
+#define GROUP_COMMIT_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Batches fsyncs from concurrent writers. A caller that needs its writes durable
+// calls sync(); the first caller becomes the leader, waits up to the commit window
+// for others to join, then issues one flush for everyone who arrived before it
+// started. Callers that arrive mid-flush are covered by the next one.
+class GroupCommit {
+public:
+    // Counters used by benchmarks to report batch sizes.
+    struct Stats {
+        uint64_t requests = 0; // sync() calls
+        uint64_t flushes = 0;  // flushes actually issued
+    };
+
+    static constexpr std::chrono::microseconds kDefaultWindow{1000};
+
+    // @param flush: makes every write issued so far durable (e.g., syncfs or fdatasync).
+    // @param window: how long a leader waits for followers before flushing.
+    GroupCommit(std::function<bool()> flush, std::chrono::microseconds window);
+
+    // Blocks until a flush that started after this call has completed.
+    // @return: false if that flush (or any earlier one) failed; a failed flush may
+    //          have dropped dirty pages, so the commit stays failed from then on.
+    bool sync();
+
+    // Returns a snapshot of the counters.
+    Stats stats() const;
+
+    // Returns the process-wide group commit for a directory, flushed with syncfs(2).
+    // @param path: directory on the filesystem to flush.
+    // @param window: commit window; only used when the group commit is first created.
+    // @throws std::runtime_error if the directory can't be opened.
+    static std::shared_ptr<GroupCommit> for_directory(const std::string& path, std::chrono::microseconds window);
+
+private:
+    std::function<bool()> flush_;
+    std::chrono::microseconds window_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable flushed_cv_;
+    uint64_t requested_ = 0; // tickets handed out
+    uint64_t flushed_ = 0;   // highest ticket covered by a completed flush
+    bool flushing_ = false;  // a leader is collecting or flushing
+    bool failed_ = false;
+    Stats stats_;
+};
+
+#endif // GROUP_COMMIT_H
@@ -0,0 +1,72 @@
+#ifndef HTML_TEMPLATE_H
+#define HTML_TEMPLATE_H
+
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// HTML template compiled once into a list of static chunks and slots. A slot is written
+// {{name}} and its value is always HTML-escaped; there are no raw slots, loops or
+// conditionals. Pages with repeated or optional parts are built from several templates
+// with compose(), which sizes the whole page before writing it once.
+//
+// Templates are meant to be constructed at startup (e.g. as namespace-scope constants), so
+// rendering does no parsing, name lookups or intermediate strings.
+class HtmlTemplate {
+public:
+    // Slot values, in the order the parameters were declared.
+    using Args = std::initializer_list<std::string_view>;
+
+    // Compiles a template.
+    // @param source: the HTML, with {{name}} slots.
+    // @param params: the slot names the template may use; each may appear any number of times.
+    // @throws std::invalid_argument if a slot is unterminated or names an undeclared parameter.
+    HtmlTemplate(std::string_view source, std::initializer_list<std::string_view> params);
+
+    // Exact length of the rendered output.
+    // @throws std::invalid_argument if args doesn't hold one value per parameter.
+    size_t size(Args args) const;
+
+    // Appends the rendered output to out.
+    // @throws std::invalid_argument if args doesn't hold one value per parameter.
+    void render_to(std::string& out, Args args) const;
+
+    // Renders into a string allocated once at the exact size.
+    std::string render(Args args) const;
+
+    // Builds a page from several templates in one allocation. build is called twice with an
+    // emit(const HtmlTemplate&, Args) function: first to size the page, then to write it, so
+    // it must emit the same templates and values both times.
+    template <typename Build>
+    static std::string compose(Build&& build) {
+        size_t total = 0;
+        build([&total](const HtmlTemplate& part, Args args) { total += part.size(args); });
+        std::string out;
+        out.reserve(total);
+        build([&out](const HtmlTemplate& part, Args args) { part.render_to(out, args); });
+        return out;
+    }
+
+    // Length of text once escaped.
+    static size_t escaped_size(std::string_view text);
+
+    // Appends text with &, <, >, " and ' replaced by character references.
+    static void append_escaped(std::string& out, std::string_view text);
+
+private:
+    // A static chunk of text_, followed by a slot unless it ends the template
+    struct Segment {
+        size_t offset;
+        size_t length;
+        int slot; // parameter index, or -1 after the last chunk
+    };
+
+    void check_args(Args args) const;
+
+    std::string text_; // all static chunks, back to back
+    std::vector<Segment> segments_;
+    size_t param_count_;
+};
+
+#endif // HTML_TEMPLATE_H
@@ -0,0 +1,38 @@
+#ifndef ID_GENERATOR_H
+#define ID_GENERATOR_H
+
+#include <cstdint>
+#include <string>
+
+// Ids for new entities. Every thread keeps its own generator state, seeded once,
+// so generating an id takes no lock and no syscall.
+class IdGenerator {
+public:
+    enum class Scheme {
+        kUuid, // random version 4 UUID, e.g. "9b2e4f6c-1d3a-4c5b-8e7f-0a1b2c3d4e5f"
+        kUlid, // 26-character ULID: 48-bit millisecond timestamp then 80 random bits, in
+               // Crockford base32, so ids sort by creation time
+    };
+
+    // Parses an id_scheme directive value.
+    // @param value: "uuid" or "ulid".
+    // @throws std::invalid_argument for anything else.
+    static Scheme parse_scheme(const std::string& value);
+
+    // Generates an id under a scheme.
+    static std::string next(Scheme scheme);
+
+    static std::string uuid();
+
+    // Ids from one thread strictly increase, even within a millisecond: the random part
+    // is incremented instead of redrawn.
+    static std::string ulid();
+
+    // Encodes a ULID from its parts; exposed for tests.
+    // @param millis: Unix time in milliseconds (low 48 bits used).
+    // @param random_hi: top 16 of the 80 random bits.
+    // @param random_lo: low 64 of the 80 random bits.
+    static std::string encode_ulid(uint64_t millis, uint16_t random_hi, uint64_t random_lo);
+};
+
+#endif // ID_GENERATOR_H
@@ -0,0 +1,44 @@
+#ifndef IO_THREAD_POOL_H
+#define IO_THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small pool of threads for blocking disk I/O. Handlers hand cache-miss reads and
+// commit waits to it so a cold page cache, a slow volume or an fsync stalls a pool
+// thread instead of the io_service thread that serves every other connection.
+class IoThreadPool {
+public:
+    static constexpr size_t kDefaultThreads = 4;
+
+    // @param threads: number of worker threads (at least one is started).
+    explicit IoThreadPool(size_t threads = kDefaultThreads);
+
+    // Stops accepting work, runs whatever is already queued and joins the workers.
+    ~IoThreadPool();
+
+    IoThreadPool(const IoThreadPool&) = delete;
+    IoThreadPool& operator=(const IoThreadPool&) = delete;
+
+    // Queues a job to run on a worker thread.
+    void submit(std::function<void()> job);
+
+    // Returns the process-wide pool StaticFileHandler reads files on.
+    static IoThreadPool& shared();
+
+private:
+    // Worker loop: pops and runs jobs until stopped and drained.
+    void run();
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::function<void()>> jobs_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+#endif // IO_THREAD_POOL_H
@@ -0,0 +1,23 @@
+#ifndef JSON_VALIDATOR_H
+#define JSON_VALIDATOR_H
+
+#include <cstddef>
+#include <string_view>
+
+// Single-pass JSON syntax checker for request bodies (RFC 8259, including UTF-8 in strings).
+// Works like a SAX parser that throws every event away: no tree is built and nothing is
+// allocated, and nesting is tracked in a fixed-size bit stack. Runs of plain string bytes
+// and whitespace are skipped 16 bytes at a time with SSE2 where available.
+class JsonValidator {
+public:
+    // Deepest nesting of objects and arrays accepted; deeper documents are rejected.
+    static constexpr size_t kMaxDepth = 1024;
+
+    // Checks that text is exactly one JSON value, optionally surrounded by whitespace.
+    // @param text: the document.
+    // @param error_offset: if non-null, receives the byte offset of the first error.
+    // @return: true if text is valid JSON.
+    static bool validate(std::string_view text, size_t* error_offset = nullptr);
+};
+
+#endif // JSON_VALIDATOR_H
@@ -0,0 +1,139 @@
+#ifndef LOG_FILE_SYSTEM_H
+#define LOG_FILE_SYSTEM_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "file_system_interface.h"
+#include "group_commit.h"
+#include "id_generator.h"
+
+// Entity store backed by a single append-only log instead of one file per entity.
+// Every create/write/delete appends a CRC-checked record to <data_path>/entities.log
+// and updates an in-memory (entity, id) -> offset index kept in id order; reads are one pread.
+// On open the log is replayed to rebuild the index, and a torn or corrupt tail left
+// by a crash is truncated away. Once superseded records outweigh live ones the log
+// is checkpointed: live records are copied to a fresh file that atomically replaces it.
+class LogFileSystem : public FileSystemInterface {
+public:
+    // Checkpoints only happen once at least this many bytes are dead.
+    static constexpr uint64_t kDefaultCheckpointMinBytes = 4 * 1024 * 1024;
+
+    // Opens (or creates) the log under data_path and replays it.
+    // @param data_path: directory holding entities.log.
+    // @param checkpoint_min_bytes: dead bytes required before a checkpoint is considered.
+    // @param durable: if true, mutations return only after a group-committed fdatasync of the log.
+    // @param commit_window: how long a group commit waits for concurrent writers.
+    // @param id_scheme: how create_entity names new entities.
+    // @throws std::runtime_error if the log can't be opened.
+    explicit LogFileSystem(const std::string& data_path,
+                           uint64_t checkpoint_min_bytes = kDefaultCheckpointMinBytes,
+                           bool durable = false,
+                           std::chrono::microseconds commit_window = GroupCommit::kDefaultWindow,
+                           IdGenerator::Scheme id_scheme = IdGenerator::Scheme::kUuid);
+    ~LogFileSystem() override;
+
+    LogFileSystem(const LogFileSystem&) = delete;
+    LogFileSystem& operator=(const LogFileSystem&) = delete;
+
+    // CRUD operations on entity
+    std::pair<bool, std::string> create_entity(const std::string &name) override;
+
+    std::pair<bool, std::string> read_entity(const std::string &name, const std::string &id) const override;
+
+    bool write_entity(const std::string &name, const std::string &id, const std::string &data) override;
+
+    bool delete_entity(const std::string &name, const std::string &id) override;
+
+    std::pair<bool, std::vector<std::string>> list_entities(const std::string &name) const override;
+
+    bool exists(const std::string& entity, const std::string& id) const override;
+
+    bool put_entity(const std::string &name, const std::string &id, const std::string &data, bool &created) override;
+
+    // Reads and appends the new contents under one exclusive lock.
+    bool update_entity(const std::string &name, const std::string &id,
+                       const std::function<bool(std::string &data)> &mutate, bool &found) override;
+
+    // Checks and appends the tombstone under one exclusive lock.
+    bool delete_entity_if(const std::string &name, const std::string &id,
+                          const std::function<bool(const std::string &data)> &precondition, bool &found) override;
+
+    bool list_entities_page(const std::string &name, const std::string &after, size_t limit,
+                            std::vector<std::string> &ids, bool &more) const override;
+
+    // Appends the whole batch under one lock and waits for a single group commit.
+    bool apply_batch(std::vector<BatchOp>& ops) override;
+
+    std::vector<std::string> list_entity_types() const override;
+
+    // Getter for data_path_
+    const std::string& get_data_path() const override;
+
+    // Rewrites the log with only live records and swaps it in atomically.
+    // @return: true on success; on failure the current log is left untouched.
+    bool checkpoint();
+
+    // Size of the log file in bytes.
+    uint64_t log_size() const;
+
+    // Returns the process-wide store for a data path, opening it on first use.
+    // Handlers are constructed per request, so the index lives here rather than in the handler.
+    // Durability and id settings only apply when the store is first opened; the config
+    // loader rejects locations on one data path with different storage or id_scheme.
+    static std::shared_ptr<LogFileSystem> shared(const std::string& data_path, bool durable = false,
+                                                 std::chrono::microseconds commit_window = GroupCommit::kDefaultWindow,
+                                                 IdGenerator::Scheme id_scheme = IdGenerator::Scheme::kUuid);
+
+private:
+    // Where a live entity's record sits in the log.
+    struct Location {
+        uint64_t offset = 0;      // offset of the entity data
+        uint32_t length = 0;      // length of the entity data
+        uint32_t record_size = 0; // whole record, for dead-space accounting
+    };
+    // Ordered so listings can be paged by id without a separate index
+    using EntityIndex = std::map<std::string, Location>;
+
+    enum Op : uint8_t { kPut = 1, kDelete = 2 };
+
+    // Rebuilds index_ from the log, truncating anything after the last valid record.
+    void replay();
+
+    // Appends one record to the log. Caller holds mutex_ exclusively.
+    // @return: false if the write failed (the log is trimmed back to its old size).
+    bool append(Op op, const std::string& name, const std::string& id, const std::string& data,
+                Location& location);
+
+    // Operation bodies shared by the single-entity methods and apply_batch. Callers hold
+    // mutex_ (shared for reads, exclusive otherwise) and commit afterwards.
+    std::pair<bool, std::string> read_locked(const std::string& name, const std::string& id) const;
+    bool put_locked(const std::string& name, const std::string& id, const std::string& data, bool& created);
+    bool delete_locked(const std::string& name, const std::string& id);
+
+    // Waits for the group commit covering everything appended so far. Caller must not hold mutex_.
+    // @return: true if durable (always true when durability is off).
+    bool commit();
+
+    // Checkpoints if dead records outweigh live ones. Caller holds mutex_ exclusively.
+    void maybe_checkpoint();
+    bool checkpoint_locked();
+
+    std::string data_path_;
+    std::string log_path_;
+    int fd_ = -1;
+    uint64_t log_size_ = 0;
+    uint64_t live_bytes_ = 0;
+    uint64_t dead_bytes_ = 0;
+    uint64_t checkpoint_min_bytes_;
+    IdGenerator::Scheme id_scheme_;
+    std::unordered_map<std::string, EntityIndex> index_; // entity type -> id -> location
+    std::unique_ptr<GroupCommit> group_commit_; // null unless durable
+    mutable std::shared_mutex mutex_;
+};
+
+#endif // LOG_FILE_SYSTEM_H
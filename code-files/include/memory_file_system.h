@@ -0,0 +1,85 @@
+#ifndef MEMORY_FILE_SYSTEM_H
+#define MEMORY_FILE_SYSTEM_H
+
+#include <array>
+#include <map>
+#include <memory>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "file_system_interface.h"
+#include "id_generator.h"
+
+// Entity store that keeps everything in memory and never touches the disk.
+// It gives benchmarks a zero-I/O baseline for handler, parser and session costs, and
+// serves entity types that don't need to outlive the process. Bodies are spread over
+// kShards hash shards, each with its own reader/writer lock, so requests for different
+// entities rarely contend; each type's ids are also kept sorted for paged listings.
+class MemoryFileSystem : public FileSystemInterface {
+public:
+    static constexpr size_t kShards = 64;
+
+    // @param data_path: only names the store; nothing is read from or written to it.
+    // @param id_scheme: how create_entity names new entities.
+    explicit MemoryFileSystem(const std::string& data_path,
+                              IdGenerator::Scheme id_scheme = IdGenerator::Scheme::kUuid);
+
+    MemoryFileSystem(const MemoryFileSystem&) = delete;
+    MemoryFileSystem& operator=(const MemoryFileSystem&) = delete;
+
+    std::pair<bool, std::string> create_entity(const std::string &name) override;
+
+    std::pair<bool, std::string> read_entity(const std::string &name, const std::string &id) const override;
+
+    bool write_entity(const std::string &name, const std::string &id, const std::string &data) override;
+
+    bool delete_entity(const std::string &name, const std::string &id) override;
+
+    std::pair<bool, std::vector<std::string>> list_entities(const std::string &name) const override;
+
+    bool exists(const std::string& entity, const std::string& id) const override;
+
+    bool put_entity(const std::string &name, const std::string &id, const std::string &data, bool &created) override;
+
+    // Reads, mutates and stores the body while holding its shard's lock exclusively.
+    bool update_entity(const std::string &name, const std::string &id,
+                       const std::function<bool(std::string &data)> &mutate, bool &found) override;
+
+    bool delete_entity_if(const std::string &name, const std::string &id,
+                          const std::function<bool(const std::string &data)> &precondition, bool &found) override;
+
+    bool list_entities_page(const std::string &name, const std::string &after, size_t limit,
+                            std::vector<std::string> &ids, bool &more) const override;
+
+    std::vector<std::string> list_entity_types() const override;
+
+    const std::string& get_data_path() const override;
+
+    // Returns the process-wide store for a data path; handlers are created per request,
+    // so this is what keeps the entities between requests. id_scheme only applies when the
+    // store is first created.
+    static std::shared_ptr<MemoryFileSystem> shared(const std::string& data_path,
+                                                    IdGenerator::Scheme id_scheme = IdGenerator::Scheme::kUuid);
+
+private:
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, std::string> bodies; // "name/id" -> body
+    };
+
+    Shard& shard_for(const std::string& key) const;
+    // Adds or removes an id in its type's sorted set; called with the entity's shard locked
+    void index_insert(const std::string& name, const std::string& id);
+    void index_erase(const std::string& name, const std::string& id);
+
+    std::string data_path_;
+    IdGenerator::Scheme id_scheme_;
+    mutable std::array<Shard, kShards> shards_;
+    // Lock order: a shard's mutex, then this one
+    mutable std::shared_mutex types_mutex_;
+    std::map<std::string, std::set<std::string>> types_; // type -> ids in ascending order
+};
+
+#endif // MEMORY_FILE_SYSTEM_H
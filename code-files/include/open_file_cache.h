@@ -0,0 +1,88 @@
+#ifndef OPEN_FILE_CACHE_H
+#define OPEN_FILE_CACHE_H
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <sys/types.h>
+
+// An open file descriptor plus the stat results it was opened with.
+// The descriptor is closed when the last reference goes away, so a file that
+// is evicted from the cache while a request is still reading it stays valid.
+struct OpenFile {
+    int fd = -1;
+    off_t size = 0;
+    time_t mtime = 0;
+    dev_t dev = 0;
+    ino_t ino = 0;
+
+    ~OpenFile();
+};
+
+// nginx-style open file cache. Keeps a bounded LRU table of open descriptors
+// and stat results keyed by path, including negative entries for paths that
+// are missing or not regular files. Entries are trusted for valid_for before
+// the path is re-stat'ed, so repeated hits (and repeated 404 probes) cost no
+// syscalls inside that window.
+class OpenFileCache {
+public:
+    // Counters used by benchmarks to report syscalls per request.
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t syscalls = 0; // open/fstat/stat (and close of rejected fds) issued on lookups
+    };
+
+    // @param max_entries: maximum number of cached paths; 0 disables caching.
+    // @param valid_for: how long an entry is trusted before revalidation.
+    OpenFileCache(size_t max_entries, std::chrono::milliseconds valid_for);
+
+    OpenFileCache(const OpenFileCache&) = delete;
+    OpenFileCache& operator=(const OpenFileCache&) = delete;
+
+    // Looks up (or opens) a regular file.
+    // @param path: full filesystem path of the file.
+    // @return: shared open file, or nullptr if the path is missing or not a regular file.
+    std::shared_ptr<const OpenFile> open(const std::string& path);
+
+    // Returns a snapshot of the hit/miss/syscall counters.
+    Stats stats() const;
+
+    // Returns the process-wide cache for a document root and settings, creating it on first use.
+    // Handlers are constructed per request, so the cache lives here rather than in the handler.
+    // @param doc_root: document root the cache serves.
+    // @param max_entries: maximum number of cached paths.
+    // @param valid_for: entry validity window.
+    static std::shared_ptr<OpenFileCache> shared(const std::string& doc_root,
+                                                 size_t max_entries,
+                                                 std::chrono::milliseconds valid_for);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::shared_ptr<const OpenFile> file; // nullptr for negative entries
+        Clock::time_point validated;
+        std::list<std::string>::iterator lru_it;
+    };
+
+    // Opens and fstat's path without touching the table. Caller holds no lock.
+    std::shared_ptr<const OpenFile> open_uncached(const std::string& path);
+
+    // Removes least recently used entries until the table fits max_entries_.
+    void evict_locked();
+
+    const size_t max_entries_;
+    const std::chrono::milliseconds valid_for_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string> lru_; // front = most recently used
+    Stats stats_;
+};
+
+#endif // OPEN_FILE_CACHE_H
@@ -0,0 +1,63 @@
+#ifndef PAGE_CACHE_H
+#define PAGE_CACHE_H
+
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include "request.h"
+#include "response.h"
+
+// An HTML page rendered once, with its Content-Length and ETag worked out up front.
+struct RenderedPage {
+    std::string body;
+    std::string content_length;
+    std::string etag;
+
+    explicit RenderedPage(std::string html);
+};
+
+// Rendered pages keyed by path, each remembered together with the data it was rendered
+// from. A page is served as long as the caller hands in that same data object (e.g. the
+// parsed quiz from QuizCatalog); a new object means the data changed and the page is
+// rendered again. Holding the source also keeps its address from being reused.
+class PageCache {
+public:
+    PageCache() = default;
+
+    PageCache(const PageCache&) = delete;
+    PageCache& operator=(const PageCache&) = delete;
+
+    // Returns the page for key rendered from source, calling render if there is none yet.
+    // @param key: what identifies the page, e.g. its path.
+    // @param source: the data the page shows; only its identity is compared.
+    // @param render: builds the page's HTML; called without the lock held.
+    std::shared_ptr<const RenderedPage> get(const std::string& key, std::shared_ptr<const void> source,
+                                            const std::function<std::string()>& render);
+
+    // Returns the page for key if it was rendered from source, without rendering it.
+    // @return: nullptr if there is no such page or it was rendered from other data.
+    std::shared_ptr<const RenderedPage> find(const std::string& key, const std::shared_ptr<const void>& source) const;
+
+    // Number of cached pages.
+    size_t size() const;
+
+    // Returns the process-wide page cache for a name (e.g. a quiz_root), creating it on first use.
+    static std::shared_ptr<PageCache> shared(const std::string& name);
+
+private:
+    struct Entry {
+        std::shared_ptr<const void> source;
+        std::shared_ptr<const RenderedPage> page;
+    };
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+};
+
+// Fills res with a 200 text/html response for page, or a bodyless 304 if the request is a
+// GET or HEAD whose If-None-Match already names the page's ETag.
+void serve_page(const request& req, const RenderedPage& page, response& res);
+
+#endif // PAGE_CACHE_H
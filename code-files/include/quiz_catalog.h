@@ -0,0 +1,120 @@
+#ifndef QUIZ_CATALOG_H
+#define QUIZ_CATALOG_H
+
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+struct QuizOption {
+    std::string text;
+    std::string value;
+};
+
+struct QuizQuestion {
+    std::string prompt;
+    std::string image; // empty if the question has none
+    std::vector<QuizOption> options;
+};
+
+struct QuizResult {
+    std::string title;
+    std::string description;
+    std::string image; // empty if the result has none
+};
+
+// A quiz file reduced to the fields the quiz and result pages render.
+struct Quiz {
+    std::string title;
+    std::vector<QuizQuestion> questions;
+    std::unordered_map<std::string, QuizResult> results;
+};
+
+// One entry of the quiz listing page.
+struct QuizListing {
+    std::string id;
+    bool has_image; // <id>.jpg sits next to the quiz
+};
+
+inline bool operator==(const QuizListing& a, const QuizListing& b) {
+    return a.id == b.id && a.has_image == b.has_image;
+}
+
+// Parsed quizzes for one quiz_root, shared by QuizHandler and ResultHandler so a quiz's
+// JSON is parsed once rather than on every view and submission. Each lookup costs one
+// stat(); a quiz whose file changed (mtime, size or inode) is parsed again, and
+// CreateQuizHandler drops a quiz as soon as it rewrites it. The set of quizzes is kept
+// the same way, against the directory's stat.
+//
+// Timestamps are only as fine as the filesystem's clock tick, so a write right after a
+// load can leave mtime unchanged. Anything loaded within kRacyWindow of its mtime is read
+// again on the next lookup, and only replaced if the contents actually differ, so callers
+// keep getting the same shared_ptr for unchanged data.
+class QuizCatalog {
+public:
+    static constexpr std::chrono::nanoseconds kRacyWindow = std::chrono::seconds(1);
+
+    // @param quiz_root: directory holding <id>.json quiz files.
+    explicit QuizCatalog(const std::string& quiz_root);
+
+    QuizCatalog(const QuizCatalog&) = delete;
+    QuizCatalog& operator=(const QuizCatalog&) = delete;
+
+    // Returns the parsed quiz, loading it if it isn't cached or its file has changed.
+    // @param quiz_id: file name without the .json extension.
+    // @return: nullptr if there is no such quiz file, or quiz_id isn't valid_id().
+    // @throws std::runtime_error if the file can't be read or isn't a valid quiz.
+    std::shared_ptr<const Quiz> find(const std::string& quiz_id);
+
+    // Returns the quizzes in the directory in id order, rescanning it if it has changed.
+    // @throws std::filesystem::filesystem_error if the directory can't be read.
+    std::shared_ptr<const std::vector<QuizListing>> list();
+
+    // Forgets a quiz so the next lookup reads its file again, and makes list() rescan.
+    void invalidate(const std::string& quiz_id);
+
+    // Whether a client-supplied id names a quiz file directly under quiz_root: not empty,
+    // no '/', and no leading '.'. Aliases like "./dining" are turned away, so every quiz
+    // has exactly one id to be cached under.
+    static bool valid_id(const std::string& quiz_id);
+
+    // Parses quiz JSON; missing strings and lists read as empty.
+    // @throws std::runtime_error if text isn't a JSON object of the quiz's shape.
+    static Quiz parse(const std::string& text);
+
+    // Returns the process-wide catalog for a quiz_root, creating it on first use.
+    // Handlers are constructed per request, so the catalog lives here rather than in them.
+    static std::shared_ptr<QuizCatalog> shared(const std::string& quiz_root);
+
+private:
+    // What a file's stat looked like when it was loaded
+    struct Stamp {
+        struct timespec mtime = {0, 0};
+        off_t size = 0;
+        ino_t ino = 0;
+        bool racy = true; // loaded too soon after mtime to trust it
+
+        bool matches(const struct stat& st) const;
+    };
+
+    struct Entry {
+        std::shared_ptr<const Quiz> quiz;
+        Stamp stamp;
+        size_t digest; // hash of the file, to tell a racy reload that changed nothing
+    };
+
+    static Stamp stamp_of(const struct stat& st);
+
+    std::string quiz_root_;
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_; // quiz id -> parsed quiz and the stat it was read at
+    std::shared_ptr<const std::vector<QuizListing>> listing_; // nullptr until the first list()
+    Stamp listing_stamp_;
+};
+
+#endif // QUIZ_CATALOG_H
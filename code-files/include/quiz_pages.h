@@ -0,0 +1,31 @@
+#ifndef QUIZ_PAGES_H
+#define QUIZ_PAGES_H
+
+#include <string>
+#include <vector>
+#include "quiz_catalog.h"
+
+// HTML for the quiz pages served by QuizHandler, ResultHandler and CreateQuizHandler.
+// Every page is rendered from HtmlTemplates compiled once at startup, sharing one page
+// header and footer, and written into a single buffer of the exact size. All values are
+// HTML-escaped.
+
+// The /quiz listing.
+std::string render_quiz_list(const std::vector<QuizListing>& quizzes);
+
+// The form for taking a quiz.
+std::string render_quiz_page(const std::string& quiz_id, const Quiz& quiz);
+
+// A result page, with its share link.
+std::string render_result_page(const std::string& quiz_id, const std::string& result_key, const QuizResult& result);
+
+// The page for a submission with no answers.
+std::string render_no_result_page(const std::string& quiz_id);
+
+// The form for creating a quiz.
+std::string render_create_quiz_form();
+
+// Confirmation that a quiz was saved.
+std::string render_quiz_created_page(const std::string& quiz_id);
+
+#endif // QUIZ_PAGES_H
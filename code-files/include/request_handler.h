@@ -19,6 +19,21 @@ public:
     // @param req: the incoming HTTP request.
     // @return: a unique pointer to the response object to be sent back to the client.
     virtual std::unique_ptr<response> handle_request(const request& req) = 0;
+
+    // Called with the finished response; may run on a thread other than the caller's.
+    using Completion = std::function<void(std::unique_ptr<response>)>;
+
+    // Handles a request whose response may finish later (e.g., after a disk read).
+    // The default completes synchronously with handle_request().
+    // @param req: the incoming HTTP request; copied if it is needed after returning.
+    // @param done: invoked exactly once with the response.
+    virtual void handle_request_async(const request& req, Completion done) {
+        done(handle_request(req));
+    }
+
+    // Called on the session's thread when the client goes away before done has run.
+    // A handler parked on an event should run done soon; the default does nothing.
+    virtual void cancel() {}
 };
 
 #endif
\ No newline at end of file
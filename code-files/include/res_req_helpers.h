@@ -2,6 +2,7 @@
 #define RES_REQ_HELPERS
 
 #include <string>
+#include <unordered_map>
 #include "request.h"
 #include "response.h"
 
@@ -10,9 +11,50 @@
 // @return: populated request object.
 request parse_request(const std::string& raw_request);
 
+// Reads the Content-Length header from a raw request whose headers are complete.
+// @param raw_request: request text containing at least the full header block.
+// @param header_end: offset of the "\r\n\r\n" ending the headers.
+// @return: declared body length, or 0 if absent or malformed.
+size_t content_length(const std::string& raw_request, size_t header_end);
+
 // Converts a response struct into a raw HTTP response string.
 // @param res: response object to serialize.
 // @return: HTTP response as a string.
 std::string serialize_response(const response& res);
 
+// Looks up a request header by name, ignoring case.
+// @param req: request to search.
+// @param name: header name (e.g., "Accept-Encoding").
+// @return: header value, or empty string if absent.
+std::string get_header(const request& req, const std::string& name);
+
+// Checks whether the client lists a content coding in Accept-Encoding.
+// Codings listed with q=0 are treated as refused. An entry naming the coding takes
+// precedence over "*", regardless of order.
+// @param req: request to inspect.
+// @param coding: content coding to look for (e.g., "gzip").
+// @return: true if the coding is acceptable.
+bool accepts_encoding(const request& req, const std::string& coding);
+
+// Checks an If-Match or If-None-Match list, e.g. "\"a1\", W/\"b2\"", for an entity tag.
+// "*" matches any tag.
+// @param header: the header value.
+// @param etag: the current tag, quotes included.
+// @param weak: compare weakly (If-None-Match), so W/ tags match too; strong comparison
+//              (If-Match) never matches a weak tag.
+// @return: true if the tag is listed.
+bool etag_matches(const std::string& header, const std::string& etag, bool weak);
+
+// Splits a request URI into its path and percent-decoded query parameters.
+// @param uri: e.g. "/api/Shoes?limit=10&after=abc".
+// @param params: receives {"limit": "10", "after": "abc"}; a key without '=' maps to "".
+// @return: the path, e.g. "/api/Shoes".
+std::string split_query(const std::string& uri, std::unordered_map<std::string, std::string>& params);
+
+// Returns the percent-decoded path of a request URI, without its query string.
+// '+' is left as-is, since it only means a space in query strings.
+// @param uri: e.g. "/assets/my%20file.txt?v=2".
+// @return: e.g. "/assets/my file.txt".
+std::string decode_uri_path(const std::string& uri);
+
 #endif // RES_REQ_HELPERS
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef RESPONSE_H
 #define RESPONSE_H
 
+#include <functional>
 #include <string>
 #include <map>
 
@@ -10,6 +11,16 @@ struct response {
     std::string reason_phrase;    // e.g., "OK", "Not Found"
     std::map<std::string, std::string> headers; // header key-value pairs
     std::string body;             // the response body (html file, image bytes, echo text, etc.)
+    // Optional streamed body, for responses too large to build in memory. The session calls it
+    // for one chunk at a time until it returns false and sends them with chunked transfer
+    // encoding; body is ignored when this is set.
+    std::function<bool(std::string& chunk)> body_stream;
+    // Receives one streamed chunk: more is false (and chunk ignored) once the body is done.
+    using ChunkCallback = std::function<void(bool more, std::string chunk)>;
+    // Optional streamed body whose chunks arrive on their own schedule, e.g. events pushed to a
+    // client. The session calls it for each chunk and writes whatever it is handed, from any
+    // thread, once the callback runs; nothing is held while waiting. Takes precedence over body_stream.
+    std::function<void(ChunkCallback next)> async_body_stream;
 };
 
 #endif // RESPONSE_H
\ No newline at end of file
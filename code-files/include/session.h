@@ -42,16 +42,52 @@ class session{
         // @param bytes_transferred: number of bytes read.
         void handle_read(const boost::system::error_code& error, size_t bytes_transferred);
         
+        // Logs the response metrics line and starts the asynchronous write of a finished response.
+        // Must run on the io_service thread.
+        // @param res: response from the handler.
+        // @param uri: request path, for logging.
+        // @param handler_name: handler that produced the response, for logging.
+        void send_response(response& res, const std::string& uri, const std::string& handler_name);
+
+        // Writes the next chunk of a streamed body, or the terminating chunk once the
+        // stream is exhausted, then closes the session.
+        // @param error: error code from the previous write.
+        void write_next_chunk(const boost::system::error_code& error);
+
+        // Asks the async_body_stream for its next chunk once the previous write finishes.
+        // @param error: error code from the previous write.
+        void request_next_chunk(const boost::system::error_code& error);
+
+        // Frames and writes one chunk, or the terminating chunk if more is false.
+        // @param then: called when the write finishes, if more is true.
+        void write_chunk(bool more, const std::string& chunk,
+                         void (session::*then)(const boost::system::error_code&));
+
+        // Watches the socket while a handler works on the response, so a client that
+        // hangs up is noticed right away rather than when the response is finally written.
+        void watch_for_close();
+
+        // Cancels the pending handler if the client closed the connection.
+        // @param error: error code from the wait; operation_aborted once the response is going out.
+        void handle_client_wait(const boost::system::error_code& error);
+
         // Handles the completion of the asynchronous write operation to the client
         // by closing socket and deleting session
         // @param error: error code from the write operation.
         void handle_write(const boost::system::error_code& error);
 
         tcp::socket socket_; // Socket for communicating with the client.
-        enum { max_length = 1024 }; // Max size for reading chunks of request data.
+        enum { max_length = 16384 }; // Max size for reading chunks of request data.
+        static constexpr size_t kMaxBodySize = 64 * 1024 * 1024; // Larger Content-Lengths get a 413.
         std::string client_ip_; // IP address of the connected client.
         char data_[max_length]; // Buffer for reading incoming data.
         std::string request_buffer_; // Accumulates incoming data to form full HTTP requests.
+        std::string response_buffer_; // Serialized status line and headers; must outlive the async write.
+        std::string response_body_; // Response body, written after response_buffer_ without copying.
+        std::function<bool(std::string&)> body_stream_; // Source of chunks for a streamed response.
+        std::function<void(response::ChunkCallback)> async_body_stream_; // Source of chunks that arrive later.
+        std::shared_ptr<RequestHandler> pending_handler_; // handler whose response hasn't been sent yet
+        bool watching_ = false; // a wait started by watch_for_close() is outstanding
         TrieNode* trie_root_;
         RequestHandlerFactory& factory_; // Factory for creating request handlers.
 };
@@ -0,0 +1,52 @@
+#ifndef SORTED_ID_INDEX_H
+#define SORTED_ID_INDEX_H
+
+#include <functional>
+#include <memory>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// In-memory sorted set of ids per entity type, so listings can be paged by cursor
+// instead of scanning and sorting a whole directory for every page.
+// A type's ids are loaded from storage the first time it is paged; after that,
+// storage calls insert()/erase() to keep it current.
+class SortedIdIndex {
+public:
+    // Produces every id of a type from storage, or {false, {}} if the type doesn't exist.
+    using Loader = std::function<std::pair<bool, std::vector<std::string>>()>;
+
+    SortedIdIndex() = default;
+
+    SortedIdIndex(const SortedIdIndex&) = delete;
+    SortedIdIndex& operator=(const SortedIdIndex&) = delete;
+
+    // Returns ids of a type in ascending order, starting after a cursor.
+    // @param after: exclusive lower bound; empty starts from the first id.
+    // @param limit: maximum number of ids to return.
+    // @param ids: receives the page.
+    // @param more: set to true if ids beyond this page exist.
+    // @param load: called once, under the index lock, if the type isn't loaded yet.
+    // @return: false if the type doesn't exist.
+    bool page(const std::string& name, const std::string& after, size_t limit,
+              std::vector<std::string>& ids, bool& more, const Loader& load);
+
+    // Records a created entity. Ignored until the type has been loaded, since the
+    // load will find it in storage. Callers hold the entity's lock so index updates
+    // happen in the same order as the storage changes.
+    void insert(const std::string& name, const std::string& id);
+
+    // Records a deleted entity. Same rules as insert().
+    void erase(const std::string& name, const std::string& id);
+
+    // Returns the process-wide index for a data path; FileSystem objects are created per request.
+    static std::shared_ptr<SortedIdIndex> shared(const std::string& data_path);
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, std::set<std::string>> types_; // only loaded types
+};
+
+#endif // SORTED_ID_INDEX_H
@@ -2,6 +2,9 @@
 #define STATIC_FILE_HANDLER_H
 
 #include "request_handler.h"
+#include "open_file_cache.h"
+#include <chrono>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -11,8 +14,14 @@ public:
     // Constructs a StaticFileHandler to serve files from a directory.
     // @param mount_point: URL prefix to match (e.g., "/static/").
     // @param doc_root: root directory on disk (local filesystem directory) containing static files (e.g. "/usr/src/project/static").
+    // @param open_file_cache_max: max paths kept in the doc root's open file cache; 0 disables it.
+    // @param open_file_cache_valid: how long a cached fd/stat result is trusted before revalidation.
+    // @param aio: read files that aren't in the page cache on the I/O thread pool instead of the caller's thread.
     StaticFileHandler(const std::string& mount_point,
-                      const std::string& doc_root);
+                      const std::string& doc_root,
+                      size_t open_file_cache_max = kDefaultOpenFileCacheMax,
+                      std::chrono::milliseconds open_file_cache_valid = kDefaultOpenFileCacheValid,
+                      bool aio = true);
 
     // Factory method 
     // @param args: dictionary of argument names to values 
@@ -22,9 +31,53 @@ public:
     // @return: Unique pointer to HTTP response with 200 OK and file content, or 404 Not Found on error.
     virtual std::unique_ptr<response> handle_request(const request& req) override;
 
+    // Same as handle_request(), but a file that isn't fully in the page cache is read on
+    // the I/O thread pool and done is called from that pool thread once the data arrives.
+    virtual void handle_request_async(const request& req, Completion done) override;
+
+    // Maps a file extension (e.g., ".css") to its MIME type.
+    // @return: MIME type, or "application/octet-stream" if unknown.
+    static std::string mime_type(const std::string& extension);
+
+    static constexpr size_t kDefaultOpenFileCacheMax = 1024;
+    static constexpr std::chrono::milliseconds kDefaultOpenFileCacheValid{5000};
+
 private:
+    // A request URI resolved to an open file.
+    struct ResolvedFile {
+        std::shared_ptr<const OpenFile> file;
+        std::string path;       // full filesystem path, for logging
+        std::string mime;       // Content-Type to send
+        bool immutable = false; // requested by its fingerprinted name
+    };
+
+    // Maps the request URI to an open file under doc_root_.
+    // @param resolved: filled in on success.
+    // @return: nullptr on success, otherwise the 404 response to send.
+    std::unique_ptr<response> resolve(const request& req, ResolvedFile& resolved);
+
+    // Builds the 200 response for a file, or a 500 if reading it failed.
+    static std::unique_ptr<response> file_response(const std::string& http_version, const ResolvedFile& resolved,
+                                                   bool read_ok, std::string data);
+
+    // Reads the file through its cached descriptor, after whatever prefix out already holds.
+    // @return: true and the contents in out on success.
+    static bool read_file(const OpenFile& file, std::string& out);
+
+    // Reads the whole file only if it can be served from the page cache without blocking (RWF_NOWAIT).
+    // The first page is probed before the full buffer is allocated, so a cold file costs the
+    // event loop one small read.
+    // @return: false if any part would have to wait for the disk (or the filesystem can't tell);
+    //          out then holds the prefix that was read, for read_file() to carry on from.
+    static bool read_file_nowait(const OpenFile& file, std::string& out);
+
+    // Bytes read_file_nowait() tries before sizing the buffer for the whole file.
+    static constexpr size_t kNowaitProbeBytes = 4096;
+
     std::string mount_point_; // URI prefix this handler responds to.
     std::string doc_root_; // Filesystem directory containing static content.
+    std::shared_ptr<OpenFileCache> open_file_cache_; // Shared fd/stat cache for doc_root_.
+    bool aio_; // Offload cache-miss reads to the I/O thread pool in handle_request_async().
 
     static const std::unordered_map<std::string, std::string> kMimeTypes; // Maps file extensions to MIME types (e.g., ".html" → "text/html").
 };
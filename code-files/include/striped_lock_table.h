@@ -0,0 +1,41 @@
+#ifndef STRIPED_LOCK_TABLE_H
+#define STRIPED_LOCK_TABLE_H
+
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+// Fixed table of reader/writer locks that (entity type, id) pairs hash onto.
+// Writers to the same entity serialize and readers of it wait for them, while
+// work on other entities almost always lands on a different stripe and proceeds
+// in parallel. Memory stays constant no matter how many entities exist.
+class StripedLockTable {
+public:
+    static constexpr size_t kDefaultStripes = 256;
+
+    // @param stripes: number of locks; more stripes mean fewer unrelated collisions.
+    explicit StripedLockTable(size_t stripes = kDefaultStripes);
+
+    StripedLockTable(const StripedLockTable&) = delete;
+    StripedLockTable& operator=(const StripedLockTable&) = delete;
+
+    // Returns the lock guarding an entity.
+    // @param entity: entity type (e.g., "Shoes").
+    // @param id: entity id.
+    std::shared_mutex& lock_for(const std::string& entity, const std::string& id);
+
+    // Returns the process-wide table for a data path. Storage objects are created per
+    // request, so every FileSystem on the same data path has to share one table.
+    static std::shared_ptr<StripedLockTable> shared(const std::string& data_path);
+
+private:
+    // Padded so neighbouring stripes don't share a cache line.
+    struct alignas(64) Stripe {
+        std::shared_mutex mutex;
+    };
+
+    std::vector<Stripe> stripes_;
+};
+
+#endif // STRIPED_LOCK_TABLE_H
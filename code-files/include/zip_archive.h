@@ -0,0 +1,65 @@
+#ifndef ZIP_ARCHIVE_H
+#define ZIP_ARCHIVE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Read-only view of a zip archive. The file is mmap'd once and its central
+// directory is indexed into a hash map, so lookups cost no syscalls and entry
+// data is read straight out of the mapping.
+class ZipArchive {
+public:
+    // Compression methods from the zip spec that we serve.
+    static constexpr uint16_t kStored = 0;
+    static constexpr uint16_t kDeflated = 8;
+
+    // One file in the archive, as described by its central directory record.
+    struct Entry {
+        uint16_t method = 0;          // kStored or kDeflated
+        uint32_t crc32 = 0;           // CRC-32 of the uncompressed data
+        uint32_t compressed_size = 0; // bytes stored in the archive
+        uint32_t size = 0;            // uncompressed size
+        uint64_t data_offset = 0;     // offset of the entry data in the file
+    };
+
+    // Maps and indexes an archive.
+    // @param path: filesystem path of the .zip file.
+    // @throws std::runtime_error if the file can't be mapped or isn't a valid zip.
+    explicit ZipArchive(const std::string& path);
+    ~ZipArchive();
+
+    ZipArchive(const ZipArchive&) = delete;
+    ZipArchive& operator=(const ZipArchive&) = delete;
+
+    // Finds an entry by its path inside the archive (e.g., "css/style.css").
+    // @return: pointer to the entry, or nullptr if absent.
+    const Entry* find(const std::string& name) const;
+
+    // Returns the raw (possibly compressed) bytes of an entry from the mapping.
+    std::string_view raw_data(const Entry& entry) const;
+
+    // Decompresses a deflated entry (or copies a stored one).
+    // @param out: receives the uncompressed bytes.
+    // @return: true on success.
+    bool extract(const Entry& entry, std::string& out) const;
+
+    // Number of indexed file entries (directories are skipped).
+    size_t size() const { return index_.size(); }
+
+    // Returns the process-wide mapping for an archive path, creating it on first use.
+    // @throws std::runtime_error if the archive can't be opened.
+    static std::shared_ptr<ZipArchive> shared(const std::string& path);
+
+private:
+    // Parses the end of central directory record and builds index_.
+    void build_index();
+
+    const unsigned char* base_ = nullptr; // start of the mapping
+    size_t length_ = 0;                   // size of the mapping
+    std::unordered_map<std::string, Entry> index_;
+};
+
+#endif // ZIP_ARCHIVE_H
@@ -0,0 +1,102 @@
+#include "archive_file_handler.h"
+#include "static_file_handler.h"
+#include "res_req_helpers.h"
+#include "logger.h" 
+#include <filesystem>
+
+namespace {
+
+// Fills in a plain 404 response
+void not_found(response& resp) {
+    resp.status_code = 404;
+    resp.reason_phrase = "Not Found";
+    resp.body = "404 Not Found";
+}
+
+// Appends a 32-bit value in little-endian order (gzip header/trailer byte order)
+void append_u32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+} // namespace
+
+ArchiveFileHandler::ArchiveFileHandler(const std::string& mount_point,
+                                       const std::string& archive_path)
+    : mount_point_(mount_point), archive_(ZipArchive::shared(archive_path)) {
+    // Ensure mount_point_ ends with '/'
+    if (!mount_point_.empty() && mount_point_.back() != '/') {
+        mount_point_ += '/';
+    }
+}
+
+std::unique_ptr<RequestHandler> ArchiveFileHandler::create(const std::unordered_map<std::string, std::string>& args) {
+        auto it_mount = args.find("mount_point");
+        auto it_archive = args.find("archive");
+        if (it_mount != args.end() && it_archive != args.end()) {
+            return std::make_unique<ArchiveFileHandler>(it_mount->second, it_archive->second);
+        }
+        return nullptr;
+}
+
+std::string ArchiveFileHandler::gzip_wrap(const ZipArchive::Entry& entry, std::string_view deflated) {
+    // 10-byte header: magic, CM=deflate, no flags, no mtime, no extra flags, OS=unix
+    static const char kHeader[] = {'\x1f', '\x8b', '\x08', 0, 0, 0, 0, 0, 0, '\x03'};
+    std::string out;
+    out.reserve(sizeof(kHeader) + deflated.size() + 8);
+    out.append(kHeader, sizeof(kHeader));
+    out.append(deflated.data(), deflated.size());
+    append_u32(out, entry.crc32);
+    append_u32(out, entry.size);
+    return out;
+}
+
+std::unique_ptr<response> ArchiveFileHandler::handle_request(const request& req) {
+    auto resp = std::make_unique<response>();
+
+    // Mirror HTTP version
+    resp->http_version = req.http_version;
+
+    // Must begin with our mount_point_
+    if (req.uri.rfind(mount_point_, 0) != 0) {
+        LOG_DEBUG << "URI " << req.uri << " is outside mount point " << mount_point_;
+        not_found(*resp);
+        return resp;
+    }
+
+    // Entry names are stored decoded, so look up "my%20file.txt" as "my file.txt".
+    // Archive paths are flat keys, so ".." can't escape the archive; it simply won't match
+    std::string name = decode_uri_path(req.uri.substr(mount_point_.size()));
+    const ZipArchive::Entry* entry = archive_->find(name);
+    if (entry == nullptr) {
+        LOG_DEBUG << "ARCHIVE ENTRY DOESNT EXIST " << name;
+        not_found(*resp);
+        return resp;
+    }
+
+    std::string_view raw = archive_->raw_data(*entry);
+    if (entry->method == ZipArchive::kStored) {
+        resp->body.assign(raw.data(), raw.size());
+    } else if (accepts_encoding(req, "gzip")) {
+        // Serve the deflate stream without decompressing it
+        resp->body = gzip_wrap(*entry, raw);
+        resp->headers["Content-Encoding"] = "gzip";
+    } else if (!archive_->extract(*entry, resp->body)) {
+        LOG_ERROR << "FAILED TO INFLATE ARCHIVE ENTRY " << name;
+        resp->status_code = 500;
+        resp->reason_phrase = "Internal Server Error";
+        resp->body = "500 Internal Server Error";
+        return resp;
+    }
+    if (entry->method == ZipArchive::kDeflated) {
+        resp->headers["Vary"] = "Accept-Encoding";
+    }
+
+    resp->status_code = 200;
+    resp->reason_phrase = "OK";
+    resp->headers["Content-Type"] = StaticFileHandler::mime_type(std::filesystem::path(name).extension().string());
+    resp->headers["Content-Length"] = std::to_string(resp->body.size());
+    LOG_DEBUG << "SUCCESSFUL: ARCHIVE RESPONSE SENDING";
+    return resp;
+}
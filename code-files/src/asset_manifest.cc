@@ -0,0 +1,193 @@
+#include "asset_manifest.h"
+#include "fnv_hash.h"
+#include "logger.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <shared_mutex>
+#include <sys/stat.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 64-bit FNV-1a over a file's contents; stable across builds and platforms
+bool hash_file(const fs::path& path, std::string& hex) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    uint64_t hash = kFnv1a64Basis;
+    char buffer[64 * 1024];
+    while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) {
+        hash = fnv1a_64(std::string_view(buffer, static_cast<size_t>(in.gcount())), hash);
+    }
+    // 48 bits is plenty to tell versions of the same file apart
+    char out[13];
+    std::snprintf(out, sizeof(out), "%012llx", static_cast<unsigned long long>(hash >> 16));
+    hex = out;
+    return true;
+}
+
+// Strips a trailing slash so "/static/" and "/static" name the same mount
+std::string normalize_mount(std::string mount_point) {
+    if (!mount_point.empty() && mount_point.back() == '/') {
+        mount_point.pop_back();
+    }
+    return mount_point;
+}
+
+std::shared_mutex registry_mutex;
+std::unordered_map<std::string, std::shared_ptr<const AssetManifest>> registry;
+
+} // namespace
+
+AssetManifest::AssetManifest(const std::string& mount_point, const std::string& doc_root)
+    : mount_point_(normalize_mount(mount_point)), doc_root_(doc_root) {
+    fs::path root(doc_root);
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end;
+         !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file()) {
+            continue;
+        }
+        std::string rel = it->path().lexically_relative(root).generic_string();
+        if (fingerprint(rel, nullptr).empty()) {
+            LOG_WARNING << "Could not fingerprint " << it->path();
+        }
+    }
+    if (ec) {
+        LOG_WARNING << "Stopped fingerprinting " << doc_root << ": " << ec.message();
+    }
+    LOG_INFO << "Fingerprinted " << size() << " assets under " << mount_point_;
+}
+
+AssetManifest::Stamp AssetManifest::Stamp::of(const struct stat& st) {
+    return Stamp{st.st_size, st.st_mtim, st.st_ino};
+}
+
+bool AssetManifest::Stamp::operator==(const Stamp& other) const {
+    return size == other.size && mtime.tv_sec == other.mtime.tv_sec && mtime.tv_nsec == other.mtime.tv_nsec &&
+           ino == other.ino;
+}
+
+std::string AssetManifest::fingerprint(const std::string& rel_path, const Stamp* expected) const {
+    fs::path path = fs::path(doc_root_) / rel_path;
+    struct stat before;
+    struct stat after;
+    std::string hash;
+    if (::stat(path.c_str(), &before) != 0 || !S_ISREG(before.st_mode) || !hash_file(path, hash) ||
+        ::stat(path.c_str(), &after) != 0) {
+        return "";
+    }
+    // A file rewritten while it was read may not have the contents that were hashed
+    Stamp stamp = Stamp::of(before);
+    if (!(Stamp::of(after) == stamp) || (expected != nullptr && !(*expected == stamp))) {
+        return "";
+    }
+
+    std::string name = fingerprint_name(rel_path, hash);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    by_path_[rel_path] = Asset{name, stamp};
+    by_fingerprint_[name] = Asset{rel_path, stamp};
+    return name;
+}
+
+bool AssetManifest::resolve(const std::string& rel_path, std::string& original) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = by_fingerprint_.find(rel_path);
+    if (it == by_fingerprint_.end()) {
+        return false;
+    }
+    original = it->second.name;
+    return true;
+}
+
+bool AssetManifest::is_current(const std::string& rel_path, const OpenFile& file) const {
+    struct stat st;
+    if (::fstat(file.fd, &st) != 0) {
+        return false;
+    }
+    Stamp stamp = Stamp::of(st);
+    std::string original;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = by_fingerprint_.find(rel_path);
+        if (it == by_fingerprint_.end()) {
+            return false;
+        }
+        if (it->second.stamp == stamp) {
+            return true;
+        }
+        // Already hashed again since it changed, and the contents got a different name
+        original = it->second.name;
+        auto current = by_path_.find(original);
+        if (current != by_path_.end() && current->second.stamp == stamp) {
+            return false;
+        }
+    }
+    // Changed since it was hashed. If only its mtime moved, the new hash is the same name
+    // and the alias is current again; otherwise the old name stays resolvable but mutable.
+    LOG_INFO << "Asset " << original << " changed since it was fingerprinted";
+    return fingerprint(original, &stamp) == rel_path;
+}
+
+std::string AssetManifest::fingerprinted_url(const std::string& rel_path) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = by_path_.find(rel_path);
+    return it == by_path_.end() ? "" : mount_point_ + "/" + it->second.name;
+}
+
+size_t AssetManifest::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return by_path_.size();
+}
+
+std::string AssetManifest::fingerprint_name(const std::string& rel_path, const std::string& hash) {
+    size_t slash = rel_path.rfind('/');
+    size_t base = slash == std::string::npos ? 0 : slash + 1;
+    size_t dot = rel_path.rfind('.');
+    // No extension (or a dotfile): append the hash instead
+    if (dot == std::string::npos || dot <= base) {
+        return rel_path + "." + hash;
+    }
+    return rel_path.substr(0, dot) + "." + hash + rel_path.substr(dot);
+}
+
+void AssetManifest::install(std::shared_ptr<const AssetManifest> manifest) {
+    std::unique_lock<std::shared_mutex> lock(registry_mutex);
+    registry[manifest->mount_point_] = std::move(manifest);
+}
+
+std::shared_ptr<const AssetManifest> AssetManifest::for_mount(const std::string& mount_point) {
+    std::shared_lock<std::shared_mutex> lock(registry_mutex);
+    auto it = registry.find(normalize_mount(mount_point));
+    return it == registry.end() ? nullptr : it->second;
+}
+
+std::string AssetManifest::url(const std::string& url) {
+    std::shared_lock<std::shared_mutex> lock(registry_mutex);
+    if (registry.empty()) {
+        return url;
+    }
+    // Look up each prefix ending before a '/', longest first, so nested mounts win
+    for (size_t slash = url.rfind('/'); slash != std::string::npos; slash = url.rfind('/', slash - 1)) {
+        auto it = registry.find(url.substr(0, slash));
+        if (it != registry.end()) {
+            std::string fingerprinted = it->second->fingerprinted_url(url.substr(slash + 1));
+            if (!fingerprinted.empty()) {
+                return fingerprinted;
+            }
+        }
+        if (slash == 0) {
+            break;
+        }
+    }
+    return url;
+}
+
+void AssetManifest::clear() {
+    std::unique_lock<std::shared_mutex> lock(registry_mutex);
+    registry.clear();
+}
@@ -0,0 +1,100 @@
+#include "caching_file_system.h"
+
+CachingFileSystem::CachingFileSystem(std::shared_ptr<FileSystemInterface> inner, std::shared_ptr<EntityCache> cache)
+    : inner_(std::move(inner)), cache_(std::move(cache)) {}
+
+std::pair<bool, std::string> CachingFileSystem::create_entity(const std::string &name) {
+    // New ids never have a cached body, so there is nothing to invalidate
+    return inner_->create_entity(name);
+}
+
+std::pair<bool, std::string> CachingFileSystem::read_entity(const std::string &name, const std::string &id) const {
+    bool hit = false;
+    return read_entity(name, id, hit);
+}
+
+std::pair<bool, std::string> CachingFileSystem::read_entity(const std::string &name, const std::string &id,
+                                                            bool &hit) const {
+    std::string value;
+    uint64_t generation = 0;
+    hit = cache_->lookup(name, id, value, generation);
+    if (hit) {
+        return {true, value};
+    }
+    auto result = inner_->read_entity(name, id);
+    // Missing entities aren't cached; a 404 costs the store no more than a cache probe would
+    if (result.first) {
+        cache_->insert(name, id, result.second, generation);
+    }
+    return result;
+}
+
+bool CachingFileSystem::read_entity_stored(const std::string &name, const std::string &id,
+                                           StoredEntity &entity) const {
+    return inner_->read_entity_stored(name, id, entity);
+}
+
+bool CachingFileSystem::write_entity(const std::string &name, const std::string &id, const std::string &data) {
+    bool ok = inner_->write_entity(name, id, data);
+    cache_->invalidate(name, id);
+    return ok;
+}
+
+bool CachingFileSystem::delete_entity(const std::string &name, const std::string &id) {
+    bool ok = inner_->delete_entity(name, id);
+    cache_->invalidate(name, id);
+    return ok;
+}
+
+std::pair<bool, std::vector<std::string>> CachingFileSystem::list_entities(const std::string &name) const {
+    return inner_->list_entities(name);
+}
+
+bool CachingFileSystem::update_entity(const std::string &name, const std::string &id,
+                                      const std::function<bool(std::string &data)> &mutate, bool &found) {
+    bool ok = inner_->update_entity(name, id, mutate, found);
+    cache_->invalidate(name, id);
+    return ok;
+}
+
+bool CachingFileSystem::delete_entity_if(const std::string &name, const std::string &id,
+                                         const std::function<bool(const std::string &data)> &precondition,
+                                         bool &found) {
+    bool ok = inner_->delete_entity_if(name, id, precondition, found);
+    cache_->invalidate(name, id);
+    return ok;
+}
+
+bool CachingFileSystem::apply_batch(std::vector<BatchOp>& ops) {
+    bool ok = inner_->apply_batch(ops);
+    for (const auto& op : ops) {
+        if (op.type == BatchOp::kPut || op.type == BatchOp::kDelete) {
+            cache_->invalidate(op.name, op.id);
+        }
+    }
+    return ok;
+}
+
+bool CachingFileSystem::list_entities_page(const std::string &name, const std::string &after, size_t limit,
+                                           std::vector<std::string> &ids, bool &more) const {
+    return inner_->list_entities_page(name, after, limit, ids, more);
+}
+
+std::vector<std::string> CachingFileSystem::list_entity_types() const {
+    return inner_->list_entity_types();
+}
+
+bool CachingFileSystem::exists(const std::string& entity, const std::string& id) const {
+    return inner_->exists(entity, id);
+}
+
+bool CachingFileSystem::put_entity(const std::string &name, const std::string &id, const std::string &data,
+                                   bool &created) {
+    bool ok = inner_->put_entity(name, id, data, created);
+    cache_->invalidate(name, id);
+    return ok;
+}
+
+const std::string& CachingFileSystem::get_data_path() const {
+    return inner_->get_data_path();
+}
@@ -0,0 +1,194 @@
+#include "change_feed.h"
+
+ChangeFeed::ChangeFeed(size_t retention) : retention_(retention) {}
+
+ChangeFeed::~ChangeFeed() {
+    std::vector<Callback> parked;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        for (auto& [name, callbacks] : waiting_) {
+            for (auto& [token, callback] : callbacks) {
+                parked.push_back(std::move(callback));
+            }
+        }
+        waiting_.clear();
+        deadlines_.clear();
+    }
+    timer_cv_.notify_all();
+    if (timer_.joinable()) {
+        timer_.join();
+    }
+    for (auto& callback : parked) {
+        callback(true);
+    }
+}
+
+uint64_t ChangeFeed::record(const std::string& name, const std::string& id, bool deleted) {
+    std::map<uint64_t, Callback> woken;
+    uint64_t seq;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        seq = ++last_seq_;
+        changes_.push_back({seq, name, id, deleted});
+        if (changes_.size() > retention_) {
+            changes_.pop_front();
+        }
+        auto parked = waiting_.find(name);
+        if (parked != waiting_.end()) {
+            woken = std::move(parked->second);
+            waiting_.erase(parked);
+        }
+    }
+    for (auto& [token, callback] : woken) {
+        callback(false);
+    }
+    return seq;
+}
+
+bool ChangeFeed::changes_since(const std::string& name, uint64_t since, std::vector<Change>& changes,
+                               uint64_t& last_seq) const {
+    changes.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    last_seq = last_seq_;
+    if (since > last_seq_) {
+        return false;
+    }
+    // Everything after since must still be retained; 0 asks for whatever is
+    uint64_t first_retained = changes_.empty() ? last_seq_ + 1 : changes_.front().seq;
+    if (since == 0) {
+        since = first_retained - 1;
+    } else if (since + 1 < first_retained) {
+        return false;
+    }
+    // Sequence numbers are contiguous, so since's position is arithmetic
+    for (size_t i = since + 1 - first_retained; i < changes_.size(); ++i) {
+        if (changes_[i].name == name) {
+            changes.push_back(changes_[i]);
+        }
+    }
+    return true;
+}
+
+uint64_t ChangeFeed::wait(const std::string& name, uint64_t since, std::chrono::milliseconds timeout,
+                          Callback callback) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Wake right away if there's already something to report: a change to this type,
+        // or a since the feed can't serve, so the caller finds out now
+        bool ready = stopping_ || since > last_seq_;
+        if (!ready && since < last_seq_) {
+            uint64_t first_retained = changes_.empty() ? last_seq_ + 1 : changes_.front().seq;
+            if (since == 0) {
+                since = first_retained - 1;
+            }
+            if (since + 1 < first_retained) {
+                ready = true;
+            } else {
+                for (size_t i = since + 1 - first_retained; i < changes_.size() && !ready; ++i) {
+                    ready = changes_[i].name == name;
+                }
+            }
+        }
+        if (!ready) {
+            uint64_t token = ++last_token_;
+            waiting_[name].emplace(token, std::move(callback));
+            deadlines_.emplace(Clock::now() + timeout, std::make_pair(name, token));
+            if (!timer_.joinable()) {
+                timer_ = std::thread([this]() { run_timer(); });
+            }
+            timer_cv_.notify_one();
+            return token;
+        }
+    }
+    callback(false);
+    return 0;
+}
+
+void ChangeFeed::cancel(const std::string& name, uint64_t token) {
+    Callback callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto parked = waiting_.find(name);
+        if (parked == waiting_.end()) {
+            return;
+        }
+        auto it = parked->second.find(token);
+        if (it == parked->second.end()) {
+            return;
+        }
+        // Its deadline entry is skipped once it comes due
+        callback = std::move(it->second);
+        parked->second.erase(it);
+        if (parked->second.empty()) {
+            waiting_.erase(parked);
+        }
+    }
+    callback(true);
+}
+
+uint64_t ChangeFeed::last_seq() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_seq_;
+}
+
+size_t ChangeFeed::waiting() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (const auto& [name, callbacks] : waiting_) {
+        count += callbacks.size();
+    }
+    return count;
+}
+
+void ChangeFeed::run_timer() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        if (deadlines_.empty()) {
+            timer_cv_.wait(lock);
+            continue;
+        }
+        auto next = deadlines_.begin()->first;
+        if (Clock::now() < next) {
+            timer_cv_.wait_until(lock, next);
+            continue;
+        }
+        // Collect everything that's due, then run it without the lock
+        std::vector<Callback> expired;
+        auto now = Clock::now();
+        while (!deadlines_.empty() && deadlines_.begin()->first <= now) {
+            auto [name, token] = deadlines_.begin()->second;
+            deadlines_.erase(deadlines_.begin());
+            auto parked = waiting_.find(name);
+            if (parked == waiting_.end()) {
+                continue;
+            }
+            auto it = parked->second.find(token);
+            if (it == parked->second.end()) {
+                continue;
+            }
+            expired.push_back(std::move(it->second));
+            parked->second.erase(it);
+            if (parked->second.empty()) {
+                waiting_.erase(parked);
+            }
+        }
+        lock.unlock();
+        for (auto& callback : expired) {
+            callback(true);
+        }
+        lock.lock();
+    }
+}
+
+std::shared_ptr<ChangeFeed> ChangeFeed::shared(const std::string& data_path) {
+    static std::mutex registry_mutex;
+    static std::unordered_map<std::string, std::shared_ptr<ChangeFeed>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto& feed = registry[data_path];
+    if (!feed) {
+        feed = std::make_shared<ChangeFeed>();
+    }
+    return feed;
+}
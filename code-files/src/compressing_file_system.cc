@@ -0,0 +1,217 @@
+#include "compressing_file_system.h"
+#include "logger.h"
+#include <zlib.h>
+
+namespace {
+
+// Smallest gzip member: 10-byte header, empty deflate stream, 8-byte trailer
+constexpr size_t kMinMemberSize = 18;
+
+uint32_t read_u32(std::string_view bytes, size_t offset) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; --i) {
+        value = (value << 8) | static_cast<unsigned char>(bytes[offset + i]);
+    }
+    return value;
+}
+
+} // namespace
+
+CompressingFileSystem::CompressingFileSystem(std::shared_ptr<FileSystemInterface> inner)
+    : inner_(std::move(inner)) {}
+
+bool CompressingFileSystem::is_compressed(std::string_view stored) {
+    return stored.size() >= kMinMemberSize && static_cast<unsigned char>(stored[0]) == 0x1f &&
+           static_cast<unsigned char>(stored[1]) == 0x8b;
+}
+
+std::string CompressingFileSystem::encode(const std::string& data) {
+    if (data.size() < kMinCompressSize) {
+        return data;
+    }
+    // One "ET" subfield in the gzip header's extra field carries the plain body's ETag
+    std::string etag = entity_etag(data);
+    std::string extra = "ET";
+    extra.push_back(static_cast<char>(etag.size()));
+    extra.push_back(0);
+    extra += etag;
+
+    z_stream stream{};
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return data;
+    }
+    gz_header header{};
+    header.extra = reinterpret_cast<Bytef*>(extra.data());
+    header.extra_len = static_cast<uInt>(extra.size());
+    header.os = 3; // unix
+    deflateSetHeader(&stream, &header);
+
+    std::string out(deflateBound(&stream, data.size()) + extra.size() + 2, '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+    int result = deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    // Incompressible bodies are cheaper to keep plain
+    if (result != Z_STREAM_END || out.size() >= data.size()) {
+        return data;
+    }
+    return out;
+}
+
+bool CompressingFileSystem::decode(std::string_view stored, std::string& data) {
+    if (!is_compressed(stored)) {
+        data.assign(stored);
+        return true;
+    }
+    // The trailer records the plain size, so the output is allocated once
+    data.assign(read_u32(stored, stored.size() - 4), '\0');
+    z_stream stream{};
+    if (inflateInit2(&stream, MAX_WBITS + 16) != Z_OK) {
+        return false;
+    }
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(stored.data()));
+    stream.avail_in = static_cast<uInt>(stored.size());
+    stream.next_out = reinterpret_cast<Bytef*>(data.data());
+    stream.avail_out = static_cast<uInt>(data.size());
+    int result = inflate(&stream, Z_FINISH);
+    bool ok = result == Z_STREAM_END && stream.total_out == data.size();
+    inflateEnd(&stream);
+    return ok;
+}
+
+bool CompressingFileSystem::stored_etag(std::string_view stored, std::string& etag) {
+    const unsigned char kExtraFlag = 0x04;
+    if (!is_compressed(stored) || !(static_cast<unsigned char>(stored[3]) & kExtraFlag)) {
+        return false;
+    }
+    size_t extra_len = static_cast<unsigned char>(stored[10]) | static_cast<unsigned char>(stored[11]) << 8;
+    size_t end = 12 + extra_len;
+    if (end > stored.size()) {
+        return false;
+    }
+    // Subfields: two id bytes, a 16-bit length, then the data
+    for (size_t pos = 12; pos + 4 <= end;) {
+        size_t len = static_cast<unsigned char>(stored[pos + 2]) | static_cast<unsigned char>(stored[pos + 3]) << 8;
+        if (pos + 4 + len > end) {
+            return false;
+        }
+        if (stored[pos] == 'E' && stored[pos + 1] == 'T') {
+            etag.assign(stored.substr(pos + 4, len));
+            return true;
+        }
+        pos += 4 + len;
+    }
+    return false;
+}
+
+std::pair<bool, std::string> CompressingFileSystem::create_entity(const std::string &name) {
+    return inner_->create_entity(name);
+}
+
+std::pair<bool, std::string> CompressingFileSystem::read_entity(const std::string &name, const std::string &id) const {
+    auto [found, stored] = inner_->read_entity(name, id);
+    if (!found || !is_compressed(stored)) {
+        return {found, std::move(stored)};
+    }
+    std::string data;
+    if (!decode(stored, data)) {
+        LOG_ERROR << "Stored entity " << name << "/" << id << " does not inflate";
+        return {false, ""};
+    }
+    return {true, std::move(data)};
+}
+
+bool CompressingFileSystem::read_entity_stored(const std::string &name, const std::string &id,
+                                               StoredEntity &entity) const {
+    auto [found, stored] = inner_->read_entity(name, id);
+    if (!found) {
+        return false;
+    }
+    if (stored_etag(stored, entity.etag)) {
+        entity.encoding = "gzip";
+        entity.data = std::move(stored);
+        return true;
+    }
+    entity.encoding.clear();
+    if (!decode(stored, entity.data)) {
+        LOG_ERROR << "Stored entity " << name << "/" << id << " does not inflate";
+        return false;
+    }
+    entity.etag = entity_etag(entity.data);
+    return true;
+}
+
+bool CompressingFileSystem::write_entity(const std::string &name, const std::string &id, const std::string &data) {
+    return inner_->write_entity(name, id, encode(data));
+}
+
+bool CompressingFileSystem::delete_entity(const std::string &name, const std::string &id) {
+    return inner_->delete_entity(name, id);
+}
+
+std::pair<bool, std::vector<std::string>> CompressingFileSystem::list_entities(const std::string &name) const {
+    return inner_->list_entities(name);
+}
+
+bool CompressingFileSystem::exists(const std::string& entity, const std::string& id) const {
+    return inner_->exists(entity, id);
+}
+
+bool CompressingFileSystem::put_entity(const std::string &name, const std::string &id, const std::string &data,
+                                       bool &created) {
+    return inner_->put_entity(name, id, encode(data), created);
+}
+
+bool CompressingFileSystem::update_entity(const std::string &name, const std::string &id,
+                                          const std::function<bool(std::string &data)> &mutate, bool &found) {
+    return inner_->update_entity(name, id, [&mutate](std::string& stored) {
+        std::string data;
+        if (!decode(stored, data) || !mutate(data)) {
+            return false;
+        }
+        stored = encode(data);
+        return true;
+    }, found);
+}
+
+bool CompressingFileSystem::delete_entity_if(const std::string &name, const std::string &id,
+                                             const std::function<bool(const std::string &data)> &precondition,
+                                             bool &found) {
+    return inner_->delete_entity_if(name, id, [&precondition](const std::string& stored) {
+        std::string data;
+        return decode(stored, data) && precondition(data);
+    }, found);
+}
+
+bool CompressingFileSystem::apply_batch(std::vector<BatchOp>& ops) {
+    for (auto& op : ops) {
+        if (op.type == BatchOp::kCreate || op.type == BatchOp::kPut) {
+            op.data = encode(op.data);
+        }
+    }
+    bool ok = inner_->apply_batch(ops);
+    for (auto& op : ops) {
+        if (op.type == BatchOp::kGet && op.ok && is_compressed(op.data)) {
+            std::string data;
+            op.ok = decode(op.data, data);
+            op.data = std::move(data);
+        }
+    }
+    return ok;
+}
+
+bool CompressingFileSystem::list_entities_page(const std::string &name, const std::string &after, size_t limit,
+                                               std::vector<std::string> &ids, bool &more) const {
+    return inner_->list_entities_page(name, after, limit, ids, more);
+}
+
+std::vector<std::string> CompressingFileSystem::list_entity_types() const {
+    return inner_->list_entity_types();
+}
+
+const std::string& CompressingFileSystem::get_data_path() const {
+    return inner_->get_data_path();
+}
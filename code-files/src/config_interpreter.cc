@@ -36,6 +36,34 @@ std::string find_value_for_key(const NginxConfig* config_block, const std::strin
   throw std::runtime_error("No valid " + key + " directive found in config.");
 }
 
+void copy_optional_arg(const NginxConfig* config_block, const std::string& key, ConfigStruct& config) {
+  if (config_block == nullptr) {
+    return;
+  }
+  try {
+    config.args[key] = find_value_for_key(config_block, key);
+  } catch (const std::runtime_error&) {
+    // Directive not present; handler falls back to its default
+  }
+}
+
+void copy_list_arg(const NginxConfig* config_block, const std::string& key, ConfigStruct& config) {
+  if (config_block == nullptr) {
+    return;
+  }
+  std::string values;
+  for (const auto& statement : config_block->statements_) {
+    if (statement->tokens_.size() >= 2 && statement->tokens_[0] == key) {
+      for (size_t i = 1; i < statement->tokens_.size(); ++i) {
+        values += (values.empty() ? "" : ",") + statement->tokens_[i];
+      }
+    }
+  }
+  if (!values.empty()) {
+    config.args[key] = values;
+  }
+}
+
 short find_listen_port(const NginxConfig* config_block) {
   std::string port_str = find_value_for_key(config_block, "listen");
   try {
@@ -45,6 +73,36 @@ short find_listen_port(const NginxConfig* config_block) {
   }
 }
 
+// CrudHandler locations on one data_path share its store, cache and field indexes, which
+// are set up by whichever location is used first, so they must agree on the directives
+// that shape them; otherwise a write through one location could leave another serving
+// stale data or undecoded gzip, or settings would depend on which location a request happened to hit first.
+static void check_shared_data_paths(const std::vector<ConfigStruct>& handler_configs) {
+  static const char* const kSharedArgs[] = {"entity_cache", "index", "storage", "layout", "id_scheme", "durable",
+                                             "commit_window_us", "compress"};
+  std::map<std::string, const ConfigStruct*> first_for_path;
+  for (const auto& config : handler_configs) {
+    if (config.handler != "CrudHandler") {
+      continue;
+    }
+    auto inserted = first_for_path.emplace(config.args.at("data_path"), &config);
+    if (inserted.second) {
+      continue;
+    }
+    const ConfigStruct& first = *inserted.first->second;
+    for (const char* key : kSharedArgs) {
+      auto a = first.args.find(key);
+      auto b = config.args.find(key);
+      std::string first_value = a == first.args.end() ? "" : a->second;
+      std::string value = b == config.args.end() ? "" : b->second;
+      if (first_value != value) {
+        throw std::runtime_error("CrudHandler locations " + first.uri + " and " + config.uri + " share data_path " +
+                                 config.args.at("data_path") + " but set " + key + " differently");
+      }
+    }
+  }
+}
+
 std::vector<ConfigStruct> extract_handler_configs(const NginxConfig* config_block){
   std::vector<ConfigStruct> handler_configs;
 
@@ -75,12 +133,27 @@ std::vector<ConfigStruct> extract_handler_configs(const NginxConfig* config_bloc
               config.args["mount_point"] = config.uri;
               if (statement->child_block_) {
                 config.args["doc_root"] = find_value_for_key(statement->child_block_.get(), "root");
+                copy_optional_arg(statement->child_block_.get(), "open_file_cache", config);
+                copy_optional_arg(statement->child_block_.get(), "open_file_cache_valid", config);
+                copy_optional_arg(statement->child_block_.get(), "fingerprint", config);
+                copy_optional_arg(statement->child_block_.get(), "aio", config);
               }
               else{
                 throw std::runtime_error("StaticFileHandler is incorrectly configured");
               }
               handler_configs.push_back(config); 
             }
+            else if (config.handler == "ArchiveFileHandler")
+            {
+              config.args["mount_point"] = config.uri;
+              if (statement->child_block_) {
+                config.args["archive"] = find_value_for_key(statement->child_block_.get(), "archive");
+              }
+              else{
+                throw std::runtime_error("ArchiveFileHandler requires a child block with an 'archive' directive.");
+              }
+              handler_configs.push_back(config); 
+            }
             else if (config.handler == "EchoHandler")
             {
               handler_configs.push_back(config); 
@@ -89,6 +162,37 @@ std::vector<ConfigStruct> extract_handler_configs(const NginxConfig* config_bloc
             {
               if (statement->child_block_) {
                 config.args["data_path"] = find_value_for_key(statement->child_block_.get(), "data_path");
+                copy_optional_arg(statement->child_block_.get(), "storage", config);
+                copy_optional_arg(statement->child_block_.get(), "durable", config);
+                copy_optional_arg(statement->child_block_.get(), "commit_window_us", config);
+                copy_optional_arg(statement->child_block_.get(), "entity_cache", config);
+                copy_optional_arg(statement->child_block_.get(), "layout", config);
+                copy_list_arg(statement->child_block_.get(), "index", config);
+                copy_optional_arg(statement->child_block_.get(), "id_scheme", config);
+                copy_optional_arg(statement->child_block_.get(), "ttl", config);
+                copy_optional_arg(statement->child_block_.get(), "compress", config);
+                auto storage = config.args.find("storage");
+                if (storage != config.args.end() && storage->second != "file" && storage->second != "log" &&
+                    storage->second != "memory") {
+                  throw std::runtime_error("CrudHandler storage must be 'file', 'log' or 'memory', got: " + storage->second);
+                }
+                auto layout = config.args.find("layout");
+                if (layout != config.args.end() && layout->second != "flat" && layout->second != "sharded") {
+                  throw std::runtime_error("CrudHandler layout must be 'flat' or 'sharded', got: " + layout->second);
+                }
+                auto id_scheme = config.args.find("id_scheme");
+                if (id_scheme != config.args.end() && id_scheme->second != "uuid" && id_scheme->second != "ulid") {
+                  throw std::runtime_error("CrudHandler id_scheme must be 'uuid' or 'ulid', got: " + id_scheme->second);
+                }
+                auto compress = config.args.find("compress");
+                if (compress != config.args.end() && compress->second != "on" && compress->second != "off") {
+                  throw std::runtime_error("CrudHandler compress must be 'on' or 'off', got: " + compress->second);
+                }
+                auto ttl = config.args.find("ttl");
+                if (ttl != config.args.end() &&
+                    (ttl->second.empty() || ttl->second.find_first_not_of("0123456789") != std::string::npos)) {
+                  throw std::runtime_error("CrudHandler ttl must be a whole number of seconds, got: " + ttl->second);
+                }
               } else {
                 throw std::runtime_error("CrudHandler requires a child block with a 'data_path' directive.");
               }
@@ -127,6 +231,7 @@ std::vector<ConfigStruct> extract_handler_configs(const NginxConfig* config_bloc
         }
         
   }
+   check_shared_data_paths(handler_configs);
    return handler_configs;
 }
 
@@ -3,6 +3,8 @@
 #include "response.h"
 #include "file_system_interface.h"
 #include "logger.h"
+#include "quiz_catalog.h"
+#include "quiz_pages.h"
 
 #include <memory>
 #include <sstream>
@@ -79,78 +81,10 @@ std::unique_ptr<response> CreateQuizHandler::handle_request(const request& req)
 
     if (req.uri == "/quiz/create") {
         if (req.method == "GET") {
-            std::ostringstream body;
-            body << "<html><head><title>BruinFeed Quizzes</title>";
-            body << "<link rel=\"stylesheet\" type=\"text/css\" href=\"/static/quizzes/styles.css\">";
-            body << "<script>"
-                    "let questionCount = 1;"
-                    "function addQuestion() {"
-                    "  const container = document.getElementById('questions');"
-                    "  const qIndex = questionCount++;"
-                    "  const fieldset = document.createElement('fieldset');"
-                    "  fieldset.innerHTML = `"
-                    "<legend>Question ${qIndex + 1}</legend>"
-                    "<label>Prompt: <input type='text' name='q${qIndex}_prompt' required></label><br>"
-                    "Option 1: <input type='text' name='q${qIndex}_opt0_text' placeholder='Option Text' required> "
-                    "<input type='text' name='q${qIndex}_opt0_val' placeholder='Result Value' required><br>"
-                    "Option 2: <input type='text' name='q${qIndex}_opt1_text' placeholder='Option Text' required> "
-                    "<input type='text' name='q${qIndex}_opt1_val' placeholder='Result Value' required><br>"
-                    "Option 3: <input type='text' name='q${qIndex}_opt2_text' placeholder='Option Text' required> "
-                    "<input type='text' name='q${qIndex}_opt2_val' placeholder='Result Value' required><br>"
-                    "Option 4: <input type='text' name='q${qIndex}_opt3_text' placeholder='Option Text' required> "
-                    "<input type='text' name='q${qIndex}_opt3_val' placeholder='Result Value' required><br>"
-                    "`;"
-                    "  container.appendChild(fieldset);"
-                    "}"
-                    "</script>";
-            body << "</head><body><div class='container'>";
-            body << "<h1>Create Quiz</h1>";
-            body << "<p>Create your own UCLA inspired quiz below:</p>";
-
-            body << "<form action=\"/quiz/create\" method=\"POST\">";
-
-            // Quiz ID and title
-            body << "<label>Unique Quiz ID: <input type=\"text\" name=\"quiz_id\" required></label><br><br>";
-            body << "<label>Quiz Title: <input type=\"text\" name=\"title\" required></label><br><br>";
-
-            // One default question
-            body << "<div id='questions'>";
-            body << "<fieldset><legend>Question 1</legend>";
-            body << "<label>Prompt: <input type=\"text\" name=\"q0_prompt\" required></label><br>";
-            for (int j = 0; j < 4; ++j) {
-                body << "Option " << (j + 1) << ": ";
-                body << "<input type=\"text\" name=\"q0_opt" << j << "_text\" placeholder=\"Option Text\" required> ";
-                body << "<input type=\"text\" name=\"q0_opt" << j << "_val\" placeholder=\"Result Value\" required><br>";
-            }
-            body << "</fieldset>";
-            body << "</div><br>";
-
-            body << "<button type=\"button\" onclick=\"addQuestion()\">Add Question</button><br><br>";
-
-            // Results section
-            body << "<h3>Define Result Categories</h3>";
-            body << "<div id='results'>";
-            body << "<p>The results will be matched by value in the options above.</p>";
-
-            for (int i = 0; i < 4; ++i) {
-                body << "<fieldset><legend>Result " << (i + 1) << "</legend>";
-                body << "<label>Result Value Key: <input type=\"text\" name=\"result_" << i << "_key\" required></label><br>";
-                body << "<label>Title: <input type=\"text\" name=\"result_" << i << "_title\" required></label><br>";
-                body << "<label>Description:<br><textarea name=\"result_" << i << "_desc\" rows=\"4\" cols=\"50\" required></textarea></label><br>";
-                body << "</fieldset><br>";
-            }
-            body << "</div>";
-
-            body << "<input type=\"submit\" value=\"Create Quiz\">";
-            body << "</form>";
-            body << "<br><a href=\"/quiz\">Back to BruinFeed Quizzes homepage</a>";
-            body << "</div></body></html>";
-
-
             res->status_code = 200;
             res->reason_phrase = "OK";
             res->headers["Content-Type"] = "text/html";
-            res->body = body.str();
+            res->body = render_create_quiz_form();
         } else if (req.method == "POST") {
             // Parse form-encoded body into key-value pairs
             LOG_INFO << "Raw POST body: " << req.body << std::endl;
@@ -304,6 +238,10 @@ std::unique_ptr<response> CreateQuizHandler::handle_request(const request& req)
             }
 
             bool success = file_system_->write_entity("", quiz_id + ".json", json_out.str());
+            if (success) {
+                // Viewers and submissions see the new version even if its mtime hasn't ticked
+                QuizCatalog::shared(file_system_->get_data_path())->invalidate(quiz_id);
+            }
 
             if (!success) {
                 res->status_code = 500;
@@ -314,15 +252,7 @@ std::unique_ptr<response> CreateQuizHandler::handle_request(const request& req)
                 res->status_code = 200;
                 res->reason_phrase = "OK";
                 res->headers["Content-Type"] = "text/html";
-                std::ostringstream html;
-                html << "<html><head><title>Quiz Created</title>";
-                html << "<link rel=\"stylesheet\" type=\"text/css\" href=\"/static/quizzes/styles.css\">";
-                html << "</head><body><div class='container'>";
-                html << "<h1>Quiz Created Successfully</h1>";
-                html << "<p>Your quiz has been saved as <strong>" << quiz_id << ".json</strong>.</p>";
-                html << "<a href=\"/quiz\">Return to BruinFeed Quizzes Homepage</a>";
-                html << "</div></body></html>";
-                res->body = html.str();
+                res->body = render_quiz_created_page(quiz_id);
             }
         } else {
             res->status_code = 405;
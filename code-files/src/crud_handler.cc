@@ -1,18 +1,153 @@
 #include "crud_handler.h"
+#include "compressing_file_system.h"
+#include "log_file_system.h"
+#include "memory_file_system.h"
+#include "group_commit.h"
+#include "io_thread_pool.h"
+#include "json_validator.h"
+#include "res_req_helpers.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
 #include <filesystem>
+#include <nlohmann/json.hpp>
+#include <sstream>
 
-namespace pt = boost::property_tree;
 namespace fs = std::filesystem;
 
-CrudHandler::CrudHandler(std::shared_ptr<FileSystemInterface> file_system) 
-    : file_system_(file_system) {}
-    
+CrudHandler::CrudHandler(std::shared_ptr<FileSystemInterface> file_system, bool durable,
+                         std::shared_ptr<FieldIndex> index, std::shared_ptr<ChangeFeed> feed,
+                         std::shared_ptr<ExpiryIndex> expiry, std::chrono::seconds default_ttl, bool compressed)
+    : file_system_(file_system), durable_(durable),
+      cache_(std::dynamic_pointer_cast<CachingFileSystem>(file_system)), compressed_(compressed), index_(std::move(index)),
+      feed_(std::move(feed)), expiry_(std::move(expiry)), default_ttl_(default_ttl) {}
+
+bool CrudHandler::valid_id(const std::string& id) {
+    return !id.empty() && id != "." && id != ".." && id.find('/') == std::string::npos;
+}
+
+size_t CrudHandler::parse_cache_size(const std::string& value) {
+    // stoul accepts a sign and would wrap "-1" to a huge budget
+    if (value.empty() || !std::isdigit(static_cast<unsigned char>(value[0]))) {
+        throw std::invalid_argument("not a size: " + value);
+    }
+    size_t pos = 0;
+    size_t size = std::stoul(value, &pos);
+    std::string suffix = value.substr(pos);
+    if (suffix.empty()) {
+        return size;
+    }
+    if (suffix.size() == 1) {
+        switch (std::tolower(static_cast<unsigned char>(suffix[0]))) {
+            case 'k': return size << 10;
+            case 'm': return size << 20;
+            case 'g': return size << 30;
+        }
+    }
+    throw std::invalid_argument("unknown size suffix: " + suffix);
+}
+
 std::unique_ptr<RequestHandler> CrudHandler::create(const std::unordered_map<std::string, std::string>& args) {
     auto it = args.find("data_path");
     if (it != args.end()) {
-        std::filesystem::create_directories(it->second);
+        auto storage = args.find("storage");
+        bool in_memory = storage != args.end() && storage->second == "memory";
+        if (!in_memory) {
+            std::filesystem::create_directories(it->second);
+        }
         LOG_INFO << "Using data_path: " << it->second;
-        return std::make_unique<CrudHandler>(std::make_shared<FileSystem>(it->second));
+        auto durable_it = args.find("durable");
+        bool durable = durable_it != args.end() && durable_it->second == "on";
+        std::chrono::microseconds window = GroupCommit::kDefaultWindow;
+        auto window_it = args.find("commit_window_us");
+        if (window_it != args.end()) {
+            try {
+                window = std::chrono::microseconds(std::stoul(window_it->second));
+            } catch (const std::exception& e) {
+                LOG_WARNING << "Invalid commit_window_us, using default: " << e.what();
+            }
+        }
+
+        size_t cache_bytes = 0;
+        auto cache_it = args.find("entity_cache");
+        if (cache_it != args.end()) {
+            try {
+                cache_bytes = parse_cache_size(cache_it->second);
+            } catch (const std::exception& e) {
+                LOG_WARNING << "Invalid entity_cache, caching disabled: " << e.what();
+            }
+        }
+
+        IdGenerator::Scheme id_scheme = IdGenerator::Scheme::kUuid;
+        auto scheme_it = args.find("id_scheme");
+        if (scheme_it != args.end()) {
+            try {
+                id_scheme = IdGenerator::parse_scheme(scheme_it->second);
+            } catch (const std::exception& e) {
+                LOG_WARNING << "Invalid id_scheme, using uuid: " << e.what();
+            }
+        }
+
+        std::shared_ptr<FileSystemInterface> store;
+        if (storage != args.end() && storage->second == "log") {
+            store = LogFileSystem::shared(it->second, durable, window, id_scheme);
+        } else if (in_memory) {
+            store = MemoryFileSystem::shared(it->second, id_scheme);
+        } else {
+            FileSystem::Layout layout = FileSystem::Layout::kFlat;
+            auto layout_it = args.find("layout");
+            if (layout_it != args.end()) {
+                try {
+                    layout = FileSystem::parse_layout(layout_it->second);
+                } catch (const std::exception& e) {
+                    LOG_WARNING << "Invalid layout, using flat: " << e.what();
+                }
+            }
+            std::shared_ptr<GroupCommit> group_commit = durable ? GroupCommit::for_directory(it->second, window) : nullptr;
+            store = std::make_shared<FileSystem>(it->second, group_commit, layout, id_scheme);
+        }
+        auto compress = args.find("compress");
+        bool compressed = compress != args.end() && compress->second == "on";
+        if (compressed) {
+            store = std::make_shared<CompressingFileSystem>(store);
+        }
+        if (cache_bytes > 0) {
+            store = std::make_shared<CachingFileSystem>(store, EntityCache::shared(it->second, cache_bytes));
+        }
+
+        // The index reads through the same store, so compressed bodies are indexed by their JSON
+        std::shared_ptr<FieldIndex> index;
+        auto index_it = args.find("index");
+        if (index_it != args.end()) {
+            std::vector<std::string> fields = FieldIndex::parse_fields(index_it->second);
+            if (!fields.empty()) {
+                index = FieldIndex::shared(it->second, fields);
+                // Only the first handler for this data path (created at startup) scans storage
+                index->warm(*store);
+            }
+        }
+        std::chrono::seconds default_ttl(0);
+        auto ttl_it = args.find("ttl");
+        if (ttl_it != args.end()) {
+            try {
+                default_ttl = std::chrono::seconds(std::stoul(ttl_it->second));
+            } catch (const std::exception& e) {
+                LOG_WARNING << "Invalid ttl, entities won't expire by default: " << e.what();
+            }
+        }
+        auto feed = ChangeFeed::shared(it->second);
+        // In-memory entities don't outlive the process, so neither do their deadlines
+        auto expiry = ExpiryIndex::shared(it->second, !in_memory);
+        // The reaper deletes through the first handler's store. Every location on a data path
+        // has to build the same store (the config loader checks), so which one doesn't matter.
+        // Reaped entities go through the same index and feed updates as a DELETE.
+        expiry->start_reaper(store, [store, index, feed](const std::string& name, const std::string& id) {
+            if (index) {
+                index->refresh(name, id, *store);
+            }
+            feed->record(name, id, true);
+        });
+        return std::make_unique<CrudHandler>(store, durable, index, feed, expiry, default_ttl, compressed);
     }
     return nullptr;
 }
@@ -32,8 +167,9 @@ std::unique_ptr<response> CrudHandler::handle_request(const request& req) {
         return resp;
     }
 
-    // Strip "/api/" prefix
-    std::string path = req.uri.substr(api_prefix.size());
+    // Strip "/api/" prefix and the query string
+    std::unordered_map<std::string, std::string> query;
+    std::string path = split_query(req.uri, query).substr(api_prefix.size());
 
     // Find first '/' after entity name
     size_t slash_pos = path.find('/');
@@ -48,14 +184,34 @@ std::unique_ptr<response> CrudHandler::handle_request(const request& req) {
         return resp;
     }
 
-    if (req.method == "POST") {
+    // Both come straight from the URI and become file names. A missing id means a listing,
+    // or the 400 each write gives for it.
+    if (!valid_id(entity) || (!id.empty() && !valid_id(id))) {
+        LOG_DEBUG << "Invalid entity type or id in URI: " << req.uri;
+        resp->status_code = 400;
+        resp->reason_phrase = "Bad Request";
+        resp->body = "Invalid entity type or id.";
+        return resp;
+    }
+
+    if (req.method == "POST" && id == "_batch") {
+        return batch(req, entity);
+    } else if (req.method == "POST" && id == "_import") {
+        return import_entities(req, entity);
+    } else if (req.method == "GET" && id == "_export") {
+        return export_entities(entity);
+    } else if (req.method == "POST") {
         return post(req, entity);
+    } else if (req.method == "GET" && id == "_changes") {
+        return changes(req, entity, query);
     } else if (req.method == "GET") {
-        return get(entity, id);
+        return get(req, entity, id, query);
     } else if (req.method == "PUT") {
         return put(req, entity, id);
+    } else if (req.method == "PATCH") {
+        return patch(req, entity, id);
     } else if (req.method == "DELETE") {
-        return delete_req(entity, id);
+        return delete_req(req, entity, id);
     } else {
         resp->status_code = 405;
         resp->reason_phrase = "Method Not Allowed";
@@ -64,6 +220,142 @@ std::unique_ptr<response> CrudHandler::handle_request(const request& req) {
     }
 }
 
+void CrudHandler::handle_request_async(const request& req, Completion done) {
+    // GET /api/<Entity>/_changes?feed=longpoll parks on the change feed instead of a thread
+    std::unordered_map<std::string, std::string> query;
+    std::string path = split_query(req.uri, query);
+    const std::string api_prefix = "/api/";
+    const std::string suffix = "/_changes";
+    auto mode = query.find("feed");
+    if (feed_ && req.method == "GET" && mode != query.end() && mode->second == "longpoll" &&
+        path.size() > api_prefix.size() + suffix.size() && path.compare(0, api_prefix.size(), api_prefix) == 0 &&
+        path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        std::string name = path.substr(api_prefix.size(), path.size() - api_prefix.size() - suffix.size());
+        uint64_t since = 0;
+        if (name.find('/') != std::string::npos || !parse_since(req, query, since)) {
+            done(handle_request(req));
+            return;
+        }
+        std::chrono::milliseconds timeout = kDefaultFeedTimeout;
+        auto timeout_it = query.find("timeout");
+        if (timeout_it != query.end()) {
+            try {
+                timeout = std::min(std::chrono::milliseconds(std::stoul(timeout_it->second)), kMaxFeedTimeout);
+            } catch (const std::exception& e) {
+                LOG_WARNING << "Invalid long-poll timeout, using default: " << e.what();
+            }
+        }
+        // The session keeps this handler alive until done runs
+        parked_name_ = name;
+        parked_token_ = feed_->wait(name, since, timeout, [this, name, since, done = std::move(done)](bool) {
+            done(changes_since(name, since));
+        });
+        return;
+    }
+
+    if (!durable_) {
+        done(handle_request(req));
+        return;
+    }
+    // Separate from the static file read pool so commit waits can't starve file reads
+    static IoThreadPool commit_pool(kCommitPoolThreads);
+    // The session keeps this handler alive until done runs
+    commit_pool.submit([this, req, done = std::move(done)]() {
+        done(handle_request(req));
+    });
+}
+
+void CrudHandler::cancel() {
+    if (feed_ && parked_token_ != 0) {
+        feed_->cancel(parked_name_, parked_token_);
+    }
+}
+
+void CrudHandler::changed(const std::string& name, const std::string& id, bool deleted) {
+    if (index_) {
+        index_->refresh(name, id, *file_system_);
+    }
+    // Recorded after the write is visible, so a client woken by it reads the new state
+    if (feed_) {
+        feed_->record(name, id, deleted);
+    }
+}
+
+bool CrudHandler::parse_ttl(const request& req, std::chrono::seconds& ttl, bool& given) const {
+    std::string header = get_header(req, "X-TTL");
+    given = !header.empty();
+    ttl = default_ttl_;
+    if (!given) {
+        return true;
+    }
+    if (header.find_first_not_of("0123456789") != std::string::npos || header.size() > 9) {
+        return false;
+    }
+    ttl = std::chrono::seconds(std::stoul(header));
+    return true;
+}
+
+void CrudHandler::set_expiry(const std::string& name, const std::string& id, std::chrono::seconds ttl) {
+    if (!expiry_) {
+        return;
+    }
+    if (ttl.count() > 0) {
+        expiry_->set(name, id, ExpiryIndex::Clock::now() + ttl);
+    } else {
+        expiry_->clear(name, id);
+    }
+}
+
+bool CrudHandler::expired(const std::string& name, const std::string& id) const {
+    return expiry_ && expiry_->expired(name, id);
+}
+
+void CrudHandler::drop_expired(const std::string& name, std::vector<std::string>& ids) const {
+    if (!expiry_ || expiry_->size() == 0) {
+        return;
+    }
+    auto now = ExpiryIndex::Clock::now();
+    ids.erase(std::remove_if(ids.begin(), ids.end(),
+                             [&](const std::string& id) { return expiry_->expired(name, id, now); }),
+              ids.end());
+}
+
+std::unique_ptr<response> CrudHandler::invalid_ttl() {
+    auto resp = std::make_unique<response>();
+    resp->http_version = "HTTP/1.1";
+    resp->headers["Content-Type"] = "application/json";
+    resp->status_code = 400;
+    resp->reason_phrase = "Bad Request";
+    resp->body = "X-TTL must be a whole number of seconds\n";
+    return resp;
+}
+
+std::string CrudHandler::encoded_etag(const std::string& etag, const std::string& encoding) {
+    return etag.substr(0, etag.size() - 1) + "-" + encoding + "\"";
+}
+
+bool CrudHandler::matches_current(const std::string& if_match, const std::string& current) const {
+    return etag_matches(if_match, current, false) ||
+           (compressed_ && etag_matches(if_match, encoded_etag(current, "gzip"), false));
+}
+
+std::unique_ptr<response> CrudHandler::precondition_failed(const std::string& name, const std::string& id,
+                                                           const std::string& current) {
+    auto resp = std::make_unique<response>();
+    resp->http_version = "HTTP/1.1";
+    resp->headers["Content-Type"] = "application/json";
+    resp->status_code = 412;
+    resp->reason_phrase = "Precondition Failed";
+    if (current.empty()) {
+        resp->body = "Entity not found\n";
+    } else {
+        resp->headers["ETag"] = current;
+        resp->body = "Entity has changed\n";
+    }
+    LOG_INFO << "If-Match failed for entity: " << name << " with id: " << id;
+    return resp;
+}
+
 std::unique_ptr<response> CrudHandler::post(const request& req, const std::string& name) {
     auto resp = std::make_unique<response>();
     resp->http_version = "HTTP/1.1";
@@ -71,11 +363,8 @@ std::unique_ptr<response> CrudHandler::post(const request& req, const std::strin
     LOG_INFO << "Handling POST request for entity: " << name;
 
     try {
-        std::stringstream ss;
-        ss << req.body;
-
         // Check if the body is empty or contains only whitespace
-        std::string body = ss.str();
+        const std::string& body = req.body;
         if (body.empty() || std::all_of(body.begin(), body.end(), ::isspace)) {
             resp->status_code = 400;
             resp->reason_phrase = "Bad Request";
@@ -84,9 +373,21 @@ std::unique_ptr<response> CrudHandler::post(const request& req, const std::strin
             return resp;
         }
 
-        // Validate JSON
-        pt::ptree pt;
-        pt::read_json(ss, pt);
+        // Validate JSON in a single pass, without building a tree
+        size_t error_offset = 0;
+        if (!JsonValidator::validate(body, &error_offset)) {
+            resp->status_code = 400;
+            resp->reason_phrase = "Bad Format";
+            resp->body = "Invalid JSON format\n";
+            LOG_ERROR << "Invalid JSON format at byte " << error_offset;
+            return resp;
+        }
+
+        std::chrono::seconds ttl;
+        bool ttl_given = false;
+        if (!parse_ttl(req, ttl, ttl_given)) {
+            return invalid_ttl();
+        }
 
         // Create the entity and get the id
         auto [success, id] = file_system_->create_entity(name);
@@ -94,8 +395,13 @@ std::unique_ptr<response> CrudHandler::post(const request& req, const std::strin
         if (success) {
             // Write the entire JSON body to the entity
             if (file_system_->write_entity(name, id, req.body)) {
+                if (ttl.count() > 0) {
+                    set_expiry(name, id, ttl);
+                }
+                changed(name, id, false);
                 resp->status_code = 201;
                 resp->reason_phrase = "Created";
+                resp->headers["ETag"] = entity_etag(req.body);
                 resp->body = "{\"id\": \"" + id + "\"}\n";
                 LOG_INFO << "Entity created successfully with ID: " << id;
             } else {
@@ -110,11 +416,6 @@ std::unique_ptr<response> CrudHandler::post(const request& req, const std::strin
             resp->body = "Failed to create entity\n";
             LOG_ERROR << "Failed to create entity for " << name;
         }
-    } catch (const pt::json_parser_error& e) {
-        resp->status_code = 400;
-        resp->reason_phrase = "Bad Format";
-        resp->body = "Invalid JSON format\n";
-        LOG_ERROR << "Invalid JSON format: " << e.what();
     } catch (const std::exception& e) {
         resp->status_code = 500;
         resp->reason_phrase = "Internal Server Error";
@@ -125,12 +426,36 @@ std::unique_ptr<response> CrudHandler::post(const request& req, const std::strin
     return resp;
 }
 
-std::unique_ptr<response> CrudHandler::get(const std::string& name, const std::string& id) {
+std::unique_ptr<response> CrudHandler::get(const request& req, const std::string& name, const std::string& id,
+                                           const std::unordered_map<std::string, std::string>& query) {
     auto resp = std::make_unique<response>();
     resp->http_version = "HTTP/1.1";
     resp->headers["Content-Type"] = "application/json";
     LOG_INFO << "Handling GET request for entity: " << name << " with id: " << id;
 
+    if (id.empty()) {
+        auto stream = query.find("stream");
+        if (stream != query.end() && (stream->second == "true" || stream->second == "1")) {
+            return list_stream(name);
+        }
+        // Indexed fields filter the listing; other parameters (cache busters and the like) are ignored
+        std::map<std::string, std::string> filters;
+        for (const auto& [key, value] : query) {
+            if (index_ && index_->indexes(key)) {
+                filters.emplace(key, value);
+            }
+        }
+        if (!filters.empty()) {
+            return list_matching(name, filters);
+        }
+        auto limit = query.find("limit");
+        auto after = query.find("after");
+        if (limit != query.end() || after != query.end()) {
+            return list_page(name, limit == query.end() ? "" : limit->second,
+                             after == query.end() ? "" : after->second);
+        }
+    }
+
     // if the ID is not specified, list all ID's associated with the entity
     if (id.empty()) {
         auto [success, ids] = file_system_->list_entities(name);
@@ -140,6 +465,7 @@ std::unique_ptr<response> CrudHandler::get(const std::string& name, const std::s
             resp->body = "Entity type does not exist\n";
             return resp;
         }
+        drop_expired(name, ids);
 
         // Build a json array of ID's tied with the entity to be returned
         std::ostringstream oss;
@@ -157,11 +483,55 @@ std::unique_ptr<response> CrudHandler::get(const std::string& name, const std::s
         return resp;
     }
 
-    auto [success, data] = file_system_->read_entity(name, id);
-    if (success) {
+    bool hit = false;
+    bool success = false;
+    StoredEntity entity;
+    bool consulted_cache = false;
+    if (compressed_) {
+        // Every answer depends on Accept-Encoding, including identity ones and 304s
+        resp->headers["Vary"] = "Accept-Encoding";
+    }
+    if (compressed_ && accepts_encoding(req, "gzip")) {
+        // A compressed body is sent as stored, never inflated and recompressed
+        success = file_system_->read_entity_stored(name, id, entity);
+    } else {
+        auto [found, data] = cache_ ? cache_->read_entity(name, id, hit) : file_system_->read_entity(name, id);
+        consulted_cache = cache_ != nullptr;
+        success = found;
+        entity.data = std::move(data);
+        entity.etag = entity_etag(entity.data);
+    }
+    if (consulted_cache) {
+        EntityCache::Stats stats = cache_->cache().stats();
+        uint64_t lookups = stats.hits + stats.misses;
+        resp->headers["X-Cache"] = hit ? "HIT" : "MISS";
+        LOG_INFO << "[CacheMetrics] path=" << cache_->get_data_path()
+            << " result=" << (hit ? "hit" : "miss")
+            << " hits=" << stats.hits
+            << " misses=" << stats.misses
+            << " hit_rate=" << (lookups ? static_cast<double>(stats.hits) / lookups : 0.0)
+            << " bytes=" << stats.bytes
+            << " entries=" << stats.entries
+            << " evictions=" << stats.evictions;
+    }
+    // An expired entity the reaper hasn't got to yet is already gone
+    if (success && !expired(name, id)) {
+        std::string etag = entity.encoding.empty() ? entity.etag : encoded_etag(entity.etag, entity.encoding);
+        resp->headers["ETag"] = etag;
+        // A poller that already holds this version gets no body
+        std::string if_none_match = get_header(req, "If-None-Match");
+        if (!if_none_match.empty() && etag_matches(if_none_match, etag, true)) {
+            resp->status_code = 304;
+            resp->reason_phrase = "Not Modified";
+            LOG_INFO << "Entity not modified: " << name << " with id: " << id;
+            return resp;
+        }
+        if (!entity.encoding.empty()) {
+            resp->headers["Content-Encoding"] = entity.encoding;
+        }
         resp->status_code = 200;
         resp->reason_phrase = "OK";
-        resp->body = data;
+        resp->body = std::move(entity.data);
         LOG_INFO << "Successfully retrieved entity: " << name << " with id: " << id;
     } else {
         resp->status_code = 404;
@@ -173,6 +543,279 @@ std::unique_ptr<response> CrudHandler::get(const std::string& name, const std::s
     return resp;
 }
 
+std::unique_ptr<response> CrudHandler::list_page(const std::string& name, const std::string& limit_arg,
+                                                 const std::string& after) {
+    auto resp = std::make_unique<response>();
+    resp->http_version = "HTTP/1.1";
+    resp->headers["Content-Type"] = "application/json";
+
+    size_t limit = kDefaultPageLimit;
+    if (!limit_arg.empty()) {
+        size_t pos = 0;
+        try {
+            limit = std::stoul(limit_arg, &pos);
+        } catch (const std::exception&) {
+            pos = 0;
+        }
+        if (pos != limit_arg.size() || limit == 0 || limit_arg[0] == '-') {
+            resp->status_code = 400;
+            resp->reason_phrase = "Bad Request";
+            resp->body = "limit must be a positive integer\n";
+            return resp;
+        }
+    }
+    limit = std::min(limit, kMaxPageLimit);
+
+    std::vector<std::string> ids;
+    bool more = false;
+    if (!file_system_->list_entities_page(name, after, limit, ids, more)) {
+        resp->status_code = 404;
+        resp->reason_phrase = "Not Found";
+        resp->body = "Entity type does not exist\n";
+        return resp;
+    }
+
+    // The cursor is the last id read, even if it has expired, so the next page starts after it
+    std::string next = more ? ids.back() : "";
+    drop_expired(name, ids);
+
+    // {"ids": [...], "next": cursor for the following page, or null on the last one}
+    std::string body = "{\"ids\": [";
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (i > 0) body += ", ";
+        body += "\"" + ids[i] + "\"";
+    }
+    body += "], \"next\": ";
+    body += more ? "\"" + next + "\"" : "null";
+    body += "}\n";
+
+    resp->status_code = 200;
+    resp->reason_phrase = "OK";
+    resp->body = std::move(body);
+    LOG_INFO << "Listed " << ids.size() << " ids for entity: " << name << " after: '" << after << "'";
+    return resp;
+}
+
+std::unique_ptr<response> CrudHandler::list_stream(const std::string& name) {
+    auto resp = std::make_unique<response>();
+    resp->http_version = "HTTP/1.1";
+    resp->headers["Content-Type"] = "application/json";
+
+    // Fetch the first page now so a missing type is still a plain 404
+    std::vector<std::string> first;
+    bool more = false;
+    if (!file_system_->list_entities_page(name, "", kStreamPageSize, first, more)) {
+        resp->status_code = 404;
+        resp->reason_phrase = "Not Found";
+        resp->body = "Entity type does not exist\n";
+        return resp;
+    }
+
+    resp->status_code = 200;
+    resp->reason_phrase = "OK";
+    // Produces the same body as the unpaginated listing, one page of ids per chunk.
+    // Holds the store, not this handler, since chunks are pulled after the handler returns.
+    resp->body_stream = [store = file_system_, expiry = expiry_, name, page = std::move(first), more, started = false,
+                         finished = false](std::string& chunk) mutable {
+        if (finished) {
+            return false;
+        }
+        chunk = started ? "" : "[";
+        for (const auto& id : page) {
+            if (expiry && expiry->expired(name, id)) {
+                continue;
+            }
+            if (started) chunk += ", ";
+            chunk += "\"" + id + "\"";
+            started = true;
+        }
+        if (!more) {
+            chunk += "]\n";
+            finished = true;
+            return true;
+        }
+        std::string after = page.back();
+        if (!store->list_entities_page(name, after, kStreamPageSize, page, more)) {
+            // Type vanished mid-stream; close the array so the body stays valid JSON
+            page.clear();
+            more = false;
+        }
+        return true;
+    };
+    LOG_INFO << "Streaming ids for entity: " << name;
+    return resp;
+}
+
+std::unique_ptr<response> CrudHandler::list_matching(const std::string& name,
+                                                     const std::map<std::string, std::string>& filters) {
+    auto resp = std::make_unique<response>();
+    resp->http_version = "HTTP/1.1";
+    resp->headers["Content-Type"] = "application/json";
+
+    std::vector<std::string> ids;
+    if (!index_->find(name, filters, ids, *file_system_)) {
+        resp->status_code = 404;
+        resp->reason_phrase = "Not Found";
+        resp->body = "Entity type does not exist\n";
+        return resp;
+    }
+    drop_expired(name, ids);
+
+    // Same shape as the unfiltered listing
+    std::string body = "[";
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (i > 0) body += ", ";
+        body += "\"" + ids[i] + "\"";
+    }
+    body += "]\n";
+
+    resp->status_code = 200;
+    resp->reason_phrase = "OK";
+    resp->body = std::move(body);
+    LOG_INFO << "Found " << ids.size() << " matching ids for entity: " << name;
+    return resp;
+}
+
+bool CrudHandler::parse_since(const request& req, const std::unordered_map<std::string, std::string>& query,
+                              uint64_t& since) const {
+    auto since_it = query.find("since");
+    std::string value = since_it == query.end() ? "" : since_it->second;
+    if (value.empty()) {
+        // EventSource sends the id of the last event it saw when it reconnects
+        value = get_header(req, "Last-Event-ID");
+    }
+    if (value.empty()) {
+        since = 0;
+        return true;
+    }
+    if (value == "now") {
+        since = feed_->last_seq();
+        return true;
+    }
+    size_t pos = 0;
+    try {
+        since = std::stoull(value, &pos);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return pos == value.size() && value[0] != '-';
+}
+
+std::unique_ptr<response> CrudHandler::changes_since(const std::string& name, uint64_t since) {
+    auto resp = std::make_unique<response>();
+    resp->http_version = "HTTP/1.1";
+    resp->headers["Content-Type"] = "application/json";
+
+    std::vector<ChangeFeed::Change> changes;
+    uint64_t last_seq = 0;
+    if (!feed_->changes_since(name, since, changes, last_seq)) {
+        // Changes were dropped (or numbering restarted); the client has to relist
+        resp->status_code = 410;
+        resp->reason_phrase = "Gone";
+        resp->body = "{\"error\": \"since is outside the retained change log\", \"last_seq\": " +
+                     std::to_string(last_seq) + "}\n";
+        return resp;
+    }
+
+    std::string body = "{\"results\": [";
+    for (size_t i = 0; i < changes.size(); ++i) {
+        if (i > 0) body += ", ";
+        // An entity that expired since it changed is reported gone before the reaper records it
+        bool deleted = changes[i].deleted || expired(name, changes[i].id);
+        body += "{\"seq\": " + std::to_string(changes[i].seq) + ", \"id\": \"" + changes[i].id +
+                "\", \"deleted\": " + (deleted ? "true" : "false") + "}";
+    }
+    body += "], \"last_seq\": " + std::to_string(last_seq) + "}\n";
+
+    resp->status_code = 200;
+    resp->reason_phrase = "OK";
+    resp->body = std::move(body);
+    return resp;
+}
+
+std::unique_ptr<response> CrudHandler::changes(const request& req, const std::string& name,
+                                               const std::unordered_map<std::string, std::string>& query) {
+    LOG_INFO << "Handling changes request for entity: " << name;
+    if (!feed_) {
+        auto resp = std::make_unique<response>();
+        resp->http_version = "HTTP/1.1";
+        resp->headers["Content-Type"] = "application/json";
+        resp->status_code = 404;
+        resp->reason_phrase = "Not Found";
+        resp->body = "Change feed is not enabled\n";
+        return resp;
+    }
+
+    uint64_t since = 0;
+    if (!parse_since(req, query, since)) {
+        auto resp = std::make_unique<response>();
+        resp->http_version = "HTTP/1.1";
+        resp->headers["Content-Type"] = "application/json";
+        resp->status_code = 400;
+        resp->reason_phrase = "Bad Request";
+        resp->body = "since must be a sequence number or \"now\"\n";
+        return resp;
+    }
+
+    auto mode = query.find("feed");
+    if (mode == query.end() || mode->second != "eventsource") {
+        return changes_since(name, since);
+    }
+
+    std::chrono::milliseconds heartbeat = kHeartbeatInterval;
+    auto heartbeat_it = query.find("heartbeat");
+    if (heartbeat_it != query.end()) {
+        try {
+            heartbeat = std::clamp(std::chrono::milliseconds(std::stoul(heartbeat_it->second)),
+                                   std::chrono::milliseconds(1), kMaxFeedTimeout);
+        } catch (const std::exception& e) {
+            LOG_WARNING << "Invalid heartbeat, using default: " << e.what();
+        }
+    }
+
+    auto resp = std::make_unique<response>();
+    resp->http_version = "HTTP/1.1";
+    resp->status_code = 200;
+    resp->reason_phrase = "OK";
+    resp->headers["Content-Type"] = "text/event-stream";
+    resp->headers["Cache-Control"] = "no-cache";
+    // Each call sends whatever changed since the last one, or parks on the feed until something
+    // does; an empty chunk makes the session ask again. Holds the feed, not this handler.
+    resp->async_body_stream = [feed = feed_, expiry = expiry_, name, since, heartbeat,
+                               ended = false](response::ChunkCallback next) mutable {
+        if (ended) {
+            next(false, "");
+            return;
+        }
+        std::vector<ChangeFeed::Change> changes;
+        uint64_t last_seq = 0;
+        if (!feed->changes_since(name, since, changes, last_seq)) {
+            // Fell behind the retained log; tell the client to relist and end the stream
+            ended = true;
+            next(true, "event: reset\ndata: {\"last_seq\": " + std::to_string(last_seq) + "}\n\n");
+            return;
+        }
+        since = last_seq;
+        if (changes.empty()) {
+            feed->wait(name, since, heartbeat, [next](bool timed_out) {
+                // Heartbeats also reveal a client that has gone away
+                next(true, timed_out ? ": heartbeat\n\n" : "");
+            });
+            return;
+        }
+        std::string events;
+        for (const auto& change : changes) {
+            bool deleted = change.deleted || (expiry && expiry->expired(name, change.id));
+            events += "id: " + std::to_string(change.seq) + "\nevent: change\ndata: {\"seq\": " +
+                      std::to_string(change.seq) + ", \"id\": \"" + change.id + "\", \"deleted\": " +
+                      (deleted ? "true" : "false") + "}\n\n";
+        }
+        next(true, events);
+    };
+    LOG_INFO << "Streaming changes for entity: " << name << " after seq " << since;
+    return resp;
+}
+
 // Implementation of PUT method for updating entities
 std::unique_ptr<response> CrudHandler::put(const request& req, const std::string& name, const std::string& id) {
     auto resp = std::make_unique<response>();
@@ -190,11 +833,8 @@ std::unique_ptr<response> CrudHandler::put(const request& req, const std::string
     }
 
     try {
-        std::stringstream ss;
-        ss << req.body;
-
         // Check if the body is empty or contains only whitespace
-        std::string body = ss.str();
+        const std::string& body = req.body;
         if (body.empty() || std::all_of(body.begin(), body.end(), ::isspace)) {
             resp->status_code = 400;
             resp->reason_phrase = "Bad Request";
@@ -203,21 +843,68 @@ std::unique_ptr<response> CrudHandler::put(const request& req, const std::string
             return resp;
         }
 
-        // Validate JSON
-        pt::ptree pt;
-        pt::read_json(ss, pt);
-        
-        // Check if the entity directory exists, create if not
-        fs::path directory = fs::path(file_system_->get_data_path()) / name;
-        if (!fs::exists(directory)) {
-            fs::create_directories(directory);
+        // Validate JSON in a single pass, without building a tree
+        size_t error_offset = 0;
+        if (!JsonValidator::validate(body, &error_offset)) {
+            resp->status_code = 400;
+            resp->reason_phrase = "Bad Format";
+            resp->body = "Invalid JSON format\n";
+            LOG_ERROR << "Invalid JSON format at byte " << error_offset;
+            return resp;
         }
-        
-        // Check if entity already exists
-        bool entity_existed = file_system_->exists(name, id);
 
-        // Write using interface
-        bool write_success = file_system_->write_entity(name, id, body);
+        std::chrono::seconds ttl;
+        bool ttl_given = false;
+        if (!parse_ttl(req, ttl, ttl_given)) {
+            return invalid_ttl();
+        }
+
+        // With If-Match, the entity is replaced only if it still has the version the client
+        // read; the check and the write happen under the entity's lock in the storage layer
+        std::string if_match = get_header(req, "If-Match");
+        if (!if_match.empty()) {
+            std::string current;
+            bool matched = false;
+            bool found = false;
+            bool updated = file_system_->update_entity(name, id, [&](std::string& data) {
+                if (expired(name, id)) {
+                    found = false;
+                    return false;
+                }
+                current = entity_etag(data);
+                matched = matches_current(if_match, current);
+                if (!matched) {
+                    return false;
+                }
+                set_expiry(name, id, ttl);
+                data = body;
+                return true;
+            }, found);
+            if (!found || !matched) {
+                return precondition_failed(name, id, found ? current : "");
+            }
+            if (!updated) {
+                resp->status_code = 500;
+                resp->reason_phrase = "Internal Server Error";
+                resp->body = "Failed to write entity data\n";
+                LOG_ERROR << "Failed to write entity data for " << name << " with ID: " << id;
+                return resp;
+            }
+            changed(name, id, false);
+            resp->status_code = 200;
+            resp->reason_phrase = "OK";
+            resp->headers["ETag"] = entity_etag(body);
+            resp->body = "{\"id\": \"" + id + "\"}\n";
+            LOG_INFO << "Entity updated successfully with ID: " << id;
+            return resp;
+        }
+
+        // Existence check and write happen atomically in the storage layer
+        bool was_expired = expired(name, id);
+        set_expiry(name, id, ttl);
+        bool entity_created = false;
+        bool write_success = file_system_->put_entity(name, id, body, entity_created);
+        bool entity_existed = !entity_created && !was_expired;
         if (!write_success) {
             resp->status_code = 500;
             resp->reason_phrase = "Internal Server Error";
@@ -225,16 +912,13 @@ std::unique_ptr<response> CrudHandler::put(const request& req, const std::string
             LOG_ERROR << "Failed to write entity data for " << name << " with ID: " << id;
             return resp;
         }
+        changed(name, id, false);
         
         resp->status_code = entity_existed ? 200 : 201;
         resp->reason_phrase = entity_existed ? "OK" : "Created";
+        resp->headers["ETag"] = entity_etag(body);
         resp->body = "{\"id\": \"" + id + "\"}\n";
         LOG_INFO << "Entity " << (entity_existed ? "updated" : "created") << " successfully with ID: " << id;
-    } catch (const pt::json_parser_error& e) {
-        resp->status_code = 400;
-        resp->reason_phrase = "Bad Format";
-        resp->body = "Invalid JSON format\n";
-        LOG_ERROR << "Invalid JSON format: " << e.what();
     } catch (const std::exception& e) {
         resp->status_code = 500;
         resp->reason_phrase = "Internal Server Error";
@@ -245,8 +929,106 @@ std::unique_ptr<response> CrudHandler::put(const request& req, const std::string
     return resp;
 }
 
+std::unique_ptr<response> CrudHandler::patch(const request& req, const std::string& name, const std::string& id) {
+    using json = nlohmann::json;
+    auto resp = std::make_unique<response>();
+    resp->http_version = "HTTP/1.1";
+    resp->headers["Content-Type"] = "application/json";
+    LOG_INFO << "Handling PATCH request for entity: " << name << " with id: " << id;
+
+    if (id.empty()) {
+        resp->status_code = 400;
+        resp->reason_phrase = "Bad Request";
+        resp->body = "ID must be specified for PATCH operation\n";
+        LOG_ERROR << "Missing ID in PATCH request for entity type: " << name;
+        return resp;
+    }
+
+    // Only merge patches are understood; a JSON Patch (RFC 6902) would be misapplied
+    std::string content_type = get_header(req, "Content-Type");
+    if (content_type.find("json-patch") != std::string::npos) {
+        resp->status_code = 415;
+        resp->reason_phrase = "Unsupported Media Type";
+        resp->headers["Accept-Patch"] = "application/merge-patch+json";
+        resp->body = "Only application/merge-patch+json is supported\n";
+        return resp;
+    }
+
+    json patch_doc = json::parse(req.body, nullptr, false);
+    if (patch_doc.is_discarded()) {
+        resp->status_code = 400;
+        resp->reason_phrase = "Bad Format";
+        resp->body = "Invalid JSON format\n";
+        LOG_ERROR << "Invalid merge patch for " << name << "/" << id;
+        return resp;
+    }
+
+    std::chrono::seconds ttl;
+    bool ttl_given = false;
+    if (!parse_ttl(req, ttl, ttl_given)) {
+        return invalid_ttl();
+    }
+
+    // Runs under the entity's lock, so concurrent patches to different fields both land,
+    // and an If-Match version check can't race another write
+    std::string if_match = get_header(req, "If-Match");
+    std::string current;
+    bool matched = true;
+    bool stored_valid = true;
+    bool found = false;
+    bool updated = file_system_->update_entity(name, id, [&](std::string& data) {
+        if (expired(name, id)) {
+            found = false;
+            return false;
+        }
+        if (!if_match.empty()) {
+            current = entity_etag(data);
+            matched = matches_current(if_match, current);
+            if (!matched) {
+                return false;
+            }
+        }
+        json target = json::parse(data, nullptr, false);
+        if (target.is_discarded()) {
+            stored_valid = false;
+            return false;
+        }
+        target.merge_patch(patch_doc);
+        // A patch keeps the entity's deadline unless it sets a new TTL
+        if (ttl_given) {
+            set_expiry(name, id, ttl);
+        }
+        data = target.dump();
+        current = entity_etag(data);
+        return true;
+    }, found);
+
+    if (!if_match.empty() && (!found || !matched)) {
+        return precondition_failed(name, id, found ? current : "");
+    }
+    if (!found) {
+        resp->status_code = 404;
+        resp->reason_phrase = "Not Found";
+        resp->body = "Entity not found\n";
+        LOG_INFO << "Couldn't patch entity: " << name << " with id: " << id << " (not found)";
+    } else if (!updated) {
+        resp->status_code = 500;
+        resp->reason_phrase = "Internal Server Error";
+        resp->body = stored_valid ? "Failed to write entity data\n" : "Stored entity is not valid JSON\n";
+        LOG_ERROR << "Failed to patch entity: " << name << " with id: " << id;
+    } else {
+        changed(name, id, false);
+        resp->status_code = 200;
+        resp->reason_phrase = "OK";
+        resp->headers["ETag"] = current;
+        resp->body = "{\"id\": \"" + id + "\"}\n";
+        LOG_INFO << "Entity patched successfully with ID: " << id;
+    }
+    return resp;
+}
+
 // Implementation of DELETE method for removing entities
-std::unique_ptr<response> CrudHandler::delete_req(const std::string& name, const std::string& id) {
+std::unique_ptr<response> CrudHandler::delete_req(const request& req, const std::string& name, const std::string& id) {
     auto resp = std::make_unique<response>();
     resp->http_version = "HTTP/1.1";
     resp->headers["Content-Type"] = "application/json";
@@ -261,7 +1043,44 @@ std::unique_ptr<response> CrudHandler::delete_req(const std::string& name, const
         return resp;
     }
 
-    if (file_system_->delete_entity(name, id)) {
+    std::string if_match = get_header(req, "If-Match");
+    if (expired(name, id)) {
+        // Already gone as far as reads are concerned; remove it now rather than waiting for the
+        // reaper, unless a PUT renews it first
+        bool found = false;
+        if (file_system_->delete_entity_if(name, id, [&](const std::string&) { return expired(name, id); }, found)) {
+            set_expiry(name, id, std::chrono::seconds(0));
+            changed(name, id, true);
+        }
+        if (!if_match.empty()) {
+            return precondition_failed(name, id, "");
+        }
+        resp->status_code = 404;
+        resp->reason_phrase = "Not Found";
+        resp->body = "Entity not found\n";
+        LOG_INFO << "Couldn't delete entity: " << name << " with id: " << id << " (expired)";
+        return resp;
+    }
+    bool deleted = false;
+    if (if_match.empty()) {
+        deleted = file_system_->delete_entity(name, id);
+    } else {
+        std::string current;
+        bool matched = false;
+        bool found = false;
+        deleted = file_system_->delete_entity_if(name, id, [&](const std::string& data) {
+            current = entity_etag(data);
+            matched = matches_current(if_match, current);
+            return matched;
+        }, found);
+        if (!found || !matched) {
+            return precondition_failed(name, id, found ? current : "");
+        }
+    }
+
+    if (deleted) {
+        set_expiry(name, id, std::chrono::seconds(0));
+        changed(name, id, true);
         resp->status_code = 200;
         resp->reason_phrase = "OK";
         resp->body = "{\"id\": \"" + id + "\", \"deleted\": true}\n";
@@ -274,4 +1093,329 @@ std::unique_ptr<response> CrudHandler::delete_req(const std::string& name, const
     }
 
     return resp;
-}
\ No newline at end of file
+}
+
+std::unique_ptr<response> CrudHandler::batch(const request& req, const std::string& name) {
+    using json = nlohmann::json;
+    auto resp = std::make_unique<response>();
+    resp->http_version = "HTTP/1.1";
+    resp->headers["Content-Type"] = "application/json";
+    LOG_INFO << "Handling batch request for entity: " << name;
+
+    auto bad_request = [&resp](const std::string& message) {
+        resp->status_code = 400;
+        resp->reason_phrase = "Bad Request";
+        resp->body = message + "\n";
+        return std::move(resp);
+    };
+
+    // A JSON array of operations, or one operation per line (NDJSON)
+    std::vector<json> items;
+    size_t first = req.body.find_first_not_of(" \t\r\n");
+    bool ndjson = first != std::string::npos && req.body[first] != '[';
+    try {
+        if (!ndjson && first != std::string::npos) {
+            json parsed = json::parse(req.body);
+            items.assign(parsed.begin(), parsed.end());
+        } else {
+            std::istringstream lines(req.body);
+            std::string line;
+            while (std::getline(lines, line)) {
+                if (line.find_first_not_of(" \t\r") != std::string::npos) {
+                    items.push_back(json::parse(line));
+                }
+            }
+        }
+    } catch (const json::exception& e) {
+        LOG_ERROR << "Invalid batch body: " << e.what();
+        return bad_request("Invalid JSON format");
+    }
+    if (items.empty()) {
+        return bad_request("Batch contains no operations");
+    }
+    if (items.size() > kMaxBatchOps) {
+        return bad_request("Batch exceeds " + std::to_string(kMaxBatchOps) + " operations");
+    }
+    std::chrono::seconds ttl;
+    bool ttl_given = false;
+    if (!parse_ttl(req, ttl, ttl_given)) {
+        return invalid_ttl();
+    }
+
+    // Validate every item up front; invalid ones get an error result and are skipped
+    std::vector<std::string> errors(items.size());
+    std::vector<BatchOp> ops;
+    std::vector<size_t> op_for_item(items.size(), SIZE_MAX);
+    ops.reserve(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        const json& item = items[i];
+        if (!item.is_object() || !item.contains("op") || !item["op"].is_string()) {
+            errors[i] = "each operation needs an \"op\"";
+            continue;
+        }
+        std::string op_name = item["op"];
+        BatchOp op;
+        op.name = name;
+        if (op_name == "create") {
+            op.type = BatchOp::kCreate;
+        } else if (op_name == "get") {
+            op.type = BatchOp::kGet;
+        } else if (op_name == "put") {
+            op.type = BatchOp::kPut;
+        } else if (op_name == "delete") {
+            op.type = BatchOp::kDelete;
+        } else {
+            errors[i] = "unknown op: " + op_name;
+            continue;
+        }
+        if (op.type != BatchOp::kCreate) {
+            if (!item.contains("id") || !item["id"].is_string() || !valid_id(item["id"].get<std::string>())) {
+                errors[i] = "missing or invalid id";
+                continue;
+            }
+            op.id = item["id"];
+        }
+        if (op.type == BatchOp::kCreate || op.type == BatchOp::kPut) {
+            // Any JSON value, as for POST and PUT
+            if (!item.contains("body")) {
+                errors[i] = "missing JSON body";
+                continue;
+            }
+            op.data = item["body"].dump();
+        }
+        op_for_item[i] = ops.size();
+        ops.push_back(std::move(op));
+    }
+
+    // Replaced entities get their new deadline before the write, like PUT
+    for (const auto& op : ops) {
+        if (op.type == BatchOp::kPut) {
+            set_expiry(name, op.id, ttl);
+        }
+    }
+    if (!file_system_->apply_batch(ops)) {
+        resp->status_code = 500;
+        resp->reason_phrase = "Internal Server Error";
+        resp->body = "Batch could not be made durable\n";
+        LOG_ERROR << "Batch of " << ops.size() << " operations for " << name << " was not made durable";
+        return resp;
+    }
+    for (auto& op : ops) {
+        if (op.type == BatchOp::kGet) {
+            op.ok = op.ok && !expired(name, op.id);
+        } else if (op.ok) {
+            if (op.type == BatchOp::kCreate && ttl.count() > 0) {
+                set_expiry(name, op.id, ttl);
+            } else if (op.type == BatchOp::kDelete) {
+                set_expiry(name, op.id, std::chrono::seconds(0));
+            }
+            changed(name, op.id, op.type == BatchOp::kDelete);
+        }
+    }
+
+    // One result per item, in request order, in the same framing as the request
+    std::string body = ndjson ? "" : "[";
+    size_t failed = 0;
+    for (size_t i = 0; i < items.size(); ++i) {
+        std::string result;
+        if (op_for_item[i] == SIZE_MAX) {
+            result = "{\"status\": 400, \"error\": " + json(errors[i]).dump() + "}";
+            ++failed;
+        } else {
+            const BatchOp& op = ops[op_for_item[i]];
+            int status = 200;
+            if (!op.ok) {
+                // Writes fail for storage reasons; reads and deletes because the id doesn't exist
+                status = op.type == BatchOp::kCreate || op.type == BatchOp::kPut ? 500 : 404;
+            } else if (op.type == BatchOp::kCreate || (op.type == BatchOp::kPut && op.created)) {
+                status = 201;
+            }
+            failed += op.ok ? 0 : 1;
+            result = "{\"status\": " + std::to_string(status) + ", \"id\": " + json(op.id).dump();
+            if (op.type == BatchOp::kGet && op.ok) {
+                result += ", \"body\": " + (op.data.empty() ? std::string("null") : op.data);
+            }
+            result += "}";
+        }
+        if (ndjson) {
+            body += result + "\n";
+        } else {
+            body += (i > 0 ? ", " : "") + result;
+        }
+    }
+    if (!ndjson) {
+        body += "]\n";
+    }
+
+    resp->status_code = 200;
+    resp->reason_phrase = "OK";
+    resp->headers["Content-Type"] = ndjson ? "application/x-ndjson" : "application/json";
+    resp->body = std::move(body);
+    LOG_INFO << "Batch of " << items.size() << " operations for " << name << " finished, " << failed << " failed";
+    return resp;
+}
+
+std::unique_ptr<response> CrudHandler::export_entities(const std::string& name) {
+    auto resp = std::make_unique<response>();
+    resp->http_version = "HTTP/1.1";
+    resp->headers["Content-Type"] = "application/x-ndjson";
+
+    std::vector<std::string> first;
+    bool more = false;
+    if (!file_system_->list_entities_page(name, "", kStreamPageSize, first, more)) {
+        resp->status_code = 404;
+        resp->reason_phrase = "Not Found";
+        resp->headers["Content-Type"] = "application/json";
+        resp->body = "Entity type does not exist\n";
+        return resp;
+    }
+
+    resp->status_code = 200;
+    resp->reason_phrase = "OK";
+    // One chunk per page of ids, so memory stays bounded by the page however big the type is.
+    // Entities deleted between listing and reading, or expired but not yet reaped, are skipped.
+    resp->body_stream = [store = file_system_, expiry = expiry_, name, page = std::move(first), more,
+                         finished = false](std::string& chunk) mutable {
+        if (finished) {
+            return false;
+        }
+        chunk.clear();
+        for (const auto& id : page) {
+            if (expiry && expiry->expired(name, id)) {
+                continue;
+            }
+            auto [found, data] = store->read_entity(name, id);
+            if (!found) {
+                continue;
+            }
+            // Line breaks in valid JSON are only ever whitespace, so flattening them keeps one entity per line
+            std::replace(data.begin(), data.end(), '\n', ' ');
+            std::replace(data.begin(), data.end(), '\r', ' ');
+            chunk += "{\"id\": " + nlohmann::json(id).dump() + ", \"body\": " + data + "}\n";
+        }
+        if (!more || !store->list_entities_page(name, page.back(), kStreamPageSize, page, more)) {
+            finished = true;
+        }
+        return true;
+    };
+    LOG_INFO << "Exporting entities of type: " << name;
+    return resp;
+}
+
+std::unique_ptr<response> CrudHandler::import_entities(const request& req, const std::string& name) {
+    using json = nlohmann::json;
+    auto resp = std::make_unique<response>();
+    resp->http_version = "HTTP/1.1";
+    resp->headers["Content-Type"] = "application/json";
+    LOG_INFO << "Handling import for entity: " << name;
+
+    std::chrono::seconds ttl;
+    bool ttl_given = false;
+    if (!parse_ttl(req, ttl, ttl_given)) {
+        return invalid_ttl();
+    }
+
+    size_t imported = 0;
+    size_t failed = 0;
+    json errors = json::array();
+    auto fail = [&](size_t line, const std::string& message) {
+        ++failed;
+        if (errors.size() < kMaxImportErrors) {
+            errors.push_back({{"line", line}, {"error", message}});
+        }
+    };
+
+    // Applies the pending operations as one storage batch, so each costs a single group commit
+    std::vector<BatchOp> ops;
+    std::vector<size_t> op_lines;
+    ops.reserve(kImportBatchOps);
+    auto flush = [&]() {
+        if (ops.empty()) {
+            return true;
+        }
+        for (const auto& op : ops) {
+            if (op.type == BatchOp::kPut) {
+                set_expiry(name, op.id, ttl);
+            }
+        }
+        if (!file_system_->apply_batch(ops)) {
+            return false;
+        }
+        for (size_t i = 0; i < ops.size(); ++i) {
+            if (ops[i].ok) {
+                if (ops[i].type == BatchOp::kCreate && ttl.count() > 0) {
+                    set_expiry(name, ops[i].id, ttl);
+                }
+                ++imported;
+                changed(name, ops[i].id, false);
+            } else {
+                fail(op_lines[i], "write failed");
+            }
+        }
+        ops.clear();
+        op_lines.clear();
+        return true;
+    };
+
+    // Walks the body in place; lines are {"id": "...", "body": {...}} as written by _export,
+    // or {"body": {...}} for a new entity with a generated id
+    const std::string& body = req.body;
+    size_t line_number = 0;
+    bool durable = true;
+    for (size_t pos = 0; pos < body.size() && durable;) {
+        size_t end = body.find('\n', pos);
+        if (end == std::string::npos) {
+            end = body.size();
+        }
+        std::string_view line(body.data() + pos, end - pos);
+        pos = end + 1;
+        ++line_number;
+        if (line.find_first_not_of(" \t\r") == std::string_view::npos) {
+            continue;
+        }
+
+        json item = json::parse(line.begin(), line.end(), nullptr, false);
+        if (item.is_discarded() || !item.is_object()) {
+            fail(line_number, "invalid JSON");
+            continue;
+        }
+        // Any JSON value, as for POST and PUT, so exported scalars come back
+        auto entity = item.find("body");
+        if (entity == item.end()) {
+            fail(line_number, "missing JSON body");
+            continue;
+        }
+        BatchOp op;
+        op.name = name;
+        op.type = BatchOp::kCreate;
+        auto id = item.find("id");
+        if (id != item.end()) {
+            if (!id->is_string() || !valid_id(id->get_ref<const std::string&>())) {
+                fail(line_number, "invalid id");
+                continue;
+            }
+            op.type = BatchOp::kPut;
+            op.id = id->get<std::string>();
+        }
+        op.data = entity->dump();
+        ops.push_back(std::move(op));
+        op_lines.push_back(line_number);
+        if (ops.size() >= kImportBatchOps) {
+            durable = flush();
+        }
+    }
+    durable = durable && flush();
+
+    if (!durable) {
+        resp->status_code = 500;
+        resp->reason_phrase = "Internal Server Error";
+        resp->body = "Import could not be made durable after " + std::to_string(imported) + " entities\n";
+        LOG_ERROR << "Import for " << name << " stopped after " << imported << " entities: not durable";
+        return resp;
+    }
+    resp->status_code = 200;
+    resp->reason_phrase = "OK";
+    resp->body = json({{"imported", imported}, {"failed", failed}, {"errors", errors}}).dump() + "\n";
+    LOG_INFO << "Import for " << name << " finished: " << imported << " imported, " << failed << " failed";
+    return resp;
+}
@@ -0,0 +1,108 @@
+#include "entity_cache.h"
+#include <functional>
+
+namespace {
+
+// Rough per-entry bookkeeping cost (list node, hash node, string headers)
+constexpr size_t kEntryOverhead = 128;
+
+} // namespace
+
+EntityCache::EntityCache(size_t max_bytes)
+    : shard_budget_(max_bytes / kShards), shards_(kShards) {}
+
+std::string EntityCache::make_key(const std::string& entity, const std::string& id) {
+    std::string key;
+    key.reserve(entity.size() + 1 + id.size());
+    key.append(entity).push_back('/');
+    key.append(id);
+    return key;
+}
+
+EntityCache::Shard& EntityCache::shard_for(const std::string& key) {
+    return shards_[std::hash<std::string>{}(key) % shards_.size()];
+}
+
+bool EntityCache::lookup(const std::string& entity, const std::string& id, std::string& value, uint64_t& generation) {
+    std::string key = make_key(entity, id);
+    Shard& shard = shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        generation = shard.generation;
+        return false;
+    }
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru_it);
+    value = it->second.value;
+    return true;
+}
+
+void EntityCache::insert(const std::string& entity, const std::string& id, const std::string& value,
+                         uint64_t generation) {
+    std::string key = make_key(entity, id);
+    size_t charge = key.size() + value.size() + kEntryOverhead;
+    if (charge > shard_budget_) {
+        return; // would evict the whole shard for one entry
+    }
+    Shard& shard = shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.generation != generation) {
+        return;
+    }
+    auto existing = shard.entries.find(key);
+    if (existing != shard.entries.end()) {
+        erase_locked(shard, existing);
+    }
+    shard.lru.push_front(key);
+    shard.entries.emplace(std::move(key), Entry{value, charge, shard.lru.begin()});
+    shard.bytes += charge;
+    bytes_.fetch_add(charge, std::memory_order_relaxed);
+    entries_.fetch_add(1, std::memory_order_relaxed);
+    while (shard.bytes > shard_budget_) {
+        erase_locked(shard, shard.entries.find(shard.lru.back()));
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void EntityCache::invalidate(const std::string& entity, const std::string& id) {
+    std::string key = make_key(entity, id);
+    Shard& shard = shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    ++shard.generation;
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end()) {
+        erase_locked(shard, it);
+    }
+}
+
+void EntityCache::erase_locked(Shard& shard, std::unordered_map<std::string, Entry>::iterator it) {
+    shard.bytes -= it->second.charge;
+    bytes_.fetch_sub(it->second.charge, std::memory_order_relaxed);
+    entries_.fetch_sub(1, std::memory_order_relaxed);
+    shard.lru.erase(it->second.lru_it);
+    shard.entries.erase(it);
+}
+
+EntityCache::Stats EntityCache::stats() const {
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    stats.bytes = bytes_.load(std::memory_order_relaxed);
+    stats.entries = entries_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::shared_ptr<EntityCache> EntityCache::shared(const std::string& data_path, size_t max_bytes) {
+    static std::mutex registry_mutex;
+    static std::unordered_map<std::string, std::shared_ptr<EntityCache>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto& cache = registry[data_path];
+    if (!cache) {
+        cache = std::make_shared<EntityCache>(max_bytes);
+    }
+    return cache;
+}
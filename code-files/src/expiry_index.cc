@@ -0,0 +1,261 @@
+#include "expiry_index.h"
+#include "logger.h"
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Journal records allowed beyond twice the live deadlines before it's rewritten
+constexpr size_t kCompactSlack = 1024;
+
+// How long the reaper backs off when nothing it found could be deleted
+constexpr std::chrono::seconds kRetryDelay{1};
+
+std::string make_key(const std::string& name, const std::string& id) {
+    return name + "/" + id;
+}
+
+} // namespace
+
+ExpiryIndex::ExpiryIndex(const std::string& journal_path) : journal_path_(journal_path) {
+    if (journal_path_.empty()) {
+        return;
+    }
+    // Nothing touches the disk until there is a journal to replay or a deadline to record
+    std::error_code ec;
+    if (!fs::exists(journal_path_, ec)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    load_locked();
+    compact_locked();
+}
+
+ExpiryIndex::~ExpiryIndex() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    reaper_cv_.notify_all();
+    if (reaper_.joinable()) {
+        reaper_.join();
+    }
+}
+
+int64_t ExpiryIndex::to_ms(Clock::time_point deadline) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(deadline.time_since_epoch()).count();
+}
+
+void ExpiryIndex::set(const std::string& name, const std::string& id, Clock::time_point deadline) {
+    std::string key = make_key(name, id);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto [it, inserted] = deadlines_.emplace(key, deadline);
+    if (!inserted) {
+        by_deadline_.erase({it->second, key});
+        it->second = deadline;
+    }
+    by_deadline_.emplace(deadline, key);
+    count_ = deadlines_.size();
+    append_locked(key, to_ms(deadline));
+    if (store_ && !reaper_.joinable()) {
+        reaper_ = std::thread([this]() { run_reaper(); });
+    }
+    reaper_cv_.notify_one();
+}
+
+void ExpiryIndex::clear(const std::string& name, const std::string& id) {
+    if (count_ == 0) {
+        return;
+    }
+    std::string key = make_key(name, id);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (deadlines_.count(key) > 0) {
+        erase_locked(key);
+    }
+}
+
+bool ExpiryIndex::expired(const std::string& name, const std::string& id, Clock::time_point now) const {
+    if (count_ == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = deadlines_.find(make_key(name, id));
+    return it != deadlines_.end() && it->second <= now;
+}
+
+size_t ExpiryIndex::reap(FileSystemInterface& store, const Reaped& on_reaped, Clock::time_point now) {
+    std::vector<std::string> due;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = by_deadline_.begin(); it != by_deadline_.end() && it->first <= now && due.size() < kReapBatch;
+             ++it) {
+            due.push_back(it->second);
+        }
+    }
+
+    size_t reaped = 0;
+    for (const auto& key : due) {
+        size_t slash = key.find('/');
+        std::string name = key.substr(0, slash);
+        std::string id = key.substr(slash + 1);
+        // Checked again under the entity's lock: a PUT that renewed the TTL moves the
+        // deadline before it writes, so a renewed entity is never deleted
+        bool found = false;
+        bool deleted = store.delete_entity_if(name, id, [&](const std::string&) {
+            return expired(name, id, now);
+        }, found);
+        if (deleted || !found) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = deadlines_.find(key);
+            if (it != deadlines_.end() && it->second <= now) {
+                erase_locked(key);
+            }
+        }
+        if (deleted) {
+            ++reaped;
+            if (on_reaped) {
+                on_reaped(name, id);
+            }
+        }
+    }
+    return reaped;
+}
+
+void ExpiryIndex::start_reaper(std::shared_ptr<FileSystemInterface> store, Reaped on_reaped) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (store_) {
+        return;
+    }
+    store_ = std::move(store);
+    on_reaped_ = std::move(on_reaped);
+    if (!deadlines_.empty() && !reaper_.joinable()) {
+        reaper_ = std::thread([this]() { run_reaper(); });
+    }
+}
+
+size_t ExpiryIndex::size() const {
+    return count_;
+}
+
+void ExpiryIndex::run_reaper() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        if (by_deadline_.empty()) {
+            reaper_cv_.wait(lock);
+            continue;
+        }
+        auto next = by_deadline_.begin()->first;
+        if (Clock::now() < next) {
+            reaper_cv_.wait_until(lock, next);
+            continue;
+        }
+        size_t before = deadlines_.size();
+        lock.unlock();
+        size_t reaped = reap(*store_, on_reaped_);
+        if (reaped > 0) {
+            LOG_INFO << "Reaped " << reaped << " expired entities under " << store_->get_data_path();
+        }
+        lock.lock();
+        // Nothing could be deleted (e.g. storage errors); don't spin on the same entries
+        if (reaped == 0 && deadlines_.size() == before) {
+            reaper_cv_.wait_for(lock, kRetryDelay);
+        }
+    }
+}
+
+void ExpiryIndex::erase_locked(const std::string& key) {
+    auto it = deadlines_.find(key);
+    by_deadline_.erase({it->second, key});
+    deadlines_.erase(it);
+    count_ = deadlines_.size();
+    append_locked(key, 0);
+}
+
+void ExpiryIndex::load_locked() {
+    std::ifstream in(journal_path_);
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos) {
+            continue; // torn last record
+        }
+        int64_t ms = 0;
+        try {
+            ms = std::stoll(line.substr(0, tab));
+        } catch (const std::exception&) {
+            continue;
+        }
+        std::string key = line.substr(tab + 1);
+        auto it = deadlines_.find(key);
+        if (it != deadlines_.end()) {
+            by_deadline_.erase({it->second, key});
+            deadlines_.erase(it);
+        }
+        if (ms > 0) {
+            Clock::time_point deadline{std::chrono::milliseconds(ms)};
+            deadlines_.emplace(key, deadline);
+            by_deadline_.emplace(deadline, key);
+        }
+    }
+    count_ = deadlines_.size();
+    if (!deadlines_.empty()) {
+        LOG_INFO << "Loaded " << deadlines_.size() << " entity expiry deadlines from " << journal_path_;
+    }
+}
+
+void ExpiryIndex::append_locked(const std::string& key, int64_t ms) {
+    if (journal_path_.empty()) {
+        return;
+    }
+    if (!journal_.is_open()) {
+        journal_.clear();
+        journal_.open(journal_path_, std::ios::app);
+    }
+    // Not synced: a deadline lost in a crash only means the entity outlives its TTL
+    journal_ << ms << '\t' << key << '\n';
+    journal_.flush();
+    if (!journal_) {
+        if (!journal_failed_) {
+            LOG_WARNING << "Could not write expiry journal " << journal_path_
+                        << "; deadlines set from now on won't survive a restart";
+        }
+        journal_failed_ = true;
+        journal_.close();
+        return;
+    }
+    journal_failed_ = false;
+    if (++journal_records_ > 2 * deadlines_.size() + kCompactSlack) {
+        compact_locked();
+    }
+}
+
+void ExpiryIndex::compact_locked() {
+    journal_.close();
+    std::string tmp = journal_path_ + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        for (const auto& [deadline, key] : by_deadline_) {
+            out << to_ms(deadline) << '\t' << key << '\n';
+        }
+    }
+    std::error_code ec;
+    fs::rename(tmp, journal_path_, ec);
+    if (ec) {
+        LOG_WARNING << "Could not compact expiry journal " << journal_path_ << ": " << ec.message();
+    }
+    journal_.open(journal_path_, std::ios::app);
+    journal_records_ = by_deadline_.size();
+}
+
+std::shared_ptr<ExpiryIndex> ExpiryIndex::shared(const std::string& data_path, bool journaled) {
+    static std::mutex registry_mutex;
+    static std::unordered_map<std::string, std::shared_ptr<ExpiryIndex>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto& index = registry[data_path];
+    if (!index) {
+        index = std::make_shared<ExpiryIndex>(journaled ? (fs::path(data_path) / ".expiry").string() : "");
+    }
+    return index;
+}
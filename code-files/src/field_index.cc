@@ -0,0 +1,234 @@
+#include "field_index.h"
+#include "logger.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <sstream>
+
+namespace {
+
+// One spelling per number, so 10, 10.0 and 1e1 share a key
+std::string number_key(const nlohmann::json& number) {
+    if (number.is_number_float()) {
+        double value = number.get<double>();
+        if (std::isfinite(value) && value == std::trunc(value) && std::fabs(value) < 9.2e18) {
+            return std::to_string(static_cast<int64_t>(value));
+        }
+    }
+    return number.dump();
+}
+
+// Indexed form of a field value; false for values that aren't indexed
+bool index_key(const nlohmann::json& value, std::string& key) {
+    if (value.is_string()) {
+        key = FieldIndex::normalize(value.get<std::string>());
+        return true;
+    }
+    if (value.is_number()) {
+        key = number_key(value);
+        return true;
+    }
+    if (value.is_boolean()) {
+        key = value.dump();
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+FieldIndex::FieldIndex(std::vector<std::string> fields) : fields_(std::move(fields)) {}
+
+bool FieldIndex::indexes(const std::string& field) const {
+    return std::find(fields_.begin(), fields_.end(), field) != fields_.end();
+}
+
+std::string FieldIndex::normalize(const std::string& value) {
+    if (value.empty() || !(std::isdigit(static_cast<unsigned char>(value[0])) || value[0] == '-')) {
+        return value;
+    }
+    nlohmann::json number = nlohmann::json::parse(value, nullptr, false);
+    return number.is_number() ? number_key(number) : value;
+}
+
+bool FieldIndex::find(const std::string& name, const std::map<std::string, std::string>& filters,
+                      std::vector<std::string>& ids, const FileSystemInterface& store) {
+    ids.clear();
+    // Intersects the posting sets, smallest first
+    auto collect = [&](const TypeIndex& type) {
+        std::vector<const std::set<std::string>*> sets;
+        static const std::set<std::string> kEmpty;
+        for (const auto& [field, value] : filters) {
+            auto postings = type.postings.find(field);
+            const std::set<std::string>* matches = &kEmpty;
+            if (postings != type.postings.end()) {
+                auto it = postings->second.find(normalize(value));
+                if (it != postings->second.end()) {
+                    matches = &it->second;
+                }
+            }
+            sets.push_back(matches);
+        }
+        if (sets.empty()) {
+            return;
+        }
+        std::sort(sets.begin(), sets.end(), [](auto* a, auto* b) { return a->size() < b->size(); });
+        for (const auto& id : *sets[0]) {
+            bool all = std::all_of(sets.begin() + 1, sets.end(), [&id](auto* set) { return set->count(id) > 0; });
+            if (all) {
+                ids.push_back(id);
+            }
+        }
+    };
+
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto type = types_.find(name);
+        if (type != types_.end()) {
+            collect(type->second);
+            return true;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    TypeIndex* type = load_locked(name, store);
+    if (type == nullptr) {
+        return false;
+    }
+    collect(*type);
+    return true;
+}
+
+void FieldIndex::refresh(const std::string& name, const std::string& id, const FileSystemInterface& store) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        if (types_.find(name) == types_.end()) {
+            return;
+        }
+    }
+    // Refreshes of one id run one at a time, each reading after its own write, so the
+    // last one to apply has read the newest contents
+    std::unique_lock<std::shared_mutex> id_lock(refresh_locks_.lock_for(name, id));
+    auto [found, data] = store.read_entity(name, id);
+    std::vector<std::pair<std::string, std::string>> values;
+    if (found) {
+        values = extract(data);
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto type = types_.find(name);
+    if (type != types_.end()) {
+        index_locked(type->second, id, found ? &values : nullptr);
+    }
+}
+
+void FieldIndex::warm(const FileSystemInterface& store) {
+    if (warmed_.exchange(true)) {
+        return;
+    }
+    size_t types = 0;
+    size_t entities = 0;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    for (const auto& name : store.list_entity_types()) {
+        TypeIndex* type = load_locked(name, store);
+        if (type != nullptr) {
+            ++types;
+            entities += type->values.size();
+        }
+    }
+    LOG_INFO << "Built field indexes for " << entities << " entities of " << types
+             << " types under " << store.get_data_path();
+}
+
+FieldIndex::TypeIndex* FieldIndex::load_locked(const std::string& name, const FileSystemInterface& store) {
+    auto existing = types_.find(name);
+    if (existing != types_.end()) {
+        return &existing->second;
+    }
+    // Loading under the exclusive lock means no refresh can slip in between
+    // the storage scan and the type becoming visible
+    auto [found, ids] = store.list_entities(name);
+    if (!found) {
+        return nullptr;
+    }
+    TypeIndex& type = types_[name];
+    for (const auto& id : ids) {
+        auto [read, data] = store.read_entity(name, id);
+        if (read) {
+            auto values = extract(data);
+            index_locked(type, id, &values);
+        }
+    }
+    return &type;
+}
+
+std::vector<std::pair<std::string, std::string>> FieldIndex::extract(const std::string& data) const {
+    std::vector<std::pair<std::string, std::string>> values;
+    nlohmann::json body = nlohmann::json::parse(data, nullptr, false);
+    if (body.is_object()) {
+        for (const auto& field : fields_) {
+            auto it = body.find(field);
+            std::string key;
+            if (it != body.end() && index_key(*it, key)) {
+                values.emplace_back(field, std::move(key));
+            }
+        }
+    }
+    return values;
+}
+
+void FieldIndex::index_locked(TypeIndex& type, const std::string& id,
+                              std::vector<std::pair<std::string, std::string>>* values) {
+    // Drop whatever was indexed for the id before
+    auto old = type.values.find(id);
+    if (old != type.values.end()) {
+        for (const auto& [field, value] : old->second) {
+            auto& by_value = type.postings[field];
+            auto it = by_value.find(value);
+            if (it != by_value.end()) {
+                it->second.erase(id);
+                if (it->second.empty()) {
+                    by_value.erase(it);
+                }
+            }
+        }
+        type.values.erase(old);
+    }
+    if (values == nullptr) {
+        return;
+    }
+    for (const auto& [field, key] : *values) {
+        type.postings[field][key].insert(id);
+    }
+    // Remember the id even with nothing indexed so it counts as loaded
+    type.values.emplace(id, std::move(*values));
+}
+
+std::vector<std::string> FieldIndex::parse_fields(const std::string& value) {
+    std::vector<std::string> fields;
+    std::string normalized = value;
+    std::replace(normalized.begin(), normalized.end(), ',', ' ');
+    std::istringstream in(normalized);
+    std::string field;
+    while (in >> field) {
+        if (std::find(fields.begin(), fields.end(), field) == fields.end()) {
+            fields.push_back(field);
+        }
+    }
+    return fields;
+}
+
+std::shared_ptr<FieldIndex> FieldIndex::shared(const std::string& data_path, const std::vector<std::string>& fields) {
+    static std::mutex registry_mutex;
+    static std::unordered_map<std::string, std::shared_ptr<FieldIndex>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto& index = registry[data_path];
+    if (!index) {
+        index = std::make_shared<FieldIndex>(fields);
+    }
+    return index;
+}
@@ -1,16 +1,59 @@
 #include "file_system.h"
+#include "fnv_hash.h"
+#include <atomic>
+#include <cstdio>
+#include <stdexcept>
+#include <unistd.h>
 
 namespace fs = std::filesystem;
-namespace uuids = boost::uuids;
 
-FileSystem::FileSystem(const std::string& data_path)
-    : data_path_(data_path) {
+FileSystem::FileSystem(const std::string& data_path, std::shared_ptr<GroupCommit> group_commit, Layout layout,
+                       IdGenerator::Scheme id_scheme)
+    : data_path_(data_path), layout_(layout), id_scheme_(id_scheme), group_commit_(std::move(group_commit)),
+      locks_(StripedLockTable::shared(data_path)), sorted_ids_(SortedIdIndex::shared(data_path)) {
     fs::path root_directory(data_path_);
     if (!fs::exists(root_directory)) {
         fs::create_directories(root_directory);
     }
 }
 
+FileSystem::Layout FileSystem::parse_layout(const std::string& value) {
+    if (value == "flat") {
+        return Layout::kFlat;
+    }
+    if (value == "sharded") {
+        return Layout::kSharded;
+    }
+    throw std::invalid_argument("layout must be 'flat' or 'sharded', got: " + value);
+}
+
+// 32-bit FNV-1a of the id, finalized; the top 16 bits pick one of 65536 leaf directories.
+// Hashing (rather than taking the id's first characters) also spreads ids chosen by PUT.
+std::string FileSystem::shard_dir(const std::string& id) {
+    uint32_t hash = fnv1a_32(id);
+    // FNV's high bits barely change with the last byte; mix so ids differing only at the end spread out
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    char out[6];
+    std::snprintf(out, sizeof(out), "%02x/%02x", (hash >> 24) & 0xff, (hash >> 16) & 0xff);
+    return out;
+}
+
+fs::path FileSystem::entity_dir(const std::string& name, const std::string& id) const {
+    fs::path directory = fs::path(data_path_) / name;
+    if (layout_ == Layout::kSharded) {
+        return directory / shard_dir(id);
+    }
+    return directory;
+}
+
+fs::path FileSystem::entity_file(const std::string& name, const std::string& id) const {
+    return entity_dir(name, id) / id;
+}
+
 // Creates a new entity file inside a named entity directory and returns a generated UUID.
 // If the directory does not exist, it is created.
 std::pair<bool, std::string> FileSystem::create_entity(const std::string &name) {
@@ -20,26 +63,30 @@ std::pair<bool, std::string> FileSystem::create_entity(const std::string &name)
         fs::create_directories(directory);
     }
 
-    // Generate UUID for entity and create the entity file
-    uuids::uuid uuid = uuids::random_generator()();
-    std::string id = to_string(uuid);
-    fs::path file = directory / id;
+    // Generate an id for the entity and create the entity file
+    std::string id = IdGenerator::next(id_scheme_);
+    fs::path file = entity_file(name, id);
+    if (layout_ == Layout::kSharded) {
+        std::error_code ec;
+        fs::create_directories(entity_dir(name, id), ec);
+    }
+    std::unique_lock<std::shared_mutex> lock(locks_->lock_for(name, id));
     std::ofstream out(file);
     if (!out) {
         return {false, "File cannot be opened"};        
     }
     out.close();
+    sorted_ids_->insert(name, id);
+    // No group commit for the empty file: an entity is made durable by its first write,
+    // which commits the directory entry along with the contents
     return {true, id};
 }
 
 // Reads the contents of a specific entity file given by name and id.
 // Returns the file's content as a string if it exists and can be read.
 std::pair<bool, std::string> FileSystem::read_entity(const std::string &name, const std::string &id) const {
-    fs::path directory = fs::path(data_path_) / name;
-    if (!fs::exists(directory)) {
-        return {false, ""};
-    }
-    fs::path file = directory / id;
+    fs::path file = entity_file(name, id);
+    std::shared_lock<std::shared_mutex> lock(locks_->lock_for(name, id));
     if (!fs::exists(file)) {
         return {false, ""};
     }
@@ -56,18 +103,110 @@ std::pair<bool, std::string> FileSystem::read_entity(const std::string &name, co
 // Writes data to an existing entity file identified by name and id.
 // Returns false if the directory or file doesn't exist, or if writing fails.
 bool FileSystem::write_entity(const std::string &name, const std::string &id, const std::string &data) {
-    // Check if entity directory already exists
-    fs::path directory = fs::path(data_path_) / name;
-    if (!fs::exists(directory)) {
-        return false;
-    }
-    
     // Check if entity file with given ID already exists
-    fs::path file = directory / id;
+    fs::path file = entity_file(name, id);
+    if (group_commit_) {
+        return write_entity_durable(name, id, data, [&file]() { return fs::exists(file); });
+    }
+    std::unique_lock<std::shared_mutex> lock(locks_->lock_for(name, id));
     if (!fs::exists(file)) {
         return false;
     }
-    
+    return write_file(file, data);
+}
+
+// Creates or overwrites an entity; the existence check and the write happen under
+// the entity's lock, so concurrent PUTs and DELETEs of the same id can't interleave.
+bool FileSystem::put_entity(const std::string &name, const std::string &id, const std::string &data, bool &created) {
+    fs::path file = entity_file(name, id);
+    std::error_code ec;
+    fs::create_directories(entity_dir(name, id), ec);
+    if (ec) {
+        return false;
+    }
+    if (group_commit_) {
+        return write_entity_durable(name, id, data, [&]() {
+            created = !fs::exists(file);
+            return true;
+        }, [&]() {
+            // The commit after the rename can still fail; index whatever actually landed
+            if (created) {
+                sorted_ids_->insert(name, id);
+            }
+        });
+    }
+    std::unique_lock<std::shared_mutex> lock(locks_->lock_for(name, id));
+    created = !fs::exists(file);
+    bool ok = write_file(file, data);
+    if (created && fs::exists(file)) {
+        sorted_ids_->insert(name, id);
+    }
+    return ok;
+}
+
+bool FileSystem::update_entity(const std::string &name, const std::string &id,
+                               const std::function<bool(std::string &data)> &mutate, bool &found) {
+    fs::path file = entity_file(name, id);
+    if (group_commit_) {
+        return update_entity_durable(name, id, mutate, found);
+    }
+    std::unique_lock<std::shared_mutex> lock(locks_->lock_for(name, id));
+    std::ifstream in(file);
+    found = static_cast<bool>(in);
+    if (!found) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    in.close();
+    std::string data = buffer.str();
+    return mutate(data) && write_file(file, data);
+}
+
+// The durable version can't hold the lock from the read to the write, since staging waits
+// for a group commit. It stages the mutated contents, then renames them into place only
+// if the entity still holds what was read; if another write landed in between, it starts
+// over from that write, so no update is lost.
+bool FileSystem::update_entity_durable(const std::string &name, const std::string &id,
+                                       const std::function<bool(std::string &data)> &mutate, bool &found) {
+    fs::path file = entity_file(name, id);
+    while (true) {
+        std::string current;
+        {
+            std::shared_lock<std::shared_mutex> lock(locks_->lock_for(name, id));
+            found = read_file(file, current);
+        }
+        if (!found) {
+            return false;
+        }
+        std::string data = current;
+        if (!mutate(data)) {
+            return false;
+        }
+        bool raced = false;
+        bool ok = write_entity_durable(name, id, data, [&]() {
+            std::string now;
+            raced = !read_file(file, now) || now != current;
+            return !raced;
+        });
+        if (!raced) {
+            return ok;
+        }
+    }
+}
+
+bool FileSystem::read_file(const fs::path& file, std::string& data) {
+    std::ifstream in(file);
+    if (!in) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    data = buffer.str();
+    return true;
+}
+
+bool FileSystem::write_file(const fs::path& file, const std::string& data) {
     // Check if the file has opened to write the data inside
     std::ofstream out(file);
     if (!out) {
@@ -80,17 +219,158 @@ bool FileSystem::write_entity(const std::string &name, const std::string &id, co
 
 // Implement delete_entity method
 bool FileSystem::delete_entity(const std::string &name, const std::string &id) {
-    fs::path directory = fs::path(data_path_) / name;
-    if (!fs::exists(directory)) {
+    fs::path file = entity_file(name, id);
+    std::unique_lock<std::shared_mutex> lock(locks_->lock_for(name, id));
+    if (!fs::exists(file)) {
         return false;
     }
     
-    fs::path file = directory / id;
-    if (!fs::exists(file)) {
+    if (!fs::remove(file)) {
         return false;
     }
-    
-    return fs::remove(file);
+    sorted_ids_->erase(name, id);
+    lock.unlock(); // nothing else needs the entity held while the removal is committed
+    return !group_commit_ || group_commit_->sync();
+}
+
+bool FileSystem::delete_entity_if(const std::string &name, const std::string &id,
+                                  const std::function<bool(const std::string &data)> &precondition, bool &found) {
+    fs::path file = entity_file(name, id);
+    std::unique_lock<std::shared_mutex> lock(locks_->lock_for(name, id));
+    std::ifstream in(file);
+    found = static_cast<bool>(in);
+    if (!found) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    in.close();
+    if (!precondition(buffer.str()) || !fs::remove(file)) {
+        return false;
+    }
+    sorted_ids_->erase(name, id);
+    lock.unlock();
+    return !group_commit_ || group_commit_->sync();
+}
+
+// Readers see either the old or the new contents, never a partial write, and a crash
+// leaves one of the two on disk. The data is flushed before the rename so the rename
+// can't become durable first and expose an empty file after a crash. Like apply_batch(),
+// the entity's lock is only held for the rename, not while waiting on either commit.
+bool FileSystem::write_entity_durable(const std::string& name, const std::string& id, const std::string& data,
+                                      const std::function<bool()>& before_rename,
+                                      const std::function<void()>& after_rename) {
+    std::error_code ec;
+    fs::path tmp = stage_file(id, data);
+    if (tmp.empty()) {
+        return false;
+    }
+    if (!group_commit_->sync()) {
+        fs::remove(tmp, ec);
+        return false;
+    }
+    {
+        std::unique_lock<std::shared_mutex> lock(locks_->lock_for(name, id));
+        if (!before_rename()) {
+            fs::remove(tmp, ec);
+            return false;
+        }
+        fs::rename(tmp, entity_file(name, id), ec);
+        if (ec) {
+            fs::remove(tmp, ec);
+            return false;
+        }
+        if (after_rename) {
+            after_rename();
+        }
+    }
+    return group_commit_->sync();
+}
+
+fs::path FileSystem::stage_file(const std::string& id, const std::string& data) {
+    static std::atomic<uint64_t> tmp_counter{0};
+    fs::path tmp_dir = fs::path(data_path_) / ".tmp";
+    std::error_code ec;
+    fs::create_directories(tmp_dir, ec);
+    fs::path tmp = tmp_dir / (id + "." + std::to_string(::getpid()) + "." + std::to_string(tmp_counter++));
+    std::ofstream out(tmp);
+    if (!out) {
+        return {};
+    }
+    out << data;
+    out.close();
+    if (!out) {
+        fs::remove(tmp, ec);
+        return {};
+    }
+    return tmp;
+}
+
+// Durable batches stage every body first, make them durable with one commit, apply the
+// operations in order with renames, then commit once more: two flushes per batch
+// rather than two per operation.
+bool FileSystem::apply_batch(std::vector<BatchOp>& ops) {
+    if (!group_commit_) {
+        return FileSystemInterface::apply_batch(ops);
+    }
+
+    std::vector<fs::path> staged(ops.size());
+    bool any_staged = false;
+    for (size_t i = 0; i < ops.size(); ++i) {
+        BatchOp& op = ops[i];
+        if (op.type == BatchOp::kCreate) {
+            op.id = IdGenerator::next(id_scheme_);
+        }
+        if (op.type == BatchOp::kCreate || op.type == BatchOp::kPut) {
+            staged[i] = stage_file(op.id, op.data);
+            any_staged = any_staged || !staged[i].empty();
+        }
+    }
+    std::error_code ec;
+    if (any_staged && !group_commit_->sync()) {
+        for (const auto& tmp : staged) {
+            if (!tmp.empty()) fs::remove(tmp, ec);
+        }
+        return false;
+    }
+
+    bool changed = false;
+    for (size_t i = 0; i < ops.size(); ++i) {
+        BatchOp& op = ops[i];
+        if (op.type == BatchOp::kGet) {
+            auto [found, data] = read_entity(op.name, op.id);
+            op.ok = found;
+            op.data = std::move(data);
+            continue;
+        }
+        fs::path file = entity_file(op.name, op.id);
+        std::unique_lock<std::shared_mutex> lock(locks_->lock_for(op.name, op.id));
+        if (op.type == BatchOp::kDelete) {
+            op.ok = fs::remove(file, ec);
+            if (op.ok) {
+                sorted_ids_->erase(op.name, op.id);
+                changed = true;
+            }
+            continue;
+        }
+        if (staged[i].empty()) {
+            op.ok = false;
+            continue;
+        }
+        op.created = !fs::exists(file);
+        fs::create_directories(entity_dir(op.name, op.id), ec);
+        fs::rename(staged[i], file, ec);
+        op.ok = !ec;
+        if (ec) {
+            fs::remove(staged[i], ec);
+            continue;
+        }
+        if (op.created) {
+            sorted_ids_->insert(op.name, op.id);
+        }
+        changed = true;
+    }
+    return !changed || group_commit_->sync();
 }
 
 // Lists all entity file IDs under a given entity type (directory name).
@@ -103,6 +383,16 @@ std::pair<bool, std::vector<std::string>> FileSystem::list_entities(const std::s
         return {false, ids};
     }
 
+    if (layout_ == Layout::kSharded) {
+        // Entities sit two directory levels down; no single directory gets large
+        for (const auto& entry : fs::recursive_directory_iterator(entity_dir)) {
+            if (entry.is_regular_file()) {
+                ids.push_back(entry.path().filename().string());
+            }
+        }
+        return {true, ids};
+    }
+
     for (const auto& entry : fs::directory_iterator(entity_dir)) {
         if (entry.is_regular_file()) {
             ids.push_back(entry.path().filename().string());
@@ -112,11 +402,85 @@ std::pair<bool, std::vector<std::string>> FileSystem::list_entities(const std::s
     return {true, ids};
 }
 
+bool FileSystem::list_entities_page(const std::string &name, const std::string &after, size_t limit,
+                                    std::vector<std::string> &ids, bool &more) const {
+    return sorted_ids_->page(name, after, limit, ids, more, [this, &name]() {
+        return list_entities(name);
+    });
+}
+
+std::vector<std::string> FileSystem::list_entity_types() const {
+    std::vector<std::string> names;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(data_path_, ec)) {
+        std::string name = entry.path().filename().string();
+        // Skip the durable-write temp directory and anything else hidden
+        if (entry.is_directory() && !name.empty() && name[0] != '.') {
+            names.push_back(name);
+        }
+    }
+    return names;
+}
+
 const std::string& FileSystem::get_data_path() const {
     return data_path_;
 }
 
 bool FileSystem::exists(const std::string& entity, const std::string& id) const {
-    std::filesystem::path file_path = std::filesystem::path(data_path_) / entity / id;
-    return std::filesystem::exists(file_path);
+    std::shared_lock<std::shared_mutex> lock(locks_->lock_for(entity, id));
+    return fs::exists(entity_file(entity, id));
+}
+
+size_t FileSystem::migrate(const std::string& data_path, Layout to) {
+    size_t moved = 0;
+    for (const auto& type_entry : fs::directory_iterator(data_path)) {
+        std::string name = type_entry.path().filename().string();
+        // Skip the durable-write temp directory and anything else hidden
+        if (!type_entry.is_directory() || name.empty() || name[0] == '.') {
+            continue;
+        }
+        // Collect first; renaming while iterating would revisit moved files
+        std::vector<fs::path> files;
+        for (const auto& entry : fs::recursive_directory_iterator(type_entry.path())) {
+            if (entry.is_regular_file()) {
+                files.push_back(entry.path());
+            }
+        }
+        // Stage every file that has to move before creating or removing any directory: an
+        // id can equal a shard directory name (e.g. "ab"), so moving files straight into
+        // place could collide with a flat file or a shard directory of the same name
+        fs::path staging = type_entry.path() / ".migrating";
+        auto target_for = [&](const std::string& id) {
+            return to == Layout::kSharded ? type_entry.path() / shard_dir(id) / id : type_entry.path() / id;
+        };
+        std::vector<std::string> staged;
+        for (const auto& file : files) {
+            std::string id = file.filename().string();
+            if (file == target_for(id)) {
+                continue;
+            }
+            if (file.parent_path() != staging) {
+                fs::create_directories(staging);
+                fs::rename(file, staging / id);
+            }
+            staged.push_back(id);
+        }
+        if (to == Layout::kFlat) {
+            // Shard directories only hold files already staged
+            for (const auto& entry : fs::directory_iterator(type_entry.path())) {
+                if (entry.is_directory() && entry.path() != staging) {
+                    fs::remove_all(entry.path());
+                }
+            }
+        }
+        for (const auto& id : staged) {
+            fs::path target = target_for(id);
+            fs::create_directories(target.parent_path());
+            fs::rename(staging / id, target);
+            ++moved;
+        }
+        fs::remove(staging);
+    }
+    ::sync();
+    return moved;
 }
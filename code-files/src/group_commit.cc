@@ -0,0 +1,69 @@
+#include "group_commit.h"
+#include "logger.h"
+#include <fcntl.h>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <unistd.h>
+
+GroupCommit::GroupCommit(std::function<bool()> flush, std::chrono::microseconds window)
+    : flush_(std::move(flush)), window_(window) {}
+
+bool GroupCommit::sync() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint64_t ticket = ++requested_;
+    ++stats_.requests;
+
+    while (flushed_ < ticket) {
+        if (flushing_) {
+            flushed_cv_.wait(lock);
+            continue;
+        }
+
+        // Become the leader: give concurrent writers a chance to join this batch
+        flushing_ = true;
+        if (window_.count() > 0) {
+            lock.unlock();
+            std::this_thread::sleep_for(window_);
+            lock.lock();
+        }
+        uint64_t batch = requested_;
+        lock.unlock();
+        bool ok = flush_();
+        lock.lock();
+
+        if (!ok && !failed_) {
+            LOG_ERROR << "Group commit flush failed; durable writes will fail until restart";
+        }
+        failed_ = failed_ || !ok;
+        flushed_ = batch;
+        flushing_ = false;
+        ++stats_.flushes;
+        flushed_cv_.notify_all();
+    }
+    return !failed_;
+}
+
+GroupCommit::Stats GroupCommit::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::shared_ptr<GroupCommit> GroupCommit::for_directory(const std::string& path, std::chrono::microseconds window) {
+    static std::mutex registry_mutex;
+    static std::unordered_map<std::string, std::shared_ptr<GroupCommit>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto& commit = registry[path];
+    if (!commit) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            registry.erase(path);
+            throw std::runtime_error("Cannot open directory for group commit: " + path);
+        }
+        // syncfs flushes the whole filesystem, which covers new files, renames and unlinks alike.
+        // The descriptor lives as long as the process-wide group commit.
+        commit = std::make_shared<GroupCommit>([fd]() { return ::syncfs(fd) == 0; }, window);
+    }
+    return commit;
+}
@@ -0,0 +1,113 @@
+#include "html_template.h"
+#include <stdexcept>
+
+namespace {
+
+// Character reference for a byte that can't appear as-is, or nullptr
+const char* reference_for(char c) {
+    switch (c) {
+        case '&': return "&amp;";
+        case '<': return "&lt;";
+        case '>': return "&gt;";
+        case '"': return "&quot;";
+        case '\'': return "&#39;";
+        default: return nullptr;
+    }
+}
+
+constexpr std::string_view kSpecial = "&<>\"'";
+
+} // namespace
+
+HtmlTemplate::HtmlTemplate(std::string_view source, std::initializer_list<std::string_view> params)
+    : param_count_(params.size()) {
+    size_t pos = 0;
+    while (true) {
+        size_t open = source.find("{{", pos);
+        size_t chunk_end = open == std::string_view::npos ? source.size() : open;
+        Segment segment{text_.size(), chunk_end - pos, -1};
+        text_.append(source.substr(pos, chunk_end - pos));
+        if (open == std::string_view::npos) {
+            segments_.push_back(segment);
+            break;
+        }
+        size_t close = source.find("}}", open + 2);
+        if (close == std::string_view::npos) {
+            throw std::invalid_argument("Unterminated template slot at offset " + std::to_string(open));
+        }
+        std::string_view name = source.substr(open + 2, close - open - 2);
+        int index = 0;
+        for (std::string_view param : params) {
+            if (param == name) {
+                segment.slot = index;
+                break;
+            }
+            ++index;
+        }
+        if (segment.slot < 0) {
+            throw std::invalid_argument("Unknown template slot: " + std::string(name));
+        }
+        segments_.push_back(segment);
+        pos = close + 2;
+    }
+}
+
+size_t HtmlTemplate::escaped_size(std::string_view text) {
+    size_t size = text.size();
+    for (char c : text) {
+        if (const char* reference = reference_for(c)) {
+            size += std::char_traits<char>::length(reference) - 1;
+        }
+    }
+    return size;
+}
+
+void HtmlTemplate::append_escaped(std::string& out, std::string_view text) {
+    // Copy runs of plain text whole; most values have nothing to escape
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t special = text.find_first_of(kSpecial, pos);
+        if (special == std::string_view::npos) {
+            out.append(text.substr(pos));
+            return;
+        }
+        out.append(text.substr(pos, special - pos));
+        out.append(reference_for(text[special]));
+        pos = special + 1;
+    }
+}
+
+void HtmlTemplate::check_args(Args args) const {
+    if (args.size() != param_count_) {
+        throw std::invalid_argument("Template takes " + std::to_string(param_count_) + " values, got " +
+                                    std::to_string(args.size()));
+    }
+}
+
+size_t HtmlTemplate::size(Args args) const {
+    check_args(args);
+    size_t size = text_.size();
+    for (const Segment& segment : segments_) {
+        if (segment.slot >= 0) {
+            size += escaped_size(args.begin()[segment.slot]);
+        }
+    }
+    return size;
+}
+
+void HtmlTemplate::render_to(std::string& out, Args args) const {
+    check_args(args);
+    for (const Segment& segment : segments_) {
+        out.append(text_, segment.offset, segment.length);
+        if (segment.slot >= 0) {
+            append_escaped(out, args.begin()[segment.slot]);
+        }
+    }
+}
+
+std::string HtmlTemplate::render(Args args) const {
+    std::string out;
+    out.reserve(size(args));
+    render_to(out, args);
+    return out;
+}
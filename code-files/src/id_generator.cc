@@ -0,0 +1,88 @@
+#include "id_generator.h"
+#include <boost/uuid/random_generator.hpp>
+#include <boost/uuid/uuid_io.hpp>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+// A generator seeded with 256 bits from the OS; a single random_device value would
+// leave only 2^32 possible sequences per thread
+std::mt19937_64 seeded_rng() {
+    std::random_device device;
+    std::array<std::uint32_t, 8> words;
+    for (auto& word : words) {
+        word = device();
+    }
+    std::seed_seq seed(words.begin(), words.end());
+    return std::mt19937_64(seed);
+}
+
+// Per-thread ULID state: the last id's timestamp and random part
+struct UlidState {
+    std::mt19937_64 rng = seeded_rng();
+    uint64_t last_millis = 0;
+    uint16_t random_hi = 0;
+    uint64_t random_lo = 0;
+};
+
+} // namespace
+
+IdGenerator::Scheme IdGenerator::parse_scheme(const std::string& value) {
+    if (value == "uuid") {
+        return Scheme::kUuid;
+    }
+    if (value == "ulid") {
+        return Scheme::kUlid;
+    }
+    throw std::invalid_argument("unknown id scheme: " + value);
+}
+
+std::string IdGenerator::next(Scheme scheme) {
+    return scheme == Scheme::kUlid ? ulid() : uuid();
+}
+
+std::string IdGenerator::uuid() {
+    // boost's default generator reads the OS entropy source for every UUID; this one
+    // is seeded from it once per thread
+    thread_local boost::uuids::random_generator_mt19937 generator;
+    return boost::uuids::to_string(generator());
+}
+
+std::string IdGenerator::ulid() {
+    thread_local UlidState state;
+    // system_clock is read through the vDSO, so this isn't a syscall either
+    uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    if (now > state.last_millis) {
+        state.last_millis = now;
+        uint64_t draw = state.rng();
+        state.random_hi = static_cast<uint16_t>(draw);
+        state.random_lo = state.rng();
+    } else {
+        // Same millisecond (or the clock stepped back): keep the timestamp and count up
+        if (++state.random_lo == 0 && ++state.random_hi == 0) {
+            // 80 bits exhausted within one millisecond; borrow the next one
+            ++state.last_millis;
+        }
+    }
+    return encode_ulid(state.last_millis, state.random_hi, state.random_lo);
+}
+
+std::string IdGenerator::encode_ulid(uint64_t millis, uint16_t random_hi, uint64_t random_lo) {
+    static constexpr char kAlphabet[] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+    // 128 bits: 48-bit timestamp, 80 random bits; 26 base32 digits cover 130 bits,
+    // so the first digit only carries the top 3 bits
+    uint64_t hi = ((millis & 0xFFFFFFFFFFFFULL) << 16) | random_hi;
+    uint64_t lo = random_lo;
+    std::string out(26, '0');
+    for (int i = 25; i >= 0; --i) {
+        out[i] = kAlphabet[lo & 0x1F];
+        lo = (lo >> 5) | (hi << 59);
+        hi >>= 5;
+    }
+    return out;
+}
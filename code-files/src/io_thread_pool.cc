@@ -0,0 +1,57 @@
+#include "io_thread_pool.h"
+#include "logger.h"
+#include <exception>
+
+IoThreadPool::IoThreadPool(size_t threads) {
+    if (threads == 0) {
+        threads = 1;
+    }
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back(&IoThreadPool::run, this);
+    }
+}
+
+IoThreadPool::~IoThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    ready_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void IoThreadPool::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(std::move(job));
+    }
+    ready_.notify_one();
+}
+
+void IoThreadPool::run() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+            if (jobs_.empty()) {
+                return;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+        try {
+            job();
+        } catch (const std::exception& e) {
+            LOG_ERROR << "I/O pool job failed: " << e.what();
+        }
+    }
+}
+
+IoThreadPool& IoThreadPool::shared() {
+    static IoThreadPool pool;
+    return pool;
+}
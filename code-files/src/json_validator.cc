@@ -0,0 +1,310 @@
+#include "json_validator.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// One pass over the document; pos_ always points at the next unread byte.
+class Scanner {
+public:
+    explicit Scanner(std::string_view text)
+        : p_(reinterpret_cast<const unsigned char*>(text.data())), end_(p_ + text.size()),
+          begin_(p_) {}
+
+    bool run();
+    size_t offset() const { return static_cast<size_t>(p_ - begin_); }
+
+private:
+    void skip_whitespace();
+    bool string();
+    bool utf8_sequence();
+    bool number();
+    bool literal(const char* word, size_t length);
+
+    // Bit per nesting level: 1 for an object, 0 for an array
+    bool push(bool object) {
+        if (depth_ == JsonValidator::kMaxDepth) {
+            return false;
+        }
+        uint64_t bit = uint64_t{1} << (depth_ % 64);
+        if (object) {
+            stack_[depth_ / 64] |= bit;
+        } else {
+            stack_[depth_ / 64] &= ~bit;
+        }
+        ++depth_;
+        return true;
+    }
+    bool in_object() const {
+        size_t top = depth_ - 1;
+        return (stack_[top / 64] >> (top % 64)) & 1;
+    }
+
+    const unsigned char* p_;
+    const unsigned char* const end_;
+    const unsigned char* const begin_;
+    size_t depth_ = 0;
+    uint64_t stack_[JsonValidator::kMaxDepth / 64] = {};
+};
+
+void Scanner::skip_whitespace() {
+#if defined(__SSE2__)
+    // Pretty-printed documents spend a lot of bytes on indentation
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i cr = _mm_set1_epi8('\r');
+    while (end_ - p_ >= 16 && (*p_ == ' ' || *p_ == '\n')) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_));
+        __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, newline)),
+                                  _mm_or_si128(_mm_cmpeq_epi8(chunk, tab), _mm_cmpeq_epi8(chunk, cr)));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(ws)) ^ 0xffffu;
+        if (mask != 0) {
+            p_ += __builtin_ctz(mask);
+            return;
+        }
+        p_ += 16;
+    }
+#endif
+    while (p_ < end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\t' || *p_ == '\r')) {
+        ++p_;
+    }
+}
+
+// Called with p_ just past the opening quote; leaves it just past the closing one.
+bool Scanner::string() {
+    while (true) {
+#if defined(__SSE2__)
+        // Skip 16 bytes at a time while none is a quote, backslash, control character or non-ASCII
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i space = _mm_set1_epi8(0x20);
+        while (end_ - p_ >= 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_));
+            // Signed compare: bytes >= 0x80 are negative, so "below space" also catches non-ASCII
+            __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                                           _mm_cmpgt_epi8(space, chunk));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+            if (mask != 0) {
+                p_ += __builtin_ctz(mask);
+                break;
+            }
+            p_ += 16;
+        }
+#endif
+        if (p_ >= end_) {
+            return false;
+        }
+        unsigned char c = *p_;
+        if (c == '"') {
+            ++p_;
+            return true;
+        }
+        if (c == '\\') {
+            if (end_ - p_ < 2) {
+                return false;
+            }
+            switch (p_[1]) {
+                case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                    p_ += 2;
+                    break;
+                case 'u':
+                    if (end_ - p_ < 6) {
+                        return false;
+                    }
+                    for (int i = 2; i < 6; ++i) {
+                        unsigned char h = p_[i];
+                        if (!((h >= '0' && h <= '9') || (h >= 'a' && h <= 'f') || (h >= 'A' && h <= 'F'))) {
+                            p_ += i;
+                            return false;
+                        }
+                    }
+                    p_ += 6;
+                    break;
+                default:
+                    ++p_;
+                    return false;
+            }
+        } else if (c < 0x20) {
+            return false;
+        } else if (c >= 0x80) {
+            if (!utf8_sequence()) {
+                return false;
+            }
+        } else {
+            ++p_;
+        }
+    }
+}
+
+// Validates one multi-byte UTF-8 sequence, rejecting overlongs, surrogates and values past U+10FFFF.
+bool Scanner::utf8_sequence() {
+    unsigned char c = *p_;
+    size_t length;
+    unsigned char min = 0x80, max = 0xbf; // allowed range of the first continuation byte
+    if (c >= 0xc2 && c <= 0xdf) {
+        length = 2;
+    } else if (c >= 0xe0 && c <= 0xef) {
+        length = 3;
+        if (c == 0xe0) min = 0xa0;
+        if (c == 0xed) max = 0x9f;
+    } else if (c >= 0xf0 && c <= 0xf4) {
+        length = 4;
+        if (c == 0xf0) min = 0x90;
+        if (c == 0xf4) max = 0x8f;
+    } else {
+        return false;
+    }
+    if (static_cast<size_t>(end_ - p_) < length || p_[1] < min || p_[1] > max) {
+        return false;
+    }
+    for (size_t i = 2; i < length; ++i) {
+        if ((p_[i] & 0xc0) != 0x80) {
+            return false;
+        }
+    }
+    p_ += length;
+    return true;
+}
+
+bool Scanner::number() {
+    auto digit = [this]() { return p_ < end_ && *p_ >= '0' && *p_ <= '9'; };
+    if (p_ < end_ && *p_ == '-') {
+        ++p_;
+    }
+    if (!digit()) {
+        return false;
+    }
+    if (*p_ == '0') {
+        ++p_;
+    } else {
+        while (digit()) ++p_;
+    }
+    if (p_ < end_ && *p_ == '.') {
+        ++p_;
+        if (!digit()) {
+            return false;
+        }
+        while (digit()) ++p_;
+    }
+    if (p_ < end_ && (*p_ == 'e' || *p_ == 'E')) {
+        ++p_;
+        if (p_ < end_ && (*p_ == '+' || *p_ == '-')) {
+            ++p_;
+        }
+        if (!digit()) {
+            return false;
+        }
+        while (digit()) ++p_;
+    }
+    return true;
+}
+
+bool Scanner::literal(const char* word, size_t length) {
+    if (static_cast<size_t>(end_ - p_) < length || std::memcmp(p_, word, length) != 0) {
+        return false;
+    }
+    p_ += length;
+    return true;
+}
+
+bool Scanner::run() {
+    // Alternates between reading a value and deciding what may follow it
+    while (true) {
+        skip_whitespace();
+        if (p_ >= end_) {
+            return false;
+        }
+        switch (*p_) {
+            case '{':
+                ++p_;
+                if (!push(true)) return false;
+                skip_whitespace();
+                if (p_ < end_ && *p_ == '}') {
+                    ++p_;
+                    --depth_;
+                    break;
+                }
+                // First member: key, colon, then loop back for the value
+                if (p_ >= end_ || *p_ != '"') return false;
+                ++p_;
+                if (!string()) return false;
+                skip_whitespace();
+                if (p_ >= end_ || *p_ != ':') return false;
+                ++p_;
+                continue;
+            case '[':
+                ++p_;
+                if (!push(false)) return false;
+                skip_whitespace();
+                if (p_ < end_ && *p_ == ']') {
+                    ++p_;
+                    --depth_;
+                    break;
+                }
+                continue;
+            case '"':
+                ++p_;
+                if (!string()) return false;
+                break;
+            case 't':
+                if (!literal("true", 4)) return false;
+                break;
+            case 'f':
+                if (!literal("false", 5)) return false;
+                break;
+            case 'n':
+                if (!literal("null", 4)) return false;
+                break;
+            default:
+                if (!number()) return false;
+                break;
+        }
+
+        // A value just ended: close containers, or move on to the next element
+        while (true) {
+            skip_whitespace();
+            if (depth_ == 0) {
+                return p_ == end_;
+            }
+            if (p_ >= end_) {
+                return false;
+            }
+            bool object = in_object();
+            if (*p_ == (object ? '}' : ']')) {
+                ++p_;
+                --depth_;
+                continue;
+            }
+            if (*p_ != ',') {
+                return false;
+            }
+            ++p_;
+            if (object) {
+                skip_whitespace();
+                if (p_ >= end_ || *p_ != '"') return false;
+                ++p_;
+                if (!string()) return false;
+                skip_whitespace();
+                if (p_ >= end_ || *p_ != ':') return false;
+                ++p_;
+            }
+            break;
+        }
+    }
+}
+
+} // namespace
+
+bool JsonValidator::validate(std::string_view text, size_t* error_offset) {
+    Scanner scanner(text);
+    bool ok = scanner.run();
+    if (!ok && error_offset) {
+        *error_offset = scanner.offset();
+    }
+    return ok;
+}
@@ -0,0 +1,524 @@
+#include "log_file_system.h"
+#include "logger.h"
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <mutex>
+#include <stdexcept>
+#include <unistd.h>
+#include <zlib.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Record layout (little endian):
+//   u32 crc32   over everything after this field
+//   u8  op      kPut or kDelete
+//   u32 name_len, u32 id_len, u32 data_len
+//   name, id, data
+constexpr size_t kHeaderSize = 4 + 1 + 4 + 4 + 4;
+constexpr uint32_t kMaxFieldSize = 1u << 30; // anything larger is treated as corruption
+
+void put_u32(unsigned char* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+uint32_t get_u32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// Serializes one record into out.
+void encode_record(uint8_t op, const std::string& name, const std::string& id, const std::string& data,
+                   std::string& out) {
+    out.resize(kHeaderSize + name.size() + id.size() + data.size());
+    unsigned char* p = reinterpret_cast<unsigned char*>(&out[0]);
+    p[4] = op;
+    put_u32(p + 5, static_cast<uint32_t>(name.size()));
+    put_u32(p + 9, static_cast<uint32_t>(id.size()));
+    put_u32(p + 13, static_cast<uint32_t>(data.size()));
+    size_t pos = kHeaderSize;
+    std::memcpy(p + pos, name.data(), name.size());
+    pos += name.size();
+    std::memcpy(p + pos, id.data(), id.size());
+    pos += id.size();
+    std::memcpy(p + pos, data.data(), data.size());
+    uLong crc = crc32(0L, p + 4, static_cast<uInt>(out.size() - 4));
+    put_u32(p, static_cast<uint32_t>(crc));
+}
+
+bool write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool pread_all(int fd, char* data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t n = ::pread(fd, data, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+// fsyncs a directory so a rename inside it survives a crash.
+void sync_directory(const std::string& path) {
+    int dir_fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd >= 0) {
+        ::fsync(dir_fd);
+        ::close(dir_fd);
+    }
+}
+
+} // namespace
+
+LogFileSystem::LogFileSystem(const std::string& data_path, uint64_t checkpoint_min_bytes, bool durable,
+                             std::chrono::microseconds commit_window, IdGenerator::Scheme id_scheme)
+    : data_path_(data_path), log_path_((fs::path(data_path) / "entities.log").string()),
+      checkpoint_min_bytes_(checkpoint_min_bytes), id_scheme_(id_scheme) {
+    fs::create_directories(data_path_);
+    fd_ = ::open(log_path_.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Cannot open entity log: " + log_path_);
+    }
+    replay();
+    if (durable) {
+        // Appends block while the log is being flushed, then all go out in the next flush
+        group_commit_ = std::make_unique<GroupCommit>([this]() {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            return ::fdatasync(fd_) == 0;
+        }, commit_window);
+    }
+}
+
+LogFileSystem::~LogFileSystem() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+void LogFileSystem::replay() {
+    off_t end = ::lseek(fd_, 0, SEEK_END);
+    uint64_t file_size = end < 0 ? 0 : static_cast<uint64_t>(end);
+    uint64_t offset = 0;
+    size_t records = 0;
+    unsigned char header[kHeaderSize];
+    std::string body;
+
+    while (offset + kHeaderSize <= file_size) {
+        if (!pread_all(fd_, reinterpret_cast<char*>(header), kHeaderSize, offset)) {
+            break;
+        }
+        uint8_t op = header[4];
+        uint32_t name_len = get_u32(header + 5);
+        uint32_t id_len = get_u32(header + 9);
+        uint32_t data_len = get_u32(header + 13);
+        if ((op != kPut && op != kDelete) || name_len > kMaxFieldSize || id_len > kMaxFieldSize ||
+            data_len > kMaxFieldSize) {
+            break;
+        }
+        uint64_t body_size = static_cast<uint64_t>(name_len) + id_len + data_len;
+        if (offset + kHeaderSize + body_size > file_size) {
+            break; // torn write at the tail
+        }
+        body.resize(body_size);
+        if (body_size > 0 && !pread_all(fd_, &body[0], body_size, offset + kHeaderSize)) {
+            break;
+        }
+        uLong crc = crc32(0L, header + 4, static_cast<uInt>(kHeaderSize - 4));
+        crc = crc32(crc, reinterpret_cast<const Bytef*>(body.data()), static_cast<uInt>(body.size()));
+        if (static_cast<uint32_t>(crc) != get_u32(header)) {
+            break;
+        }
+
+        std::string name = body.substr(0, name_len);
+        std::string id = body.substr(name_len, id_len);
+        uint32_t record_size = static_cast<uint32_t>(kHeaderSize + body_size);
+        EntityIndex& entities = index_[name];
+        auto existing = entities.find(id);
+        if (existing != entities.end()) {
+            live_bytes_ -= existing->second.record_size;
+            dead_bytes_ += existing->second.record_size;
+        }
+        if (op == kPut) {
+            Location location{offset + kHeaderSize + name_len + id_len, data_len, record_size};
+            entities[id] = location;
+            live_bytes_ += record_size;
+        } else {
+            if (existing != entities.end()) {
+                entities.erase(existing);
+            }
+            dead_bytes_ += record_size;
+        }
+        offset += record_size;
+        ++records;
+    }
+
+    if (offset < file_size) {
+        LOG_WARNING << "Entity log " << log_path_ << " has " << (file_size - offset)
+                    << " invalid bytes after offset " << offset << "; truncating";
+        if (::ftruncate(fd_, static_cast<off_t>(offset)) != 0) {
+            throw std::runtime_error("Cannot truncate corrupt entity log: " + log_path_);
+        }
+    }
+    log_size_ = offset;
+    LOG_INFO << "Replayed " << records << " records from " << log_path_;
+}
+
+bool LogFileSystem::append(Op op, const std::string& name, const std::string& id, const std::string& data,
+                           Location& location) {
+    std::string record;
+    encode_record(op, name, id, data, record);
+    if (!write_all(fd_, record.data(), record.size())) {
+        LOG_ERROR << "Failed to append to entity log " << log_path_ << ": " << std::strerror(errno);
+        // Drop whatever part of the record made it so the next append starts on a boundary
+        if (::ftruncate(fd_, static_cast<off_t>(log_size_)) != 0) {
+            LOG_ERROR << "Failed to trim entity log " << log_path_;
+        }
+        return false;
+    }
+    location.offset = log_size_ + kHeaderSize + name.size() + id.size();
+    location.length = static_cast<uint32_t>(data.size());
+    location.record_size = static_cast<uint32_t>(record.size());
+    log_size_ += record.size();
+    return true;
+}
+
+// Creates a new, empty entity under a generated UUID.
+std::pair<bool, std::string> LogFileSystem::create_entity(const std::string &name) {
+    std::string id = IdGenerator::next(id_scheme_);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    Location location;
+    if (!append(kPut, name, id, "", location)) {
+        return {false, "Failed to append to entity log"};
+    }
+    index_[name][id] = location;
+    live_bytes_ += location.record_size;
+    lock.unlock();
+    if (!commit()) {
+        return {false, "Entity could not be made durable"};
+    }
+    return {true, id};
+}
+
+std::pair<bool, std::string> LogFileSystem::read_entity(const std::string &name, const std::string &id) const {
+    // Read under the lock so a checkpoint can't swap the file out from under us
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return read_locked(name, id);
+}
+
+std::pair<bool, std::string> LogFileSystem::read_locked(const std::string &name, const std::string &id) const {
+    auto entities = index_.find(name);
+    if (entities == index_.end()) {
+        return {false, ""};
+    }
+    auto it = entities->second.find(id);
+    if (it == entities->second.end()) {
+        return {false, ""};
+    }
+    const Location& location = it->second;
+    std::string data(location.length, '\0');
+    if (location.length > 0 && !pread_all(fd_, &data[0], location.length, location.offset)) {
+        return {false, ""};
+    }
+    return {true, data};
+}
+
+// Overwrites an existing entity; like FileSystem, the entity must already exist.
+bool LogFileSystem::write_entity(const std::string &name, const std::string &id, const std::string &data) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto entities = index_.find(name);
+    if (entities == index_.end()) {
+        return false;
+    }
+    auto it = entities->second.find(id);
+    if (it == entities->second.end()) {
+        return false;
+    }
+    Location location;
+    if (!append(kPut, name, id, data, location)) {
+        return false;
+    }
+    live_bytes_ += location.record_size;
+    live_bytes_ -= it->second.record_size;
+    dead_bytes_ += it->second.record_size;
+    it->second = location;
+    maybe_checkpoint();
+    lock.unlock();
+    return commit();
+}
+
+// Creates or overwrites an entity; the index lock makes the check and append one step.
+bool LogFileSystem::put_entity(const std::string &name, const std::string &id, const std::string &data, bool &created) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!put_locked(name, id, data, created)) {
+        return false;
+    }
+    maybe_checkpoint();
+    lock.unlock();
+    return commit();
+}
+
+bool LogFileSystem::update_entity(const std::string &name, const std::string &id,
+                                  const std::function<bool(std::string &data)> &mutate, bool &found) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto [exists, data] = read_locked(name, id);
+    found = exists;
+    bool created = false;
+    if (!exists || !mutate(data) || !put_locked(name, id, data, created)) {
+        return false;
+    }
+    maybe_checkpoint();
+    lock.unlock();
+    return commit();
+}
+
+bool LogFileSystem::put_locked(const std::string &name, const std::string &id, const std::string &data, bool &created) {
+    Location location;
+    if (!append(kPut, name, id, data, location)) {
+        return false;
+    }
+    EntityIndex& entities = index_[name];
+    auto it = entities.find(id);
+    created = it == entities.end();
+    live_bytes_ += location.record_size;
+    if (created) {
+        entities.emplace(id, location);
+    } else {
+        live_bytes_ -= it->second.record_size;
+        dead_bytes_ += it->second.record_size;
+        it->second = location;
+    }
+    return true;
+}
+
+bool LogFileSystem::delete_entity(const std::string &name, const std::string &id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!delete_locked(name, id)) {
+        return false;
+    }
+    maybe_checkpoint();
+    lock.unlock();
+    return commit();
+}
+
+bool LogFileSystem::delete_entity_if(const std::string &name, const std::string &id,
+                                     const std::function<bool(const std::string &data)> &precondition, bool &found) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto [exists, data] = read_locked(name, id);
+    found = exists;
+    if (!exists || !precondition(data) || !delete_locked(name, id)) {
+        return false;
+    }
+    maybe_checkpoint();
+    lock.unlock();
+    return commit();
+}
+
+bool LogFileSystem::delete_locked(const std::string &name, const std::string &id) {
+    auto entities = index_.find(name);
+    if (entities == index_.end()) {
+        return false;
+    }
+    auto it = entities->second.find(id);
+    if (it == entities->second.end()) {
+        return false;
+    }
+    Location tombstone;
+    if (!append(kDelete, name, id, "", tombstone)) {
+        return false;
+    }
+    live_bytes_ -= it->second.record_size;
+    dead_bytes_ += it->second.record_size + tombstone.record_size;
+    entities->second.erase(it);
+    return true;
+}
+
+// The whole batch is appended under one lock and made durable by one group commit
+bool LogFileSystem::apply_batch(std::vector<BatchOp>& ops) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    for (auto& op : ops) {
+        switch (op.type) {
+            case BatchOp::kCreate:
+                op.id = IdGenerator::next(id_scheme_);
+                op.ok = put_locked(op.name, op.id, op.data, op.created);
+                break;
+            case BatchOp::kGet: {
+                auto [found, data] = read_locked(op.name, op.id);
+                op.ok = found;
+                op.data = std::move(data);
+                break;
+            }
+            case BatchOp::kPut:
+                op.ok = put_locked(op.name, op.id, op.data, op.created);
+                break;
+            case BatchOp::kDelete:
+                op.ok = delete_locked(op.name, op.id);
+                break;
+        }
+    }
+    maybe_checkpoint();
+    lock.unlock();
+    return commit();
+}
+
+std::pair<bool, std::vector<std::string>> LogFileSystem::list_entities(const std::string &name) const {
+    std::vector<std::string> ids;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto entities = index_.find(name);
+    if (entities == index_.end()) {
+        return {false, ids};
+    }
+    ids.reserve(entities->second.size());
+    for (const auto& entry : entities->second) {
+        ids.push_back(entry.first);
+    }
+    return {true, ids};
+}
+
+bool LogFileSystem::list_entities_page(const std::string &name, const std::string &after, size_t limit,
+                                       std::vector<std::string> &ids, bool &more) const {
+    ids.clear();
+    more = false;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto entities = index_.find(name);
+    if (entities == index_.end()) {
+        return false;
+    }
+    auto it = after.empty() ? entities->second.begin() : entities->second.upper_bound(after);
+    for (; it != entities->second.end() && ids.size() < limit; ++it) {
+        ids.push_back(it->first);
+    }
+    more = it != entities->second.end();
+    return true;
+}
+
+std::vector<std::string> LogFileSystem::list_entity_types() const {
+    std::vector<std::string> names;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    for (const auto& entry : index_) {
+        names.push_back(entry.first);
+    }
+    return names;
+}
+
+bool LogFileSystem::exists(const std::string& entity, const std::string& id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto entities = index_.find(entity);
+    return entities != index_.end() && entities->second.count(id) > 0;
+}
+
+const std::string& LogFileSystem::get_data_path() const {
+    return data_path_;
+}
+
+uint64_t LogFileSystem::log_size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return log_size_;
+}
+
+bool LogFileSystem::commit() {
+    return !group_commit_ || group_commit_->sync();
+}
+
+void LogFileSystem::maybe_checkpoint() {
+    if (dead_bytes_ >= checkpoint_min_bytes_ && dead_bytes_ > live_bytes_) {
+        checkpoint_locked();
+    }
+}
+
+bool LogFileSystem::checkpoint() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    return checkpoint_locked();
+}
+
+bool LogFileSystem::checkpoint_locked() {
+    std::string tmp_path = log_path_ + ".checkpoint";
+    int tmp_fd = ::open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (tmp_fd < 0) {
+        LOG_ERROR << "Cannot create checkpoint file " << tmp_path;
+        return false;
+    }
+
+    // Copy every live record into the new log, tracking where each one lands
+    std::unordered_map<std::string, EntityIndex> new_index;
+    uint64_t offset = 0;
+    std::string data;
+    std::string record;
+    bool ok = true;
+    for (const auto& [name, entities] : index_) {
+        EntityIndex& new_entities = new_index[name];
+        for (const auto& [id, location] : entities) {
+            data.resize(location.length);
+            if (location.length > 0 && !pread_all(fd_, &data[0], location.length, location.offset)) {
+                ok = false;
+                break;
+            }
+            encode_record(kPut, name, id, data, record);
+            if (!write_all(tmp_fd, record.data(), record.size())) {
+                ok = false;
+                break;
+            }
+            new_entities[id] = Location{offset + kHeaderSize + name.size() + id.size(), location.length,
+                                        static_cast<uint32_t>(record.size())};
+            offset += record.size();
+        }
+        if (!ok) {
+            break;
+        }
+    }
+
+    // The new log must be on disk before it replaces the old one
+    if (!ok || ::fsync(tmp_fd) != 0 || ::rename(tmp_path.c_str(), log_path_.c_str()) != 0) {
+        LOG_ERROR << "Checkpoint of " << log_path_ << " failed; keeping the current log";
+        ::close(tmp_fd);
+        ::unlink(tmp_path.c_str());
+        return false;
+    }
+    sync_directory(data_path_);
+
+    ::close(fd_);
+    fd_ = tmp_fd;
+    LOG_INFO << "Checkpointed " << log_path_ << ": " << log_size_ << " -> " << offset << " bytes";
+    index_ = std::move(new_index);
+    log_size_ = offset;
+    live_bytes_ = offset;
+    dead_bytes_ = 0;
+    return true;
+}
+
+std::shared_ptr<LogFileSystem> LogFileSystem::shared(const std::string& data_path, bool durable,
+                                                     std::chrono::microseconds commit_window,
+                                                     IdGenerator::Scheme id_scheme) {
+    static std::mutex registry_mutex;
+    static std::unordered_map<std::string, std::shared_ptr<LogFileSystem>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto& store = registry[data_path];
+    if (!store) {
+        store = std::make_shared<LogFileSystem>(data_path, kDefaultCheckpointMinBytes, durable, commit_window, id_scheme);
+    }
+    return store;
+}
@@ -0,0 +1,183 @@
+#include "memory_file_system.h"
+#include <mutex>
+
+namespace {
+
+std::string make_key(const std::string& name, const std::string& id) {
+    return name + "/" + id;
+}
+
+} // namespace
+
+MemoryFileSystem::MemoryFileSystem(const std::string& data_path, IdGenerator::Scheme id_scheme)
+    : data_path_(data_path), id_scheme_(id_scheme) {}
+
+MemoryFileSystem::Shard& MemoryFileSystem::shard_for(const std::string& key) const {
+    return shards_[std::hash<std::string>{}(key) % kShards];
+}
+
+void MemoryFileSystem::index_insert(const std::string& name, const std::string& id) {
+    std::unique_lock<std::shared_mutex> lock(types_mutex_);
+    types_[name].insert(id);
+}
+
+void MemoryFileSystem::index_erase(const std::string& name, const std::string& id) {
+    std::unique_lock<std::shared_mutex> lock(types_mutex_);
+    auto type = types_.find(name);
+    if (type != types_.end()) {
+        type->second.erase(id);
+    }
+}
+
+// Like the file backend, a created entity exists with an empty body until it's written
+std::pair<bool, std::string> MemoryFileSystem::create_entity(const std::string &name) {
+    std::string id = IdGenerator::next(id_scheme_);
+    std::string key = make_key(name, id);
+    Shard& shard = shard_for(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.bodies.emplace(std::move(key), "");
+    index_insert(name, id);
+    return {true, id};
+}
+
+std::pair<bool, std::string> MemoryFileSystem::read_entity(const std::string &name, const std::string &id) const {
+    std::string key = make_key(name, id);
+    const Shard& shard = shard_for(key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.bodies.find(key);
+    if (it == shard.bodies.end()) {
+        return {false, ""};
+    }
+    return {true, it->second};
+}
+
+bool MemoryFileSystem::write_entity(const std::string &name, const std::string &id, const std::string &data) {
+    std::string key = make_key(name, id);
+    Shard& shard = shard_for(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.bodies.find(key);
+    if (it == shard.bodies.end()) {
+        return false;
+    }
+    it->second = data;
+    return true;
+}
+
+bool MemoryFileSystem::delete_entity(const std::string &name, const std::string &id) {
+    std::string key = make_key(name, id);
+    Shard& shard = shard_for(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    if (shard.bodies.erase(key) == 0) {
+        return false;
+    }
+    index_erase(name, id);
+    return true;
+}
+
+std::pair<bool, std::vector<std::string>> MemoryFileSystem::list_entities(const std::string &name) const {
+    std::shared_lock<std::shared_mutex> lock(types_mutex_);
+    auto type = types_.find(name);
+    if (type == types_.end()) {
+        return {false, {}};
+    }
+    return {true, std::vector<std::string>(type->second.begin(), type->second.end())};
+}
+
+bool MemoryFileSystem::exists(const std::string& entity, const std::string& id) const {
+    std::string key = make_key(entity, id);
+    const Shard& shard = shard_for(key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.bodies.count(key) > 0;
+}
+
+bool MemoryFileSystem::put_entity(const std::string &name, const std::string &id, const std::string &data,
+                                  bool &created) {
+    std::string key = make_key(name, id);
+    Shard& shard = shard_for(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto [it, inserted] = shard.bodies.try_emplace(std::move(key));
+    it->second = data;
+    created = inserted;
+    if (created) {
+        index_insert(name, id);
+    }
+    return true;
+}
+
+bool MemoryFileSystem::update_entity(const std::string &name, const std::string &id,
+                                     const std::function<bool(std::string &data)> &mutate, bool &found) {
+    std::string key = make_key(name, id);
+    Shard& shard = shard_for(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.bodies.find(key);
+    found = it != shard.bodies.end();
+    if (!found) {
+        return false;
+    }
+    // Mutate a copy so a declined mutation leaves the body as it was
+    std::string data = it->second;
+    if (!mutate(data)) {
+        return false;
+    }
+    it->second = std::move(data);
+    return true;
+}
+
+bool MemoryFileSystem::delete_entity_if(const std::string &name, const std::string &id,
+                                        const std::function<bool(const std::string &data)> &precondition,
+                                        bool &found) {
+    std::string key = make_key(name, id);
+    Shard& shard = shard_for(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.bodies.find(key);
+    found = it != shard.bodies.end();
+    if (!found || !precondition(it->second)) {
+        return false;
+    }
+    shard.bodies.erase(it);
+    index_erase(name, id);
+    return true;
+}
+
+bool MemoryFileSystem::list_entities_page(const std::string &name, const std::string &after, size_t limit,
+                                          std::vector<std::string> &ids, bool &more) const {
+    ids.clear();
+    more = false;
+    std::shared_lock<std::shared_mutex> lock(types_mutex_);
+    auto type = types_.find(name);
+    if (type == types_.end()) {
+        return false;
+    }
+    auto it = after.empty() ? type->second.begin() : type->second.upper_bound(after);
+    for (; it != type->second.end() && ids.size() < limit; ++it) {
+        ids.push_back(*it);
+    }
+    more = it != type->second.end();
+    return true;
+}
+
+std::vector<std::string> MemoryFileSystem::list_entity_types() const {
+    std::shared_lock<std::shared_mutex> lock(types_mutex_);
+    std::vector<std::string> names;
+    for (const auto& [name, ids] : types_) {
+        names.push_back(name);
+    }
+    return names;
+}
+
+const std::string& MemoryFileSystem::get_data_path() const {
+    return data_path_;
+}
+
+std::shared_ptr<MemoryFileSystem> MemoryFileSystem::shared(const std::string& data_path,
+                                                           IdGenerator::Scheme id_scheme) {
+    static std::mutex registry_mutex;
+    static std::unordered_map<std::string, std::shared_ptr<MemoryFileSystem>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto& store = registry[data_path];
+    if (!store) {
+        store = std::make_shared<MemoryFileSystem>(data_path, id_scheme);
+    }
+    return store;
+}
@@ -0,0 +1,30 @@
+// Offline tool that moves a CrudHandler data directory between the flat and sharded
+// entity layouts. Stop the server first, run the tool, then change the location's
+// `layout` directive to match.
+//
+// Usage: ./bin/migrate_entities <data_path> <flat|sharded>
+
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include "file_system.h"
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: migrate_entities <data_path> <flat|sharded>\n";
+        return 1;
+    }
+    if (!std::filesystem::is_directory(argv[1])) {
+        std::cerr << "Not a directory: " << argv[1] << "\n";
+        return 1;
+    }
+    try {
+        FileSystem::Layout layout = FileSystem::parse_layout(argv[2]);
+        size_t moved = FileSystem::migrate(argv[1], layout);
+        std::cout << "Moved " << moved << " entities to the " << argv[2] << " layout\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Migration failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
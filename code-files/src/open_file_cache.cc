@@ -0,0 +1,135 @@
+#include "open_file_cache.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+OpenFile::~OpenFile() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+OpenFileCache::OpenFileCache(size_t max_entries, std::chrono::milliseconds valid_for)
+    : max_entries_(max_entries), valid_for_(valid_for) {}
+
+// Opens path read-only and records its stat results.
+// Returns nullptr if the path can't be opened or isn't a regular file.
+std::shared_ptr<const OpenFile> OpenFileCache::open_uncached(const std::string& path) {
+    uint64_t syscalls = 0;
+    std::shared_ptr<OpenFile> file;
+
+    // O_NONBLOCK so a FIFO under the root can't park the worker in open() waiting for a
+    // writer; it's rejected by the fstat below, and reads of regular files ignore the flag
+    ++syscalls;
+    int fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd >= 0) {
+        struct stat st;
+        ++syscalls;
+        if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            file = std::make_shared<OpenFile>();
+            file->fd = fd;
+            file->size = st.st_size;
+            file->mtime = st.st_mtime;
+            file->dev = st.st_dev;
+            file->ino = st.st_ino;
+        } else {
+            ++syscalls;
+            ::close(fd);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.syscalls += syscalls;
+    return file;
+}
+
+std::shared_ptr<const OpenFile> OpenFileCache::open(const std::string& path) {
+    if (max_entries_ == 0) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++stats_.misses;
+        }
+        return open_uncached(path);
+    }
+
+    Clock::time_point now = Clock::now();
+    std::shared_ptr<const OpenFile> stale;
+    bool have_stale = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(path);
+        if (it != entries_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second.lru_it);
+            if (now - it->second.validated < valid_for_) {
+                ++stats_.hits;
+                return it->second.file;
+            }
+            stale = it->second.file;
+            have_stale = true;
+        }
+        ++stats_.misses;
+    }
+
+    // Revalidate an expired entry with a single stat: if the path still names
+    // the same file (or is still missing), keep the cached result.
+    if (have_stale) {
+        struct stat st;
+        bool found = ::stat(path.c_str(), &st) == 0;
+        bool unchanged = stale ? (found && S_ISREG(st.st_mode) &&
+                                  st.st_dev == stale->dev && st.st_ino == stale->ino &&
+                                  st.st_size == stale->size && st.st_mtime == stale->mtime)
+                               : !found;
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.syscalls;
+        if (unchanged) {
+            auto it = entries_.find(path);
+            if (it != entries_.end()) {
+                it->second.validated = now;
+            }
+            return stale;
+        }
+    }
+
+    std::shared_ptr<const OpenFile> file = open_uncached(path);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(path);
+    if (it != entries_.end()) {
+        it->second.file = file;
+        it->second.validated = now;
+    } else {
+        lru_.push_front(path);
+        entries_.emplace(path, Entry{file, now, lru_.begin()});
+        evict_locked();
+    }
+    return file;
+}
+
+void OpenFileCache::evict_locked() {
+    while (entries_.size() > max_entries_) {
+        entries_.erase(lru_.back());
+        lru_.pop_back();
+    }
+}
+
+OpenFileCache::Stats OpenFileCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::shared_ptr<OpenFileCache> OpenFileCache::shared(const std::string& doc_root,
+                                                     size_t max_entries,
+                                                     std::chrono::milliseconds valid_for) {
+    static std::mutex registry_mutex;
+    static std::unordered_map<std::string, std::shared_ptr<OpenFileCache>> registry;
+
+    // Locations that share a root but configure the cache differently get separate caches
+    std::string key = doc_root + '\n' + std::to_string(max_entries) + '\n' + std::to_string(valid_for.count());
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto& cache = registry[key];
+    if (!cache) {
+        cache = std::make_shared<OpenFileCache>(max_entries, valid_for);
+    }
+    return cache;
+}
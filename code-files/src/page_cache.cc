@@ -0,0 +1,69 @@
+#include "page_cache.h"
+#include "file_system_interface.h"
+#include "res_req_helpers.h"
+#include <mutex>
+
+RenderedPage::RenderedPage(std::string html)
+    : body(std::move(html)), content_length(std::to_string(body.size())), etag(entity_etag(body)) {}
+
+std::shared_ptr<const RenderedPage> PageCache::get(const std::string& key, std::shared_ptr<const void> source,
+                                                   const std::function<std::string()>& render) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it != entries_.end() && it->second.source == source) {
+            return it->second.page;
+        }
+    }
+
+    // Two requests that miss together both render; either result is the same page
+    auto page = std::make_shared<const RenderedPage>(render());
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    entries_[key] = Entry{std::move(source), page};
+    return page;
+}
+
+std::shared_ptr<const RenderedPage> PageCache::find(const std::string& key,
+                                                    const std::shared_ptr<const void>& source) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end() || it->second.source != source) {
+        return nullptr;
+    }
+    return it->second.page;
+}
+
+size_t PageCache::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return entries_.size();
+}
+
+std::shared_ptr<PageCache> PageCache::shared(const std::string& name) {
+    static std::mutex registry_mutex;
+    static std::unordered_map<std::string, std::shared_ptr<PageCache>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto& cache = registry[name];
+    if (!cache) {
+        cache = std::make_shared<PageCache>();
+    }
+    return cache;
+}
+
+void serve_page(const request& req, const RenderedPage& page, response& res) {
+    res.http_version = "HTTP/1.1";
+    res.headers["ETag"] = page.etag;
+    // Form submissions render the same pages, but only reads can be answered with a 304
+    bool read = req.method == "GET" || req.method == "HEAD";
+    std::string if_none_match = get_header(req, "If-None-Match");
+    if (read && !if_none_match.empty() && etag_matches(if_none_match, page.etag, true)) {
+        res.status_code = 304;
+        res.reason_phrase = "Not Modified";
+        return;
+    }
+    res.status_code = 200;
+    res.reason_phrase = "OK";
+    res.headers["Content-Type"] = "text/html";
+    res.headers["Content-Length"] = page.content_length;
+    res.body = page.body;
+}
@@ -0,0 +1,182 @@
+#include "quiz_catalog.h"
+#include "logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace {
+
+int64_t to_ns(const struct timespec& t) {
+    return static_cast<int64_t>(t.tv_sec) * 1000000000 + t.tv_nsec;
+}
+
+} // namespace
+
+QuizCatalog::QuizCatalog(const std::string& quiz_root) : quiz_root_(quiz_root) {}
+
+Quiz QuizCatalog::parse(const std::string& text) {
+    Quiz quiz;
+    try {
+        json quiz_json = json::parse(text);
+        quiz.title = quiz_json.value("title", "");
+        if (quiz_json.contains("questions")) {
+            for (const auto& question_json : quiz_json.at("questions")) {
+                QuizQuestion question;
+                question.prompt = question_json.value("prompt", "");
+                question.image = question_json.value("image", "");
+                if (question_json.contains("options")) {
+                    for (const auto& option : question_json.at("options")) {
+                        question.options.push_back({option.value("text", ""), option.value("value", "")});
+                    }
+                }
+                quiz.questions.push_back(std::move(question));
+            }
+        }
+        if (quiz_json.contains("results")) {
+            for (const auto& [key, result] : quiz_json.at("results").items()) {
+                quiz.results[key] = {result.value("title", ""), result.value("description", ""),
+                                     result.value("image", "")};
+            }
+        }
+    } catch (const json::exception& e) {
+        throw std::runtime_error(std::string("Invalid quiz: ") + e.what());
+    }
+    return quiz;
+}
+
+QuizCatalog::Stamp QuizCatalog::stamp_of(const struct stat& st) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    Stamp stamp;
+    stamp.mtime = st.st_mtim;
+    stamp.size = st.st_size;
+    stamp.ino = st.st_ino;
+    stamp.racy = to_ns(now) - to_ns(st.st_mtim) < kRacyWindow.count();
+    return stamp;
+}
+
+bool QuizCatalog::Stamp::matches(const struct stat& st) const {
+    return !racy && to_ns(mtime) == to_ns(st.st_mtim) && size == st.st_size && ino == st.st_ino;
+}
+
+bool QuizCatalog::valid_id(const std::string& quiz_id) {
+    return !quiz_id.empty() && quiz_id[0] != '.' && quiz_id.find('/') == std::string::npos;
+}
+
+std::shared_ptr<const Quiz> QuizCatalog::find(const std::string& quiz_id) {
+    if (!valid_id(quiz_id)) {
+        return nullptr;
+    }
+    std::string path = quiz_root_ + "/" + quiz_id + ".json";
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return nullptr;
+    }
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = entries_.find(quiz_id);
+        if (it != entries_.end() && it->second.stamp.matches(st)) {
+            return it->second.quiz;
+        }
+    }
+
+    // Read outside the lock. The entry keeps the stat taken before the read, so a file
+    // that changes mid-read just fails the next check and is read again.
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Quiz file not found.");
+    }
+    std::ostringstream text;
+    text << file.rdbuf();
+    size_t digest = std::hash<std::string>{}(text.str());
+    Stamp stamp = stamp_of(st);
+    {
+        // A racy entry that reads back the same keeps its quiz
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto it = entries_.find(quiz_id);
+        if (it != entries_.end() && it->second.digest == digest) {
+            it->second.stamp = stamp;
+            return it->second.quiz;
+        }
+    }
+    auto quiz = std::make_shared<const Quiz>(parse(text.str()));
+    LOG_INFO << "Loaded quiz " << quiz_id << " into the catalog";
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    entries_[quiz_id] = Entry{quiz, stamp, digest};
+    return quiz;
+}
+
+std::shared_ptr<const std::vector<QuizListing>> QuizCatalog::list() {
+    struct stat st;
+    if (::stat(quiz_root_.c_str(), &st) != 0) {
+        throw std::filesystem::filesystem_error("Cannot read quiz directory", quiz_root_,
+                                                std::error_code(errno, std::generic_category()));
+    }
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        if (listing_ && listing_stamp_.matches(st)) {
+            return listing_;
+        }
+    }
+
+    // Images only matter next to a quiz, so one pass collects both
+    std::vector<QuizListing> quizzes;
+    std::unordered_map<std::string, bool> images;
+    for (const auto& entry : std::filesystem::directory_iterator(quiz_root_)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        std::string ext = entry.path().extension().string();
+        if (ext == ".json") {
+            quizzes.push_back({entry.path().stem().string(), false});
+        } else if (ext == ".jpg") {
+            images[entry.path().stem().string()] = true;
+        }
+    }
+    for (auto& quiz : quizzes) {
+        quiz.has_image = images.count(quiz.id) > 0;
+    }
+    std::sort(quizzes.begin(), quizzes.end(),
+              [](const QuizListing& a, const QuizListing& b) { return a.id < b.id; });
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    listing_stamp_ = stamp_of(st);
+    if (!listing_ || *listing_ != quizzes) {
+        listing_ = std::make_shared<const std::vector<QuizListing>>(std::move(quizzes));
+    }
+    return listing_;
+}
+
+void QuizCatalog::invalidate(const std::string& quiz_id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    entries_.erase(quiz_id);
+    listing_stamp_.racy = true;
+}
+
+std::shared_ptr<QuizCatalog> QuizCatalog::shared(const std::string& quiz_root) {
+    static std::mutex registry_mutex;
+    static std::unordered_map<std::string, std::shared_ptr<QuizCatalog>> registry;
+
+    // QuizHandler canonicalizes its root and CreateQuizHandler doesn't; key both the same way
+    std::error_code ec;
+    std::string root = std::filesystem::weakly_canonical(quiz_root, ec).string();
+    if (ec) {
+        root = quiz_root;
+    }
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto& catalog = registry[root];
+    if (!catalog) {
+        catalog = std::make_shared<QuizCatalog>(root);
+    }
+    return catalog;
+}
@@ -0,0 +1,236 @@
+#include "quiz_pages.h"
+#include "asset_manifest.h"
+#include "html_template.h"
+
+namespace {
+
+// ---- Shared page frame ----
+
+const char kHead[] =
+    R"html(<html><head><title>{{title}}</title>)html"
+    R"html(<link rel="stylesheet" type="text/css" href="{{stylesheet}}">)html";
+const char kBodyOpen[] = R"html(</head><body><div class='container'>)html";
+
+const HtmlTemplate kPageOpen(std::string(kHead) + kBodyOpen, {"title", "stylesheet"});
+const HtmlTemplate kHeadOpen(kHead, {"title", "stylesheet"});
+const HtmlTemplate kBodyStart(kBodyOpen, {});
+const HtmlTemplate kPageClose(R"html(</div></body></html>)html", {});
+
+const HtmlTemplate kImage(
+    R"html(<div style='text-align: center; margin-bottom: 15px;'><img src="{{src}}" )html"
+    R"html(style="max-width: 100%; width: 400px; height: auto; border-radius: 8px; box-shadow: 0 4px 8px rgba(0,0,0,0.1);" /></div>)html",
+    {"src"});
+
+// ---- Quiz listing ----
+
+const HtmlTemplate kListIntro(
+    R"html(<h1>BruinFeed Quizzes</h1>)html"
+    R"html(<div style='margin-bottom: 20px; text-align: left;'><a href="/quiz/create" class="create-quiz-button">Create Quiz</a></div>)html"
+    R"html(<p>Select a quiz below to get started:</p><ul>)html",
+    {});
+const HtmlTemplate kListItemOpen(R"html(<div style='margin-bottom: 30px; text-align: center;'>)html", {});
+const HtmlTemplate kListImage(
+    R"html(<img src="{{src}}" style="max-width: 100%; width: 500px; height: auto; border-radius: 12px; display: block; margin: 0 auto;" />)html",
+    {"src"});
+const HtmlTemplate kListItemLink(R"html(<a href="/quiz/{{id}}" class='quiz-title'>{{id}}</a></div>)html", {"id"});
+const HtmlTemplate kListClose(R"html(</ul>)html", {});
+
+// ---- Quiz form ----
+
+const HtmlTemplate kQuizIntro(R"html(<h1>{{title}}</h1><form action="/quiz/submit" method="POST">)html", {"title"});
+const HtmlTemplate kQuestionOpen(R"html(<p>{{prompt}}</p><div class='quiz-options'>)html", {"prompt"});
+const HtmlTemplate kOption(
+    R"html(<label class='quiz-option'><input type="radio" name="q{{index}}" value='{{value}}' />)html"
+    R"html(<span>{{text}}</span></label>)html",
+    {"index", "value", "text"});
+const HtmlTemplate kQuestionClose(R"html(</div>)html", {});
+const HtmlTemplate kQuizFormClose(
+    R"html(<input type="hidden" name="quiz_id" value="{{quiz_id}}"><input type="submit" value="Submit"></form>)html",
+    {"quiz_id"});
+
+// ---- Results ----
+
+const HtmlTemplate kResultIntro(R"html(<h1>{{title}}</h1><p>{{description}}</p>)html", {"title", "description"});
+const HtmlTemplate kResultShare(
+    R"html(<br><a href="/quiz">Take another quiz</a>)html"
+    R"html(<div class='share-section'><p>Want to share your result?</p>)html"
+    R"html(<input type="text" value="{{share_link}}" id="shareLink" readonly><br>)html"
+    R"html(<button onclick="navigator.clipboard.writeText(document.getElementById('shareLink').value)">Copy Link</button></div>)html",
+    {"share_link"});
+const HtmlTemplate kNoResult(
+    R"html(<h1>Oops! You didn't answer any questions.</h1><p>Want to give it another shot?</p>)html"
+    R"html(<a href="/quiz/{{quiz_id}}">Retake the Quiz</a><br><a href="/quiz">Take another quiz</a>)html",
+    {"quiz_id"});
+
+// ---- Quiz creation ----
+
+const HtmlTemplate kCreateScript(
+    "<script>"
+    "let questionCount = 1;"
+    "function addQuestion() {"
+    "  const container = document.getElementById('questions');"
+    "  const qIndex = questionCount++;"
+    "  const fieldset = document.createElement('fieldset');"
+    "  fieldset.innerHTML = `"
+    "<legend>Question ${qIndex + 1}</legend>"
+    "<label>Prompt: <input type='text' name='q${qIndex}_prompt' required></label><br>"
+    "Option 1: <input type='text' name='q${qIndex}_opt0_text' placeholder='Option Text' required> "
+    "<input type='text' name='q${qIndex}_opt0_val' placeholder='Result Value' required><br>"
+    "Option 2: <input type='text' name='q${qIndex}_opt1_text' placeholder='Option Text' required> "
+    "<input type='text' name='q${qIndex}_opt1_val' placeholder='Result Value' required><br>"
+    "Option 3: <input type='text' name='q${qIndex}_opt2_text' placeholder='Option Text' required> "
+    "<input type='text' name='q${qIndex}_opt2_val' placeholder='Result Value' required><br>"
+    "Option 4: <input type='text' name='q${qIndex}_opt3_text' placeholder='Option Text' required> "
+    "<input type='text' name='q${qIndex}_opt3_val' placeholder='Result Value' required><br>"
+    "`;"
+    "  container.appendChild(fieldset);"
+    "}"
+    "</script>",
+    {});
+const HtmlTemplate kCreateIntro(
+    R"html(<h1>Create Quiz</h1><p>Create your own UCLA inspired quiz below:</p>)html"
+    R"html(<form action="/quiz/create" method="POST">)html"
+    R"html(<label>Unique Quiz ID: <input type="text" name="quiz_id" required></label><br><br>)html"
+    R"html(<label>Quiz Title: <input type="text" name="title" required></label><br><br>)html"
+    R"html(<div id='questions'><fieldset><legend>Question 1</legend>)html"
+    R"html(<label>Prompt: <input type="text" name="q0_prompt" required></label><br>)html",
+    {});
+const HtmlTemplate kCreateOption(
+    R"html(Option {{number}}: <input type="text" name="q0_opt{{index}}_text" placeholder="Option Text" required> )html"
+    R"html(<input type="text" name="q0_opt{{index}}_val" placeholder="Result Value" required><br>)html",
+    {"number", "index"});
+const HtmlTemplate kCreateResultsIntro(
+    R"html(</fieldset></div><br>)html"
+    R"html(<button type="button" onclick="addQuestion()">Add Question</button><br><br>)html"
+    R"html(<h3>Define Result Categories</h3><div id='results'>)html"
+    R"html(<p>The results will be matched by value in the options above.</p>)html",
+    {});
+const HtmlTemplate kCreateResult(
+    R"html(<fieldset><legend>Result {{number}}</legend>)html"
+    R"html(<label>Result Value Key: <input type="text" name="result_{{index}}_key" required></label><br>)html"
+    R"html(<label>Title: <input type="text" name="result_{{index}}_title" required></label><br>)html"
+    R"html(<label>Description:<br><textarea name="result_{{index}}_desc" rows="4" cols="50" required></textarea></label><br>)html"
+    R"html(</fieldset><br>)html",
+    {"number", "index"});
+const HtmlTemplate kCreateClose(
+    R"html(</div><input type="submit" value="Create Quiz"></form>)html"
+    R"html(<br><a href="/quiz">Back to BruinFeed Quizzes homepage</a>)html",
+    {});
+const HtmlTemplate kQuizCreated(
+    R"html(<h1>Quiz Created Successfully</h1><p>Your quiz has been saved as <strong>{{quiz_id}}.json</strong>.</p>)html"
+    R"html(<a href="/quiz">Return to BruinFeed Quizzes Homepage</a>)html",
+    {"quiz_id"});
+
+const char kIndexDigits[][2] = {"0", "1", "2", "3", "4"};
+
+std::string stylesheet() {
+    return AssetManifest::url("/static/quizzes/styles.css");
+}
+
+std::string quiz_asset(const std::string& name) {
+    return AssetManifest::url("/static/quizzes/" + name);
+}
+
+} // namespace
+
+std::string render_quiz_list(const std::vector<QuizListing>& quizzes) {
+    std::string css = stylesheet();
+    std::vector<std::string> images;
+    for (const auto& quiz : quizzes) {
+        images.push_back(quiz.has_image ? quiz_asset(quiz.id + ".jpg") : "");
+    }
+    return HtmlTemplate::compose([&](auto&& emit) {
+        emit(kPageOpen, {"BruinFeed Quizzes", css});
+        emit(kListIntro, {});
+        for (size_t i = 0; i < quizzes.size(); ++i) {
+            emit(kListItemOpen, {});
+            if (quizzes[i].has_image) {
+                emit(kListImage, {images[i]});
+            }
+            emit(kListItemLink, {quizzes[i].id});
+        }
+        emit(kListClose, {});
+        emit(kPageClose, {});
+    });
+}
+
+std::string render_quiz_page(const std::string& quiz_id, const Quiz& quiz) {
+    // Values that take work to produce are worked out once, not on both compose passes
+    std::string css = stylesheet();
+    std::vector<std::string> images;
+    std::vector<std::string> indexes;
+    for (size_t q = 0; q < quiz.questions.size(); ++q) {
+        const auto& image = quiz.questions[q].image;
+        images.push_back(image.empty() ? "" : quiz_asset(image));
+        indexes.push_back(std::to_string(q));
+    }
+    return HtmlTemplate::compose([&](auto&& emit) {
+        emit(kPageOpen, {quiz.title, css});
+        emit(kQuizIntro, {quiz.title});
+        for (size_t q = 0; q < quiz.questions.size(); ++q) {
+            const auto& question = quiz.questions[q];
+            if (!question.image.empty()) {
+                emit(kImage, {images[q]});
+            }
+            emit(kQuestionOpen, {question.prompt});
+            for (const auto& option : question.options) {
+                emit(kOption, {indexes[q], option.value, option.text});
+            }
+            emit(kQuestionClose, {});
+        }
+        emit(kQuizFormClose, {quiz_id});
+        emit(kPageClose, {});
+    });
+}
+
+std::string render_result_page(const std::string& quiz_id, const std::string& result_key, const QuizResult& result) {
+    std::string css = stylesheet();
+    std::string image = result.image.empty() ? "" : quiz_asset(result.image);
+    std::string share_link = "/quiz/submit?quiz_id=" + quiz_id + "&result=" + result_key;
+    return HtmlTemplate::compose([&](auto&& emit) {
+        emit(kPageOpen, {result.title, css});
+        emit(kResultIntro, {result.title, result.description});
+        if (!image.empty()) {
+            emit(kImage, {image});
+        }
+        emit(kResultShare, {share_link});
+        emit(kPageClose, {});
+    });
+}
+
+std::string render_no_result_page(const std::string& quiz_id) {
+    std::string css = stylesheet();
+    return HtmlTemplate::compose([&](auto&& emit) {
+        emit(kPageOpen, {"BruinFeed Quizzes", css});
+        emit(kNoResult, {quiz_id});
+        emit(kPageClose, {});
+    });
+}
+
+std::string render_create_quiz_form() {
+    std::string css = stylesheet();
+    return HtmlTemplate::compose([&](auto&& emit) {
+        emit(kHeadOpen, {"BruinFeed Quizzes", css});
+        emit(kCreateScript, {});
+        emit(kBodyStart, {});
+        emit(kCreateIntro, {});
+        for (int j = 0; j < 4; ++j) {
+            emit(kCreateOption, {kIndexDigits[j + 1], kIndexDigits[j]});
+        }
+        emit(kCreateResultsIntro, {});
+        for (int i = 0; i < 4; ++i) {
+            emit(kCreateResult, {kIndexDigits[i + 1], kIndexDigits[i]});
+        }
+        emit(kCreateClose, {});
+        emit(kPageClose, {});
+    });
+}
+
+std::string render_quiz_created_page(const std::string& quiz_id) {
+    std::string css = stylesheet();
+    return HtmlTemplate::compose([&](auto&& emit) {
+        emit(kPageOpen, {"Quiz Created", css});
+        emit(kQuizCreated, {quiz_id});
+        emit(kPageClose, {});
+    });
+}
@@ -1,6 +1,48 @@
 #include "res_req_helpers.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
 #include <sstream>  
 
+namespace {
+
+// Lowercases a copy of the input for case-insensitive comparisons
+std::string to_lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return s;
+}
+
+// Trims leading and trailing spaces and tabs
+std::string trim(const std::string& s) {
+    size_t start = s.find_first_not_of(" \t");
+    if (start == std::string::npos) {
+        return "";
+    }
+    size_t end = s.find_last_not_of(" \t");
+    return s.substr(start, end - start + 1);
+}
+
+// Decodes %XX escapes, and '+' as space unless decoding a path, where it's literal
+std::string percent_decode(const std::string& s, bool plus_is_space = true) {
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '+' && plus_is_space) {
+            out += ' ';
+        } else if (s[i] == '%' && i + 2 < s.size() && std::isxdigit(static_cast<unsigned char>(s[i + 1])) &&
+                   std::isxdigit(static_cast<unsigned char>(s[i + 2]))) {
+            out += static_cast<char>(std::strtol(s.substr(i + 1, 2).c_str(), nullptr, 16));
+            i += 2;
+        } else {
+            out += s[i];
+        }
+    }
+    return out;
+}
+
+} // namespace
+
 // HTTP request parser 
 request parse_request(const std::string& raw_request)
 {
@@ -17,6 +59,10 @@ request parse_request(const std::string& raw_request)
     // Split header and body parts
     std::string header_part = raw_request.substr(0, header_end);
     req.body = raw_request.substr(header_end + 4);  // skip over \r\n\r\n
+    size_t declared = content_length(raw_request, header_end);
+    if (declared > 0 && req.body.size() > declared) {
+        req.body.resize(declared);  // ignore anything sent after the body
+    }
 
     std::istringstream header_stream(header_part);
     std::string line;
@@ -70,6 +116,33 @@ request parse_request(const std::string& raw_request)
     return req;
 }
 
+// Content-Length lookup on the raw header block, so the session can tell whether the body has arrived
+size_t content_length(const std::string& raw_request, size_t header_end)
+{
+    std::istringstream header_stream(raw_request.substr(0, header_end));
+    std::string line;
+    std::getline(header_stream, line); // request line
+    while (std::getline(header_stream, line)) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos || to_lower(trim(line.substr(0, colon))) != "content-length") {
+            continue;
+        }
+        std::string value = trim(line.substr(colon + 1));
+        if (!value.empty() && value.back() == '\r') {
+            value.pop_back();
+        }
+        if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos) {
+            return 0;
+        }
+        try {
+            return std::stoull(value);
+        } catch (const std::exception&) {
+            return 0;
+        }
+    }
+    return 0;
+}
+
 // HTTP response serializer 
 std::string serialize_response(const response& res)
 {
@@ -81,4 +154,114 @@ std::string serialize_response(const response& res)
     response_stream << "\r\n";
     response_stream << res.body;
     return response_stream.str();
-}
\ No newline at end of file
+}
+
+// Case-insensitive header lookup
+std::string get_header(const request& req, const std::string& name)
+{
+    auto exact = req.headers.find(name);
+    if (exact != req.headers.end()) {
+        return exact->second;
+    }
+    std::string wanted = to_lower(name);
+    for (const auto& header : req.headers) {
+        if (to_lower(header.first) == wanted) {
+            return header.second;
+        }
+    }
+    return "";
+}
+
+// Accept-Encoding check, e.g. "gzip, deflate;q=0.5, br;q=0"
+bool accepts_encoding(const request& req, const std::string& coding)
+{
+    // The whole list is read before deciding: an explicit entry for the coding wins over
+    // "*" wherever either appears, so "*;q=0, gzip" accepts gzip and "gzip;q=0, *" doesn't
+    std::istringstream list(to_lower(get_header(req, "Accept-Encoding")));
+    std::string wanted = to_lower(coding);
+    std::string item;
+    int explicit_accepted = -1; // -1 = not listed, else 0/1
+    int star_accepted = -1;
+    while (std::getline(list, item, ',')) {
+        std::istringstream parts(item);
+        std::string name;
+        std::getline(parts, name, ';');
+        name = trim(name);
+        if (name != wanted && name != "*") {
+            continue;
+        }
+        double quality = 1.0;
+        std::string param;
+        while (std::getline(parts, param, ';')) {
+            param = trim(param);
+            if (param.rfind("q=", 0) == 0) {
+                quality = std::strtod(param.c_str() + 2, nullptr);
+            }
+        }
+        (name == wanted ? explicit_accepted : star_accepted) = quality > 0.0 ? 1 : 0;
+    }
+    if (explicit_accepted >= 0) {
+        return explicit_accepted == 1;
+    }
+    return star_accepted == 1;
+}
+
+// Entity tag list, e.g. "\"a1\", W/\"b2\"" or "*"
+bool etag_matches(const std::string& header, const std::string& etag, bool weak)
+{
+    size_t pos = 0;
+    while (pos < header.size()) {
+        pos = header.find_first_not_of(" \t,", pos);
+        if (pos == std::string::npos) {
+            break;
+        }
+        if (header[pos] == '*') {
+            return true;
+        }
+        bool is_weak = header.compare(pos, 2, "W/") == 0;
+        if (is_weak) {
+            pos += 2;
+        }
+        if (pos >= header.size() || header[pos] != '"') {
+            return false; // malformed list
+        }
+        // Tags are quoted and can't contain quotes, so commas inside them are safe
+        size_t end = header.find('"', pos + 1);
+        if (end == std::string::npos) {
+            return false;
+        }
+        if ((weak || !is_weak) && header.compare(pos, end - pos + 1, etag) == 0) {
+            return true;
+        }
+        pos = end + 1;
+    }
+    return false;
+}
+
+// Query string splitter, e.g. "/api/Shoes?limit=10&after=abc"
+std::string split_query(const std::string& uri, std::unordered_map<std::string, std::string>& params)
+{
+    size_t query_pos = uri.find('?');
+    if (query_pos == std::string::npos) {
+        return uri;
+    }
+    std::istringstream pairs(uri.substr(query_pos + 1));
+    std::string pair;
+    while (std::getline(pairs, pair, '&')) {
+        if (pair.empty()) {
+            continue;
+        }
+        size_t eq = pair.find('=');
+        if (eq == std::string::npos) {
+            params[percent_decode(pair)] = "";
+        } else {
+            params[percent_decode(pair.substr(0, eq))] = percent_decode(pair.substr(eq + 1));
+        }
+    }
+    return uri.substr(0, query_pos);
+}
+
+std::string decode_uri_path(const std::string& uri)
+{
+    return percent_decode(uri.substr(0, uri.find('?')), false);
+}
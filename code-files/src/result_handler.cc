@@ -2,20 +2,19 @@
 #include "response.h"
 #include "res_req_helpers.h"
 #include "logger.h"
+#include "quiz_catalog.h"
+#include "quiz_pages.h"
+#include "page_cache.h"
 
 #include <map>
-#include <fstream>
 #include <sstream>
 #include <filesystem>
 #include <algorithm>
 #include <random>
 
-#include <nlohmann/json.hpp>
-
-using json = nlohmann::json;
-std::string escape_html(const std::string& input);
-json load_quiz_json(const std::filesystem::path& path);
-std::string render_result_html(const json& result_data, const std::string& quiz_id, const std::string& result_key);
+std::shared_ptr<const Quiz> load_quiz(const std::string& quiz_root, const std::string& quiz_id);
+std::shared_ptr<const RenderedPage> result_page(const std::string& quiz_root, const std::string& quiz_id,
+                                                const std::shared_ptr<const Quiz>& quiz, const std::string& result_key);
 std::unique_ptr<response> make_error_response(int status, const std::string& message);
 
 ResultHandler::ResultHandler(const std::string& quiz_root) {
@@ -73,14 +72,17 @@ std::unique_ptr<response> ResultHandler::handle_post_result(const request& req)
 
     std::string quiz_id = params["quiz_id"];
 
-    std::filesystem::path quiz_path = std::filesystem::path(quiz_root_) / (quiz_id + ".json");
-
-    LOG_INFO << "quiz_path is: " << quiz_path;
+    LOG_INFO << "quiz_id is: " << quiz_id;
+    // Result pages are cached under share links built from the id, so aliases like ./dining
+    // would each render and keep every result again
+    if (!QuizCatalog::valid_id(quiz_id)) {
+        return make_error_response(404, "Quiz not found.");
+    }
 
-    // Load quiz file
-    json quiz_json;
+    // Look up the parsed quiz
+    std::shared_ptr<const Quiz> quiz;
     try {
-        quiz_json = load_quiz_json(quiz_path);
+        quiz = load_quiz(quiz_root_, quiz_id);
     } catch (...) {
         return make_error_response(500, "Could not read quiz file.");
     }
@@ -89,35 +91,20 @@ std::unique_ptr<response> ResultHandler::handle_post_result(const request& req)
     std::string result_key = calculate_result(params);
 
     if (result_key == "no-result") {
-        std::ostringstream body;
-
-        std::string quiz_link = "/quiz";
-        if (params.find("quiz_id") != params.end()) {
-            quiz_link += "/" + params.at("quiz_id");
-        }
-        body << "<html><head><link rel=\"stylesheet\" href=\"/static/quizzes/styles.css\"></head><body><div class='container'>";
-        body << "<h1>Oops! You didn't answer any questions.</h1>";
-        body << "<p>Want to give it another shot?</p>";
-        body << "<a href=\"" << quiz_link << "\">Retake the Quiz</a><br>";
-        body << "<a href=\"/quiz\">Take another quiz</a>";
-        body << "</div></body></html>";
-
         res->status_code = 200;
         res->reason_phrase = "OK";
-        res->body = body.str();
+        res->body = render_no_result_page(quiz_id);
         res->headers["Content-Type"] = "text/html";
         res->headers["Content-Length"] = std::to_string(res->body.size());
         return res;
     }
 
-    const auto& result_data = quiz_json["results"][result_key];
-
-    // Render result HTML
-    res->body = render_result_html(result_data, quiz_id, result_key);
-    res->status_code = 200;
-    res->reason_phrase = "OK";
-    res->headers["Content-Type"] = "text/html";
-    res->headers["Content-Length"] = std::to_string(res->body.size());
+    // Result pages are rendered once per quiz version; a submission just picks one
+    auto page = result_page(quiz_root_, quiz_id, quiz, result_key);
+    if (!page) {
+        return make_error_response(404, "Result not found in quiz.");
+    }
+    serve_page(req, *page, *res);
 
     return res;
 }
@@ -143,65 +130,64 @@ std::unique_ptr<response> ResultHandler::handle_get_shared_result(const request&
 
     std::string quiz_id = params["quiz_id"];
     std::string result_key = params["result"];
-    std::filesystem::path quiz_path = std::filesystem::path(quiz_root_) / (quiz_id + ".json");
+    if (!QuizCatalog::valid_id(quiz_id)) {
+        return make_error_response(404, "Quiz not found.");
+    }
 
-    json quiz_json;
+    std::shared_ptr<const Quiz> quiz;
     try {
-        quiz_json = load_quiz_json(quiz_path);
+        quiz = load_quiz(quiz_root_, quiz_id);
     } catch (...) {
         return make_error_response(500, "Could not read quiz file.");
 
     }
 
-    if (!quiz_json["results"].contains(result_key)) {
+    auto page = result_page(quiz_root_, quiz_id, quiz, result_key);
+    if (!page) {
         return make_error_response(404, "Result not found in quiz.");
 
     }
 
-    const auto& result_data = quiz_json["results"][result_key];
-
-    res->body = render_result_html(result_data, quiz_id, result_key);
-    res->status_code = 200;
-    res->reason_phrase = "OK";
-    res->headers["Content-Type"] = "text/html";
-    res->headers["Content-Length"] = std::to_string(res->body.size());
+    serve_page(req, *page, *res);
     return res;
 }
 
 // Helper functions
 
-// Helper to load and parse a quiz JSON file from disk
-json load_quiz_json(const std::filesystem::path& path) {
-    std::ifstream f(path);
-    if (!f.is_open()) throw std::runtime_error("Quiz file not found.");
-
-    json quiz_json;
-    f >> quiz_json;
-    return quiz_json;
+// Helper to get a parsed quiz from the shared catalog, which only re-reads files that changed
+std::shared_ptr<const Quiz> load_quiz(const std::string& quiz_root, const std::string& quiz_id) {
+    auto quiz = QuizCatalog::shared(quiz_root)->find(quiz_id);
+    if (!quiz) throw std::runtime_error("Quiz file not found.");
+    return quiz;
 }
 
-// Helper to generates HTML for displaying quiz results, including shareable link
-std::string render_result_html(const json& result_data, const std::string& quiz_id, const std::string& result_key) {
-    std::ostringstream body;
-    body << "<html><head><link rel=\"stylesheet\" href=\"/static/quizzes/styles.css\"></head><body><div class='container'>";
-    body << "<h1>" << escape_html(result_data["title"]) << "</h1>";
-    body << "<p>" << escape_html(result_data["description"]) << "</p>";
-    if (result_data.contains("image")) {
-                body << "<div style='text-align: center; margin-bottom: 15px;'>";
-                body << "<img src=\"/static/quizzes/" << escape_html(result_data["image"]) 
-                    << "\" style=\"max-width: 100%; width: 400px; height: auto; border-radius: 8px; box-shadow: 0 4px 8px rgba(0,0,0,0.1);\" />";
-                body << "</div>";
+// Helper to look up a rendered result page. The first lookup after the catalog loads a quiz
+// renders every one of its results, keyed by share link, so later submissions and share
+// links for that quiz are a single cache lookup.
+// quiz_id must already have passed QuizCatalog::valid_id, so a quiz has one set of pages.
+// Returns nullptr if the quiz has no such result.
+std::shared_ptr<const RenderedPage> result_page(const std::string& quiz_root, const std::string& quiz_id,
+                                                const std::shared_ptr<const Quiz>& quiz, const std::string& result_key) {
+    auto pages = PageCache::shared(quiz_root);
+    auto share_link = [&quiz_id](const std::string& key) {
+        return "/quiz/submit?quiz_id=" + quiz_id + "&result=" + key;
+    };
+    if (auto page = pages->find(share_link(result_key), quiz)) {
+        return page;
+    }
+    if (quiz->results.count(result_key) == 0) {
+        return nullptr;
+    }
+    std::shared_ptr<const RenderedPage> page;
+    for (const auto& [key, result] : quiz->results) {
+        auto rendered = pages->get(share_link(key), quiz, [&, &key = key, &result = result]() {
+            return render_result_page(quiz_id, key, result);
+        });
+        if (key == result_key) {
+            page = rendered;
+        }
     }
-    body << "<br><a href=\"/quiz\">Take another quiz</a>";
-    std::string share_link = "/quiz/submit?quiz_id=" + quiz_id + "&result=" + result_key;
-
-    body << "<div class='share-section'>";
-    body << "<p>Want to share your result?</p>";
-    body << "<input type=\"text\" value=\"" << share_link << "\" id=\"shareLink\" readonly>";
-    body << "<br>";
-    body << "<button onclick=\"navigator.clipboard.writeText(document.getElementById('shareLink').value)\">Copy Link</button>";
-    body << "</div></body></html>";
-    return body.str();
+    return page;
 }
 
 // Helper that constructs a standardized plain-text error response with the given HTTP status and message.
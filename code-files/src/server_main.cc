@@ -27,6 +27,8 @@
 #include "quiz_handler.h"
 #include "result_handler.h"
 #include "create_quiz_handler.h"
+#include "archive_file_handler.h"
+#include "asset_manifest.h"
 
 
 using boost::asio::ip::tcp;
@@ -69,6 +71,7 @@ int main(int argc, char* argv[])
 
     factory.register_factory("EchoHandler", &EchoHandler::create);
     factory.register_factory("StaticFileHandler", &StaticFileHandler::create);
+    factory.register_factory("ArchiveFileHandler", &ArchiveFileHandler::create);
     factory.register_factory("HealthHandler", HealthHandler::create);
     
 
@@ -97,6 +100,24 @@ int main(int argc, char* argv[])
       // Extract handler config structs 
       handler_configs = extract_handler_configs(&config);
 
+      // Map and index archives now so a bad archive fails startup instead of a request
+      for (const auto& handler_config : handler_configs) {
+        if (handler_config.handler == "ArchiveFileHandler") {
+          ZipArchive::shared(handler_config.args.at("archive"));
+        }
+        // Rebuild secondary field indexes from storage now rather than on the first request
+        if (handler_config.handler == "CrudHandler" && handler_config.args.count("index")) {
+          CrudHandler::create(handler_config.args);
+        }
+        // Hash static assets once so pages can link to their fingerprinted URLs
+        auto fingerprint = handler_config.args.find("fingerprint");
+        if (handler_config.handler == "StaticFileHandler" && fingerprint != handler_config.args.end() &&
+            fingerprint->second == "on") {
+          AssetManifest::install(std::make_shared<AssetManifest>(handler_config.args.at("mount_point"),
+                                                                 handler_config.args.at("doc_root")));
+        }
+      }
+
     } catch (const std::exception& e) {
       LOG_WARNING << "Config extraction error: " << e.what();
       return 1;
@@ -5,8 +5,11 @@
 #include "response.h"
 #include "res_req_helpers.h"
 #include "config_interpreter.h"
+#include <array>
 #include <iostream>
 #include <set>
+#include <sstream>
+#include <thread>
 
 
 session::session(boost::asio::io_service& io_service, TrieNode* trie_root, RequestHandlerFactory& factory)
@@ -38,8 +41,23 @@ void session::handle_read(const boost::system::error_code& error, size_t bytes_t
         LOG_DEBUG << "Read " << bytes_transferred << " bytes from client: " << client_ip_;
         request_buffer_.append(data_, bytes_transferred);
 
-        // Check for full HTTP request (basic, ends with \r\n\r\n)
-        if (request_buffer_.find("\r\n\r\n") != std::string::npos) {
+        // Check for full HTTP request: headers end with \r\n\r\n, then Content-Length bytes of body
+        size_t header_end = request_buffer_.find("\r\n\r\n");
+        size_t body_length = header_end == std::string::npos ? 0 : content_length(request_buffer_, header_end);
+        if (body_length > kMaxBodySize) {
+            LOG_WARNING << "Request body of " << body_length << " bytes from " << client_ip_ << " is too large";
+            response res;
+            res.http_version = "HTTP/1.1";
+            res.status_code = 413;
+            res.reason_phrase = "Payload Too Large";
+            res.headers["Content-Type"] = "text/plain";
+            res.body = "Payload Too Large";
+            res.headers["Content-Length"] = std::to_string(res.body.size());
+            request_buffer_.clear();
+            send_response(res, "", "");
+            return;
+        }
+        if (header_end != std::string::npos && request_buffer_.size() >= header_end + 4 + body_length) {
 
             LOG_DEBUG << "HTTP header received. Building response.";
 
@@ -59,9 +77,9 @@ void session::handle_read(const boost::system::error_code& error, size_t bytes_t
                 res.headers["Content-Length"] = std::to_string(res.body.size());
                 res.headers["Connection"] = "close";
 
-                auto out = serialize_response(res);
+                response_buffer_ = serialize_response(res);
                 boost::asio::async_write(socket_,
-                    boost::asio::buffer(out),
+                    boost::asio::buffer(response_buffer_),
                     boost::bind(&session::handle_write, this,
                                 boost::asio::placeholders::error));
                 return;
@@ -74,14 +92,12 @@ void session::handle_read(const boost::system::error_code& error, size_t bytes_t
             std::shared_ptr<RequestHandler> handler = nullptr;
             const ConfigStruct* handler_config = trie_root_->find(req.uri);
 
-            std::unique_ptr<response> res;
             std::string handler_name;
             if (handler_config != nullptr) {
                 try {
                     LOG_INFO << "Matched handler for URI prefix: " << handler_config->uri;
                     handler = factory_.create_handler(handler_config->handler, handler_config->args);
                     handler_name = handler_config->handler;
-                    res = handler->handle_request(req);
                 } catch (const std::exception& e) {
                     LOG_WARNING << "Failed to create handler - " << e.what();
                 }
@@ -90,24 +106,38 @@ void session::handle_read(const boost::system::error_code& error, size_t bytes_t
                 // Fallback to 404 NotFoundHandler
                 handler = factory_.create_handler("NotFoundHandler", {});
                 handler_name = "NotFoundHandler";
-                res = handler->handle_request(req);
             }
-
-            // Generate response 
             request_buffer_.clear();
-            res->headers["Connection"] = "close";
-            std::string out = serialize_response(*res);
 
-            boost::asio::async_write(socket_,
-                boost::asio::buffer(out),
-                boost::bind(&session::handle_write, this,
-                boost::asio::placeholders::error));
-            
-            // Log ResponseMetric
-                LOG_INFO << "[ResponseMetrics] code=" << res->status_code
-                << " path=" << req.uri
-                << " ip=" << client_ip_
-                << " handler=" << handler_name;
+            if (!handler) {
+                response res;
+                res.http_version = "HTTP/1.1";
+                res.status_code = 500;
+                res.reason_phrase = "Internal Server Error";
+                res.body = "500 Internal Server Error";
+                res.headers["Content-Length"] = std::to_string(res.body.size());
+                send_response(res, req.uri, handler_name);
+                return;
+            }
+
+            // The handler may finish on an I/O pool thread; the write always happens on the io_service.
+            // Capturing the handler keeps it alive until its response is done.
+            std::thread::id io_thread = std::this_thread::get_id();
+            pending_handler_ = handler;
+            handler->handle_request_async(req,
+                [this, handler, io_thread, uri = req.uri, handler_name](std::unique_ptr<response> res) {
+                    if (std::this_thread::get_id() == io_thread) {
+                        send_response(*res, uri, handler_name);
+                        return;
+                    }
+                    std::shared_ptr<response> pending(std::move(res));
+                    boost::asio::post(socket_.get_executor(), [this, pending, uri, handler_name]() {
+                        send_response(*pending, uri, handler_name);
+                    });
+                });
+            if (pending_handler_) {
+                watch_for_close();
+            }
         }
         else {
             LOG_DEBUG << "HTTP request not complete, awaiting more data.";
@@ -128,6 +158,158 @@ void session::handle_read(const boost::system::error_code& error, size_t bytes_t
     }
 }
 
+void session::send_response(response& res, const std::string& uri, const std::string& handler_name)
+{
+    // Log ResponseMetric before the write can complete and close the session
+    LOG_INFO << "[ResponseMetrics] code=" << res.status_code
+        << " path=" << uri
+        << " ip=" << client_ip_
+        << " handler=" << handler_name;
+
+    pending_handler_.reset();
+    if (watching_) {
+        // Nothing else is outstanding on the socket yet, so this only ends the wait
+        boost::system::error_code ignored;
+        socket_.cancel(ignored);
+    }
+
+    res.headers["Connection"] = "close";
+    if (res.async_body_stream) {
+        res.headers["Transfer-Encoding"] = "chunked";
+        res.headers.erase("Content-Length");
+        async_body_stream_ = std::move(res.async_body_stream);
+        res.body.clear();
+        response_buffer_ = serialize_response(res);
+        boost::asio::async_write(socket_, boost::asio::buffer(response_buffer_),
+            boost::bind(&session::request_next_chunk, this,
+            boost::asio::placeholders::error));
+        return;
+    }
+    if (res.body_stream) {
+        // Headers go out first; write_next_chunk then pulls the body a chunk at a time
+        res.headers["Transfer-Encoding"] = "chunked";
+        res.headers.erase("Content-Length");
+        body_stream_ = std::move(res.body_stream);
+        res.body.clear();
+        response_buffer_ = serialize_response(res);
+        boost::asio::async_write(socket_, boost::asio::buffer(response_buffer_),
+            boost::bind(&session::write_next_chunk, this,
+            boost::asio::placeholders::error));
+        return;
+    }
+
+    // Generate response; the body is written straight from the response instead of being
+    // copied in behind the headers, which matters for large files
+    response_body_ = std::move(res.body);
+    res.body.clear();
+    response_buffer_ = serialize_response(res);
+
+    std::array<boost::asio::const_buffer, 2> buffers = {
+        boost::asio::buffer(response_buffer_), boost::asio::buffer(response_body_)};
+    boost::asio::async_write(socket_, buffers,
+        boost::bind(&session::handle_write, this,
+        boost::asio::placeholders::error));
+}
+
+void session::write_next_chunk(const boost::system::error_code& error)
+{
+    if (error || !body_stream_) {
+        handle_write(error);
+        return;
+    }
+
+    std::string chunk;
+    bool more = false;
+    try {
+        // Skip empty chunks; a zero-length chunk would end the body early
+        while ((more = body_stream_(chunk)) && chunk.empty()) {}
+    } catch (const std::exception& e) {
+        // Headers are already sent, so all we can do is cut the response short
+        LOG_ERROR << "Streamed response failed for client " << client_ip_ << ": " << e.what();
+        handle_write(boost::asio::error::operation_aborted);
+        return;
+    }
+
+    if (!more) {
+        body_stream_ = nullptr;
+    }
+    write_chunk(more, chunk, &session::write_next_chunk);
+}
+
+void session::request_next_chunk(const boost::system::error_code& error)
+{
+    if (error || !async_body_stream_) {
+        handle_write(error);
+        return;
+    }
+
+    // The producer may answer from any thread, possibly long after this returns;
+    // the write always happens on the io_service, which the work guard keeps running meanwhile
+    auto work = std::make_shared<boost::asio::executor_work_guard<tcp::socket::executor_type>>(
+        socket_.get_executor());
+    auto next = [this, work](bool more, std::string chunk) {
+        boost::asio::post(socket_.get_executor(), [this, work, more, chunk = std::move(chunk)]() {
+            if (more && chunk.empty()) {
+                // A zero-length chunk would end the body early
+                request_next_chunk(boost::system::error_code());
+                return;
+            }
+            if (!more) {
+                async_body_stream_ = nullptr;
+            }
+            write_chunk(more, chunk, &session::request_next_chunk);
+        });
+    };
+    try {
+        async_body_stream_(next);
+    } catch (const std::exception& e) {
+        LOG_ERROR << "Streamed response failed for client " << client_ip_ << ": " << e.what();
+        handle_write(boost::asio::error::operation_aborted);
+    }
+}
+
+void session::write_chunk(bool more, const std::string& chunk,
+                          void (session::*then)(const boost::system::error_code&))
+{
+    std::ostringstream framed;
+    if (more) {
+        framed << std::hex << chunk.size() << "\r\n" << chunk << "\r\n";
+    } else {
+        framed << "0\r\n\r\n";
+    }
+    response_body_ = framed.str();
+    boost::asio::async_write(socket_, boost::asio::buffer(response_body_),
+        boost::bind(more ? then : &session::handle_write, this,
+        boost::asio::placeholders::error));
+}
+
+void session::watch_for_close()
+{
+    watching_ = true;
+    socket_.async_wait(tcp::socket::wait_read,
+        boost::bind(&session::handle_client_wait, this,
+                    boost::asio::placeholders::error));
+}
+
+void session::handle_client_wait(const boost::system::error_code& error)
+{
+    watching_ = false;
+    if (error == boost::asio::error::operation_aborted || !pending_handler_) {
+        return;
+    }
+    // Readable with nothing to read means the client closed; bytes of a pipelined
+    // request are left alone, since the connection closes after this response anyway
+    char probe;
+    boost::system::error_code peek_error;
+    if (!error && socket_.receive(boost::asio::buffer(&probe, 1), tcp::socket::message_peek, peek_error) > 0) {
+        return;
+    }
+    LOG_INFO << "Client " << client_ip_ << " went away while its response was pending";
+    // Ending a parked wait may send the response from inside cancel(), which resets pending_handler_
+    std::shared_ptr<RequestHandler> handler = pending_handler_;
+    handler->cancel();
+}
+
 void session::handle_write(const boost::system::error_code& error)
 {
     if (socket_.is_open()) {
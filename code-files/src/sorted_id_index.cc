@@ -0,0 +1,72 @@
+#include "sorted_id_index.h"
+#include <mutex>
+
+namespace {
+
+void copy_page(const std::set<std::string>& ids, const std::string& after, size_t limit,
+               std::vector<std::string>& page, bool& more) {
+    page.clear();
+    auto it = after.empty() ? ids.begin() : ids.upper_bound(after);
+    for (; it != ids.end() && page.size() < limit; ++it) {
+        page.push_back(*it);
+    }
+    more = it != ids.end();
+}
+
+} // namespace
+
+bool SortedIdIndex::page(const std::string& name, const std::string& after, size_t limit,
+                         std::vector<std::string>& ids, bool& more, const Loader& load) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto type = types_.find(name);
+        if (type != types_.end()) {
+            copy_page(type->second, after, limit, ids, more);
+            return true;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto type = types_.find(name);
+    if (type == types_.end()) {
+        // Loading under the exclusive lock means no insert/erase can slip in between
+        // the storage scan and the type becoming visible
+        auto [found, all] = load();
+        if (!found) {
+            ids.clear();
+            more = false;
+            return false;
+        }
+        type = types_.emplace(name, std::set<std::string>(all.begin(), all.end())).first;
+    }
+    copy_page(type->second, after, limit, ids, more);
+    return true;
+}
+
+void SortedIdIndex::insert(const std::string& name, const std::string& id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto type = types_.find(name);
+    if (type != types_.end()) {
+        type->second.insert(id);
+    }
+}
+
+void SortedIdIndex::erase(const std::string& name, const std::string& id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto type = types_.find(name);
+    if (type != types_.end()) {
+        type->second.erase(id);
+    }
+}
+
+std::shared_ptr<SortedIdIndex> SortedIdIndex::shared(const std::string& data_path) {
+    static std::mutex registry_mutex;
+    static std::unordered_map<std::string, std::shared_ptr<SortedIdIndex>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto& index = registry[data_path];
+    if (!index) {
+        index = std::make_shared<SortedIdIndex>();
+    }
+    return index;
+}
@@ -1,7 +1,11 @@
 #include "static_file_handler.h"
+#include "asset_manifest.h"
+#include "io_thread_pool.h"
+#include <algorithm>
+#include <cerrno>
 #include <filesystem>
-#include <fstream>
-#include <sstream>
+#include <sys/uio.h>
+#include <unistd.h>
 #include "logger.h" 
 namespace fs = std::filesystem;
 
@@ -20,8 +24,11 @@ const std::unordered_map<std::string, std::string> StaticFileHandler::kMimeTypes
 };
 
 StaticFileHandler::StaticFileHandler(const std::string& mount_point,
-                                     const std::string& doc_root)
-    : mount_point_(mount_point), doc_root_(doc_root) {
+                                     const std::string& doc_root,
+                                     size_t open_file_cache_max,
+                                     std::chrono::milliseconds open_file_cache_valid,
+                                     bool aio)
+    : mount_point_(mount_point), doc_root_(doc_root), aio_(aio) {
     // Ensure mount_point_ ends with '/'
     if (!mount_point_.empty() && mount_point_.back() != '/') {
         mount_point_ += '/';
@@ -30,18 +37,135 @@ StaticFileHandler::StaticFileHandler(const std::string& mount_point,
     if (!doc_root_.empty() && doc_root_.back() == '/') {
         doc_root_.pop_back();
     }
+    open_file_cache_ = OpenFileCache::shared(doc_root_, open_file_cache_max, open_file_cache_valid);
 }
 
 std::unique_ptr<RequestHandler> StaticFileHandler::create(const std::unordered_map<std::string, std::string>& args) {
         auto it_mount = args.find("mount_point");
         auto it_root = args.find("doc_root");
         if (it_mount != args.end() && it_root != args.end()) {
-            return std::make_unique<StaticFileHandler>(it_mount->second, it_root->second);
+            size_t cache_max = kDefaultOpenFileCacheMax;
+            std::chrono::milliseconds cache_valid = kDefaultOpenFileCacheValid;
+            try {
+                auto it_max = args.find("open_file_cache");
+                if (it_max != args.end()) {
+                    cache_max = std::stoul(it_max->second);
+                }
+                auto it_valid = args.find("open_file_cache_valid");
+                if (it_valid != args.end()) {
+                    cache_valid = std::chrono::seconds(std::stoul(it_valid->second));
+                }
+            } catch (const std::exception& e) {
+                LOG_WARNING << "Invalid open_file_cache setting, using defaults: " << e.what();
+            }
+            auto it_aio = args.find("aio");
+            bool aio = it_aio == args.end() || it_aio->second != "off";
+            return std::make_unique<StaticFileHandler>(it_mount->second, it_root->second, cache_max, cache_valid, aio);
         }
         return nullptr;
 }
 
+std::string StaticFileHandler::mime_type(const std::string& extension) {
+    auto it = kMimeTypes.find(extension);
+    return it != kMimeTypes.end() ? it->second : "application/octet-stream";
+}
+
+bool StaticFileHandler::read_file(const OpenFile& file, std::string& out) {
+    size_t done = out.size();
+    out.resize(static_cast<size_t>(file.size));
+    while (done < out.size()) {
+        ssize_t n = ::pread(file.fd, &out[done], out.size() - done, static_cast<off_t>(done));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool StaticFileHandler::read_file_nowait(const OpenFile& file, std::string& out) {
+    size_t size = static_cast<size_t>(file.size);
+    out.clear();
+    // Sized to the probe first; a cold file fails here without allocating the whole file
+    size_t want = std::min(size, kNowaitProbeBytes);
+    size_t done = 0;
+    while (done < size) {
+        out.resize(want);
+        struct iovec iov = {&out[done], want - done};
+        ssize_t n = ::preadv2(file.fd, &iov, 1, static_cast<off_t>(done), RWF_NOWAIT);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        // EAGAIN: data isn't cached; EOPNOTSUPP: filesystem can't promise not to block
+        if (n <= 0) {
+            out.resize(done);
+            return false;
+        }
+        done += static_cast<size_t>(n);
+        if (done == want) {
+            want = size;
+        }
+    }
+    return true;
+}
+
 std::unique_ptr<response> StaticFileHandler::handle_request(const request& req) {
+    ResolvedFile resolved;
+    if (auto error = resolve(req, resolved)) {
+        return error;
+    }
+    std::string data;
+    bool read_ok = read_file(*resolved.file, data);
+    return file_response(req.http_version, resolved, read_ok, std::move(data));
+}
+
+void StaticFileHandler::handle_request_async(const request& req, Completion done) {
+    if (!aio_) {
+        done(handle_request(req));
+        return;
+    }
+    auto resolved = std::make_shared<ResolvedFile>();
+    if (auto error = resolve(req, *resolved)) {
+        done(std::move(error));
+        return;
+    }
+
+    // Hot files are copied straight out of the page cache on this thread
+    std::string data;
+    bool read_ok = false;
+    try {
+        read_ok = read_file_nowait(*resolved->file, data);
+    } catch (const std::exception& e) {
+        LOG_ERROR << "FAILED TO READ " << resolved->path << ": " << e.what();
+        data.clear();
+    }
+    if (read_ok) {
+        done(file_response(req.http_version, *resolved, true, std::move(data)));
+        return;
+    }
+
+    // The pool carries on after the prefix already read. Every failure, even a throw, still
+    // answers with a 500; the pool would only log it and leave the connection hanging.
+    LOG_DEBUG << "FILE NOT CACHED, READING ON I/O POOL " << resolved->path;
+    IoThreadPool::shared().submit([resolved, http_version = req.http_version, data = std::move(data),
+                                   done = std::move(done)]() mutable {
+        bool read_ok = false;
+        try {
+            read_ok = read_file(*resolved->file, data);
+        } catch (const std::exception& e) {
+            LOG_ERROR << "FAILED TO READ " << resolved->path << ": " << e.what();
+        }
+        if (!read_ok) {
+            data.clear();
+        }
+        done(file_response(http_version, *resolved, read_ok, std::move(data)));
+    });
+}
+
+std::unique_ptr<response> StaticFileHandler::resolve(const request& req, ResolvedFile& resolved) {
     auto resp = std::make_unique<response>();
 
     // Mirror HTTP version
@@ -68,6 +192,17 @@ std::unique_ptr<response> StaticFileHandler::handle_request(const request& req)
         return resp;
     }
 
+    // Fingerprinted names map back to the original file
+    std::shared_ptr<const AssetManifest> manifest = AssetManifest::for_mount(mount_point_);
+    std::string fingerprinted;
+    if (manifest) {
+        std::string original;
+        if (manifest->resolve(rel_path, original)) {
+            fingerprinted = rel_path;
+            rel_path = original;
+        }
+    }
+
     // Prevent directory traversal
     fs::path safe;
     for (auto& part : fs::path(rel_path)) {
@@ -81,8 +216,10 @@ std::unique_ptr<response> StaticFileHandler::handle_request(const request& req)
         safe /= part;
     }
 
+    // Resolve through the open file cache; missing files are cached as negative entries
     fs::path full = fs::path(doc_root_) / safe;
-    if (!fs::exists(full) || !fs::is_regular_file(full)) {
+    std::shared_ptr<const OpenFile> file = open_file_cache_->open(full.string());
+    if (!file) {
         LOG_DEBUG << "FILE DOESNT EXIST" << full;
         resp->status_code = 404;
         resp->reason_phrase = "Not Found";
@@ -90,22 +227,39 @@ std::unique_ptr<response> StaticFileHandler::handle_request(const request& req)
         return resp;
     }
 
-    // Read file
-    std::ifstream in(full, std::ios::binary);
-    std::ostringstream ss;
-    ss << in.rdbuf();
-    std::string data = ss.str();
+    // Only immutable while the file is still the one that was hashed into the name
+    if (!fingerprinted.empty()) {
+        resolved.immutable = manifest->is_current(fingerprinted, *file);
+    }
 
-    // Determine MIME
-    std::string ext = full.extension().string();
-    auto it = kMimeTypes.find(ext);
-    std::string mime = (it != kMimeTypes.end() ? it->second : "application/octet-stream");
+    resolved.file = std::move(file);
+    resolved.path = full.string();
+    resolved.mime = mime_type(full.extension().string());
+    return nullptr;
+}
+
+std::unique_ptr<response> StaticFileHandler::file_response(const std::string& http_version,
+                                                           const ResolvedFile& resolved,
+                                                           bool read_ok, std::string data) {
+    auto resp = std::make_unique<response>();
+    resp->http_version = http_version;
+
+    if (!read_ok) {
+        LOG_ERROR << "FAILED TO READ FILE " << resolved.path;
+        resp->status_code = 500;
+        resp->reason_phrase = "Internal Server Error";
+        resp->body = "500 Internal Server Error";
+        return resp;
+    }
 
     // Build response
     resp->status_code = 200;
     resp->reason_phrase = "OK";
-    resp->headers["Content-Type"] = mime;
+    resp->headers["Content-Type"] = resolved.mime;
     resp->headers["Content-Length"] = std::to_string(data.size());
+    if (resolved.immutable) {
+        resp->headers["Cache-Control"] = AssetManifest::kImmutableCacheControl;
+    }
     resp->body = std::move(data);
     LOG_DEBUG << "SUCCESSFUL: RESPONSE SENDING";
     return resp;
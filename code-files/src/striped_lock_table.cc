@@ -0,0 +1,25 @@
+#include "striped_lock_table.h"
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+StripedLockTable::StripedLockTable(size_t stripes)
+    : stripes_(stripes == 0 ? 1 : stripes) {}
+
+std::shared_mutex& StripedLockTable::lock_for(const std::string& entity, const std::string& id) {
+    size_t hash = std::hash<std::string>{}(entity);
+    hash ^= std::hash<std::string>{}(id) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    return stripes_[hash % stripes_.size()].mutex;
+}
+
+std::shared_ptr<StripedLockTable> StripedLockTable::shared(const std::string& data_path) {
+    static std::mutex registry_mutex;
+    static std::unordered_map<std::string, std::shared_ptr<StripedLockTable>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto& table = registry[data_path];
+    if (!table) {
+        table = std::make_shared<StripedLockTable>();
+    }
+    return table;
+}
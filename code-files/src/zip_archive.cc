@@ -0,0 +1,180 @@
+#include "zip_archive.h"
+#include "logger.h"
+#include <fcntl.h>
+#include <mutex>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+namespace {
+
+// Record signatures and fixed sizes from the zip application note
+constexpr uint32_t kEndOfCentralDirSig = 0x06054b50;
+constexpr uint32_t kCentralDirSig = 0x02014b50;
+constexpr uint32_t kLocalHeaderSig = 0x04034b50;
+constexpr size_t kEndOfCentralDirSize = 22;
+constexpr size_t kCentralDirHeaderSize = 46;
+constexpr size_t kLocalHeaderSize = 30;
+constexpr size_t kMaxCommentSize = 0xFFFF;
+
+uint16_t read_u16(const unsigned char* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t read_u32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+} // namespace
+
+ZipArchive::ZipArchive(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open archive: " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(kEndOfCentralDirSize)) {
+        ::close(fd);
+        throw std::runtime_error("Archive too small to be a zip file: " + path);
+    }
+    length_ = static_cast<size_t>(st.st_size);
+    void* mapping = ::mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file referenced
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Cannot mmap archive: " + path);
+    }
+    base_ = static_cast<const unsigned char*>(mapping);
+
+    try {
+        build_index();
+    } catch (...) {
+        ::munmap(const_cast<unsigned char*>(base_), length_);
+        throw;
+    }
+    LOG_INFO << "Indexed " << index_.size() << " entries from archive " << path;
+}
+
+ZipArchive::~ZipArchive() {
+    if (base_ != nullptr) {
+        ::munmap(const_cast<unsigned char*>(base_), length_);
+    }
+}
+
+void ZipArchive::build_index() {
+    // The end of central directory record sits at the very end, followed only by an optional comment
+    size_t search_floor = length_ > kEndOfCentralDirSize + kMaxCommentSize
+                              ? length_ - kEndOfCentralDirSize - kMaxCommentSize
+                              : 0;
+    const unsigned char* eocd = nullptr;
+    for (size_t pos = length_ - kEndOfCentralDirSize + 1; pos-- > search_floor;) {
+        if (read_u32(base_ + pos) == kEndOfCentralDirSig) {
+            eocd = base_ + pos;
+            break;
+        }
+    }
+    if (eocd == nullptr) {
+        throw std::runtime_error("Missing end of central directory record");
+    }
+
+    uint16_t entry_count = read_u16(eocd + 10);
+    uint32_t dir_size = read_u32(eocd + 12);
+    uint32_t dir_offset = read_u32(eocd + 16);
+    if (static_cast<uint64_t>(dir_offset) + dir_size > length_) {
+        throw std::runtime_error("Central directory out of bounds");
+    }
+
+    index_.reserve(entry_count);
+    const unsigned char* p = base_ + dir_offset;
+    const unsigned char* dir_end = p + dir_size;
+    for (uint16_t i = 0; i < entry_count; ++i) {
+        if (p + kCentralDirHeaderSize > dir_end || read_u32(p) != kCentralDirSig) {
+            throw std::runtime_error("Corrupt central directory record");
+        }
+        uint16_t flags = read_u16(p + 8);
+        Entry entry;
+        entry.method = read_u16(p + 10);
+        entry.crc32 = read_u32(p + 16);
+        entry.compressed_size = read_u32(p + 20);
+        entry.size = read_u32(p + 24);
+        uint16_t name_len = read_u16(p + 28);
+        uint16_t extra_len = read_u16(p + 30);
+        uint16_t comment_len = read_u16(p + 32);
+        uint32_t local_offset = read_u32(p + 42);
+        if (p + kCentralDirHeaderSize + name_len > dir_end) {
+            throw std::runtime_error("Corrupt central directory record");
+        }
+        std::string name(reinterpret_cast<const char*>(p + kCentralDirHeaderSize), name_len);
+        p += kCentralDirHeaderSize + name_len + extra_len + comment_len;
+
+        // Skip directories, encrypted entries, zip64 entries and methods we can't serve
+        bool zip64 = entry.compressed_size == 0xFFFFFFFF || entry.size == 0xFFFFFFFF ||
+                     local_offset == 0xFFFFFFFF;
+        if (name.empty() || name.back() == '/' || (flags & 0x1) || zip64 ||
+            (entry.method != kStored && entry.method != kDeflated)) {
+            continue;
+        }
+
+        // Entry data starts after the local header, whose extra field may differ from the central one
+        if (static_cast<uint64_t>(local_offset) + kLocalHeaderSize > length_ ||
+            read_u32(base_ + local_offset) != kLocalHeaderSig) {
+            throw std::runtime_error("Corrupt local header for " + name);
+        }
+        const unsigned char* local = base_ + local_offset;
+        entry.data_offset = local_offset + kLocalHeaderSize + read_u16(local + 26) + read_u16(local + 28);
+        if (entry.data_offset + entry.compressed_size > length_) {
+            throw std::runtime_error("Entry data out of bounds for " + name);
+        }
+        index_.emplace(std::move(name), entry);
+    }
+}
+
+const ZipArchive::Entry* ZipArchive::find(const std::string& name) const {
+    auto it = index_.find(name);
+    return it == index_.end() ? nullptr : &it->second;
+}
+
+std::string_view ZipArchive::raw_data(const Entry& entry) const {
+    return std::string_view(reinterpret_cast<const char*>(base_ + entry.data_offset), entry.compressed_size);
+}
+
+bool ZipArchive::extract(const Entry& entry, std::string& out) const {
+    std::string_view raw = raw_data(entry);
+    if (entry.method == kStored) {
+        out.assign(raw.data(), raw.size());
+        return true;
+    }
+
+    if (entry.size == 0) {
+        out.clear();
+        return true;
+    }
+
+    // Zip stores raw deflate streams, so inflate without a zlib header
+    z_stream zs{};
+    if (inflateInit2(&zs, -MAX_WBITS) != Z_OK) {
+        return false;
+    }
+    out.resize(entry.size);
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(raw.data()));
+    zs.avail_in = static_cast<uInt>(raw.size());
+    zs.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    zs.avail_out = static_cast<uInt>(out.size());
+    int rc = inflate(&zs, Z_FINISH);
+    inflateEnd(&zs);
+    return rc == Z_STREAM_END && zs.total_out == entry.size;
+}
+
+std::shared_ptr<ZipArchive> ZipArchive::shared(const std::string& path) {
+    static std::mutex registry_mutex;
+    static std::unordered_map<std::string, std::shared_ptr<ZipArchive>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto& archive = registry[path];
+    if (!archive) {
+        archive = std::make_shared<ZipArchive>(path);
+    }
+    return archive;
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <zlib.h>
+#include "archive_file_handler.h"
+#include "request.h"
+#include "response.h"
+
+// Fixture for ArchiveFileHandler tests
+class ArchiveFileHandlerTest : public ::testing::Test {
+protected:
+  ArchiveFileHandler handler;
+
+  ArchiveFileHandlerTest()
+   : handler("/assets", "app_archive/assets.zip") {}
+
+  request make_request(const std::string& uri, const std::string& accept_encoding = "") {
+    request req;
+    req.method = "GET";
+    req.uri = uri;
+    req.http_version = "HTTP/1.1";
+    if (!accept_encoding.empty()) {
+      req.headers["Accept-Encoding"] = accept_encoding;
+    }
+    return req;
+  }
+};
+
+// Decompresses a gzip body with zlib
+std::string gunzip(const std::string& data) {
+  z_stream zs{};
+  inflateInit2(&zs, 16 + MAX_WBITS);
+  std::string out(64 * 1024, '\0');
+  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  zs.avail_in = data.size();
+  zs.next_out = reinterpret_cast<Bytef*>(&out[0]);
+  zs.avail_out = out.size();
+  int rc = inflate(&zs, Z_FINISH);
+  inflateEnd(&zs);
+  out.resize(rc == Z_STREAM_END ? zs.total_out : 0);
+  return out;
+}
+
+// checks that a stored entry is served as-is
+// Expected result: PASS
+TEST_F(ArchiveFileHandlerTest, ServesStoredEntry) {
+  auto res = handler.handle_request(make_request("/assets/hello.txt", "gzip"));
+
+  EXPECT_EQ(res->status_code, 200);
+  EXPECT_EQ(res->headers.at("Content-Type"), "text/plain");
+  EXPECT_EQ(res->headers.count("Content-Encoding"), 0);
+  EXPECT_EQ(res->body, "Hello from inside the archive!\n");
+  EXPECT_EQ(res->headers.at("Content-Length"), std::to_string(res->body.size()));
+}
+
+// checks that a deflated entry is sent compressed when the client accepts gzip
+// Expected result: PASS
+TEST_F(ArchiveFileHandlerTest, ServesDeflatedEntryAsGzip) {
+  auto res = handler.handle_request(make_request("/assets/css/style.css", "gzip, deflate"));
+
+  EXPECT_EQ(res->status_code, 200);
+  EXPECT_EQ(res->headers.at("Content-Type"), "text/css");
+  EXPECT_EQ(res->headers.at("Content-Encoding"), "gzip");
+  EXPECT_EQ(res->headers.at("Vary"), "Accept-Encoding");
+
+  std::string css = gunzip(res->body);
+  EXPECT_EQ(css.size(), 980u);
+  EXPECT_EQ(css.rfind("body {", 0), 0u);
+  // Sent compressed: far smaller than the 980 byte original
+  EXPECT_LT(res->body.size(), 200u);
+}
+
+// checks that a deflated entry is inflated for clients that don't accept gzip
+// Expected result: PASS
+TEST_F(ArchiveFileHandlerTest, InflatesForClientsWithoutGzip) {
+  auto res = handler.handle_request(make_request("/assets/data/user.json"));
+
+  EXPECT_EQ(res->status_code, 200);
+  EXPECT_EQ(res->headers.at("Content-Type"), "application/json");
+  EXPECT_EQ(res->headers.count("Content-Encoding"), 0);
+  EXPECT_EQ(res->body, "{\"name\": \"Joe Bruin\", \"school\": \"UCLA\"}\n");
+}
+
+// checks that percent-encoded names and query strings resolve to the stored entry
+// Expected result: PASS
+TEST_F(ArchiveFileHandlerTest, DecodesEntryNames) {
+  auto res = handler.handle_request(make_request("/assets/hell%6F.txt"));
+  EXPECT_EQ(res->status_code, 200);
+  EXPECT_EQ(res->body, "Hello from inside the archive!\n");
+
+  EXPECT_EQ(handler.handle_request(make_request("/assets/hello.txt?v=2"))->status_code, 200);
+  EXPECT_EQ(handler.handle_request(make_request("/assets/css%2Fstyle.css"))->status_code, 200);
+}
+
+// checks that missing entries and directory traversal return 404
+// Expected result: PASS
+TEST_F(ArchiveFileHandlerTest, Returns404ForMissingEntry) {
+  EXPECT_EQ(handler.handle_request(make_request("/assets/missing.txt"))->status_code, 404);
+  EXPECT_EQ(handler.handle_request(make_request("/assets/../app/index.txt"))->status_code, 404);
+  EXPECT_EQ(handler.handle_request(make_request("/other/hello.txt"))->status_code, 404);
+}
+
+// checks that the real deployed archive indexes its files and skips directories
+// Expected result: PASS
+TEST(ZipArchiveTest, IndexesCentralDirectory) {
+  ZipArchive archive("app/images.zip");
+  ASSERT_NE(archive.find("images/flower.jpeg"), nullptr);
+  EXPECT_EQ(archive.find("images/"), nullptr);
+
+  std::string data;
+  ASSERT_TRUE(archive.extract(*archive.find("images/sunshine.jpg"), data));
+  ASSERT_EQ(data.size(), 18098u);
+  // JPEG magic bytes: 0xFF 0xD8
+  EXPECT_EQ(static_cast<unsigned char>(data[0]), 0xFF);
+  EXPECT_EQ(static_cast<unsigned char>(data[1]), 0xD8);
+}
+
+// checks that a file that isn't a zip archive is rejected
+// Expected result: PASS
+TEST(ZipArchiveTest, RejectsNonZipFile) {
+  EXPECT_THROW(ZipArchive("app/index.txt"), std::runtime_error);
+  EXPECT_THROW(ZipArchive("app/does_not_exist.zip"), std::runtime_error);
+}
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include "change_feed.h"
+#include "crud_handler.h"
+#include "request.h"
+#include "response.h"
+#include <atomic>
+#include <filesystem>
+#include <future>
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+// --------- Happy path tests ---------
+
+// Changes come back in order, filtered to the requested type
+// Expected result: PASS
+TEST(ChangeFeedTest, ChangesSinceFiltersByType) {
+    ChangeFeed feed;
+    feed.record("Shoes", "a", false);
+    feed.record("Hats", "b", false);
+    feed.record("Shoes", "a", true);
+
+    std::vector<ChangeFeed::Change> changes;
+    uint64_t last_seq = 0;
+    ASSERT_TRUE(feed.changes_since("Shoes", 0, changes, last_seq));
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_EQ(changes[0].seq, 1u);
+    EXPECT_FALSE(changes[0].deleted);
+    EXPECT_EQ(changes[1].seq, 3u);
+    EXPECT_TRUE(changes[1].deleted);
+    EXPECT_EQ(last_seq, 3u);
+
+    ASSERT_TRUE(feed.changes_since("Shoes", 3, changes, last_seq));
+    EXPECT_TRUE(changes.empty());
+}
+
+// A parked wait runs when its type changes, and not for other types
+// Expected result: PASS
+TEST(ChangeFeedTest, WaitWakesOnChange) {
+    ChangeFeed feed;
+    std::promise<bool> woken;
+    feed.wait("Shoes", 0, 10s, [&woken](bool timed_out) { woken.set_value(timed_out); });
+    EXPECT_EQ(feed.waiting(), 1u);
+
+    feed.record("Hats", "x", false);
+    EXPECT_EQ(feed.waiting(), 1u);
+    feed.record("Shoes", "a", false);
+    auto result = woken.get_future();
+    ASSERT_EQ(result.wait_for(1s), std::future_status::ready);
+    EXPECT_FALSE(result.get());
+    EXPECT_EQ(feed.waiting(), 0u);
+}
+
+// A wait with nothing to report ends once its timeout passes
+// Expected result: PASS
+TEST(ChangeFeedTest, WaitTimesOut) {
+    ChangeFeed feed;
+    std::promise<bool> woken;
+    auto start = std::chrono::steady_clock::now();
+    feed.wait("Shoes", 0, 50ms, [&woken](bool timed_out) { woken.set_value(timed_out); });
+    auto result = woken.get_future();
+    ASSERT_EQ(result.wait_for(2s), std::future_status::ready);
+    EXPECT_TRUE(result.get());
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 50ms);
+}
+
+// A wait for changes that already happened runs right away
+// Expected result: PASS
+TEST(ChangeFeedTest, WaitRunsImmediatelyWhenBehind) {
+    ChangeFeed feed;
+    feed.record("Shoes", "a", false);
+    bool ran = false;
+    feed.wait("Shoes", 0, 10s, [&ran](bool timed_out) { ran = !timed_out; });
+    EXPECT_TRUE(ran);
+}
+
+// since 0 returns everything still retained, even once older changes were dropped
+// Expected result: PASS
+TEST(ChangeFeedTest, SinceZeroReturnsRetained) {
+    ChangeFeed feed(2);
+    for (int i = 0; i < 5; ++i) {
+        feed.record("Shoes", std::to_string(i), false);
+    }
+    std::vector<ChangeFeed::Change> changes;
+    uint64_t last_seq = 0;
+    ASSERT_TRUE(feed.changes_since("Shoes", 0, changes, last_seq));
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_EQ(changes[0].seq, 4u);
+    bool ran = false;
+    feed.wait("Shoes", 0, 10s, [&ran](bool timed_out) { ran = !timed_out; });
+    EXPECT_TRUE(ran);
+}
+
+// Cancelling a parked wait runs it as timed out, once
+// Expected result: PASS
+TEST(ChangeFeedTest, CancelEndsWait) {
+    ChangeFeed feed;
+    int runs = 0;
+    bool timed_out = false;
+    uint64_t token = feed.wait("Shoes", 0, 10s, [&](bool t) { ++runs; timed_out = t; });
+    ASSERT_NE(token, 0u);
+    feed.cancel("Shoes", token);
+    EXPECT_EQ(runs, 1);
+    EXPECT_TRUE(timed_out);
+    EXPECT_EQ(feed.waiting(), 0u);
+    feed.cancel("Shoes", token);
+    feed.record("Shoes", "a", false);
+    EXPECT_EQ(runs, 1);
+}
+
+// _changes returns the feed for one type as JSON
+// Expected result: PASS
+TEST(ChangeFeedTest, CrudHandlerListsChanges) {
+    const std::string data_path = "/tmp/change_feed_test";
+    fs::remove_all(data_path);
+    auto handler = CrudHandler::create({{"data_path", data_path}});
+    auto feed = ChangeFeed::shared(data_path);
+    uint64_t start = feed->last_seq();
+
+    request req;
+    req.method = "PUT";
+    req.uri = "/api/Shoes/a";
+    req.body = "{\"size\": 9}";
+    handler->handle_request(req);
+    req.method = "DELETE";
+    handler->handle_request(req);
+
+    req.method = "GET";
+    req.body.clear();
+    req.uri = "/api/Shoes/_changes?since=" + std::to_string(start);
+    auto res = handler->handle_request(req);
+    EXPECT_EQ(res->status_code, 200);
+    EXPECT_EQ(res->body, "{\"results\": [{\"seq\": " + std::to_string(start + 1) +
+                         ", \"id\": \"a\", \"deleted\": false}, {\"seq\": " + std::to_string(start + 2) +
+                         ", \"id\": \"a\", \"deleted\": true}], \"last_seq\": " + std::to_string(start + 2) + "}\n");
+
+    // A long poll through the async path parks until the next write
+    std::promise<std::string> body;
+    req.uri = "/api/Shoes/_changes?feed=longpoll&since=now";
+    handler->handle_request_async(req, [&body](std::unique_ptr<response> res) { body.set_value(res->body); });
+    auto parked = body.get_future();
+    EXPECT_EQ(parked.wait_for(50ms), std::future_status::timeout);
+    req.method = "PUT";
+    req.uri = "/api/Shoes/b";
+    req.body = "{}";
+    handler->handle_request(req);
+    ASSERT_EQ(parked.wait_for(1s), std::future_status::ready);
+    EXPECT_NE(parked.get().find("\"id\": \"b\""), std::string::npos);
+
+    // A client that goes away gets its parked poll ended rather than held to the timeout
+    std::promise<std::string> cancelled;
+    req.method = "GET";
+    req.body.clear();
+    req.uri = "/api/Shoes/_changes?feed=longpoll&since=now";
+    handler->handle_request_async(req, [&cancelled](std::unique_ptr<response> res) { cancelled.set_value(res->body); });
+    auto ended = cancelled.get_future();
+    EXPECT_EQ(ended.wait_for(50ms), std::future_status::timeout);
+    handler->cancel();
+    ASSERT_EQ(ended.wait_for(1s), std::future_status::ready);
+    EXPECT_EQ(ended.get().find("\"id\""), std::string::npos);
+    fs::remove_all(data_path);
+}
+
+// --------- Unhappy path tests ---------
+
+// Asking for changes that were dropped, or from the future, fails so the client relists
+// Expected result: FAIL
+TEST(ChangeFeedTest, ChangesOutsideRetentionFail) {
+    ChangeFeed feed(2);
+    for (int i = 0; i < 5; ++i) {
+        feed.record("Shoes", std::to_string(i), false);
+    }
+    std::vector<ChangeFeed::Change> changes;
+    uint64_t last_seq = 0;
+    EXPECT_FALSE(feed.changes_since("Shoes", 1, changes, last_seq));
+    EXPECT_EQ(last_seq, 5u);
+    EXPECT_TRUE(feed.changes_since("Shoes", 3, changes, last_seq));
+    EXPECT_EQ(changes.size(), 2u);
+    EXPECT_FALSE(feed.changes_since("Shoes", 6, changes, last_seq));
+}
+
+// A since that isn't a number is a 400
+// Expected result: FAIL
+TEST(ChangeFeedTest, CrudHandlerRejectsBadSince) {
+    auto handler = CrudHandler::create({{"data_path", "/tmp/change_feed_test"}});
+    request req;
+    req.method = "GET";
+    req.uri = "/api/Shoes/_changes?since=abc";
+    EXPECT_EQ(handler->handle_request(req)->status_code, 400);
+    fs::remove_all("/tmp/change_feed_test");
+}
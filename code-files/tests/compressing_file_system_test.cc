@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include "compressing_file_system.h"
+#include "crud_handler.h"
+#include "file_system.h"
+#include "request.h"
+#include "response.h"
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+class CompressingFileSystemTest : public ::testing::Test {
+protected:
+    const std::string data_path = "/tmp/compressing_file_system_test";
+    std::string body;
+
+    void SetUp() override {
+        fs::remove_all(data_path);
+        fs::create_directories(data_path);
+        // Repetitive like real JSON documents, and well over the compression threshold
+        body = "[";
+        for (int i = 0; i < 50; ++i) {
+            body += std::string(i ? ", " : "") + "{\"name\": \"Mouse " + std::to_string(i) + "\", \"price\": 25}";
+        }
+        body += "]";
+    }
+
+    void TearDown() override {
+        fs::remove_all(data_path);
+    }
+};
+
+// --------- Happy path tests ---------
+
+// Large bodies shrink and come back unchanged; small ones are left plain
+// Expected result: PASS
+TEST_F(CompressingFileSystemTest, EncodeRoundTrips) {
+    std::string stored = CompressingFileSystem::encode(body);
+    EXPECT_TRUE(CompressingFileSystem::is_compressed(stored));
+    EXPECT_LT(stored.size(), body.size() / 4);
+    std::string plain;
+    ASSERT_TRUE(CompressingFileSystem::decode(stored, plain));
+    EXPECT_EQ(plain, body);
+
+    EXPECT_EQ(CompressingFileSystem::encode("{\"a\": 1}"), "{\"a\": 1}");
+}
+
+// The inner store holds gzip, reads are plain, and the stored form carries the plain ETag
+// Expected result: PASS
+TEST_F(CompressingFileSystemTest, StoresCompressedReadsPlain) {
+    auto inner = std::make_shared<FileSystem>(data_path);
+    CompressingFileSystem store(inner);
+    bool created = false;
+    ASSERT_TRUE(store.put_entity("Lists", "a", body, created));
+
+    EXPECT_TRUE(CompressingFileSystem::is_compressed(inner->read_entity("Lists", "a").second));
+    EXPECT_EQ(store.read_entity("Lists", "a").second, body);
+
+    StoredEntity entity;
+    ASSERT_TRUE(store.read_entity_stored("Lists", "a", entity));
+    EXPECT_EQ(entity.encoding, "gzip");
+    EXPECT_EQ(entity.etag, entity_etag(body));
+
+    // Updates and batches see plain bodies too
+    bool found = false;
+    ASSERT_TRUE(store.update_entity("Lists", "a", [this](std::string& data) {
+        EXPECT_EQ(data, body);
+        data += " ";
+        return true;
+    }, found));
+    std::vector<BatchOp> ops(1);
+    ops[0].type = BatchOp::kGet;
+    ops[0].name = "Lists";
+    ops[0].id = "a";
+    ASSERT_TRUE(store.apply_batch(ops));
+    EXPECT_EQ(ops[0].data, body + " ");
+}
+
+// GET sends the stored gzip bytes to clients that accept them, and plain JSON otherwise
+// Expected result: PASS
+TEST_F(CompressingFileSystemTest, CrudHandlerServesStoredGzip) {
+    auto handler = CrudHandler::create({{"data_path", data_path}, {"compress", "on"}});
+    request req;
+    req.method = "PUT";
+    req.uri = "/api/Lists/a";
+    req.body = body;
+    EXPECT_EQ(handler->handle_request(req)->status_code, 201);
+
+    req.method = "GET";
+    req.body.clear();
+    req.headers["Accept-Encoding"] = "gzip, deflate";
+    auto res = handler->handle_request(req);
+    EXPECT_EQ(res->status_code, 200);
+    EXPECT_EQ(res->headers["Content-Encoding"], "gzip");
+    EXPECT_EQ(res->headers["Vary"], "Accept-Encoding");
+    std::string gzip_etag = res->headers["ETag"];
+    EXPECT_NE(gzip_etag, entity_etag(body));
+    std::string plain;
+    ASSERT_TRUE(CompressingFileSystem::decode(res->body, plain));
+    EXPECT_EQ(plain, body);
+
+    req.headers["If-None-Match"] = gzip_etag;
+    res = handler->handle_request(req);
+    EXPECT_EQ(res->status_code, 304);
+    EXPECT_EQ(res->headers["Vary"], "Accept-Encoding");
+
+    // Each representation has its own validator
+    req.headers.erase("Accept-Encoding");
+    EXPECT_EQ(handler->handle_request(req)->status_code, 200);
+    req.headers.clear();
+    res = handler->handle_request(req);
+    EXPECT_EQ(res->headers.count("Content-Encoding"), 0u);
+    EXPECT_EQ(res->headers["ETag"], entity_etag(body));
+    EXPECT_EQ(res->headers["Vary"], "Accept-Encoding");
+    EXPECT_EQ(res->body, body);
+
+    // Either tag names the version for writes
+    req.method = "DELETE";
+    req.headers["If-Match"] = gzip_etag;
+    EXPECT_EQ(handler->handle_request(req)->status_code, 200);
+}
+
+// With the entity cache on, gzip clients still get the stored gzip and others the cached body
+// Expected result: PASS
+TEST_F(CompressingFileSystemTest, CrudHandlerServesStoredGzipWithCache) {
+    auto handler = CrudHandler::create({{"data_path", data_path}, {"compress", "on"}, {"entity_cache", "1m"}});
+    request req;
+    req.method = "PUT";
+    req.uri = "/api/Lists/a";
+    req.body = body;
+    EXPECT_EQ(handler->handle_request(req)->status_code, 201);
+
+    req.method = "GET";
+    req.body.clear();
+    EXPECT_EQ(handler->handle_request(req)->body, body);
+    auto res = handler->handle_request(req);
+    EXPECT_EQ(res->headers["X-Cache"], "HIT");
+    EXPECT_EQ(res->body, body);
+
+    req.headers["Accept-Encoding"] = "gzip";
+    res = handler->handle_request(req);
+    EXPECT_EQ(res->headers["Content-Encoding"], "gzip");
+    EXPECT_TRUE(CompressingFileSystem::is_compressed(res->body));
+}
+
+// Field indexes read through the compressing store, so compressed bodies are indexed
+// Expected result: PASS
+TEST_F(CompressingFileSystemTest, CrudHandlerIndexesCompressedBodies) {
+    std::string doc = "{\"brand\": \"Logi\", \"notes\": \"" + std::string(200, 'x') + "\"}";
+    {
+        CompressingFileSystem store(std::make_shared<FileSystem>(data_path));
+        bool created = false;
+        ASSERT_TRUE(store.put_entity("Mice", "m1", doc, created));
+    }
+    auto handler = CrudHandler::create({{"data_path", data_path}, {"compress", "on"}, {"index", "brand"}});
+    request req;
+    req.method = "GET";
+    req.uri = "/api/Mice?brand=Logi";
+    auto res = handler->handle_request(req);
+    EXPECT_EQ(res->status_code, 200);
+    EXPECT_NE(res->body.find("m1"), std::string::npos);
+}
+
+// --------- Unhappy path tests ---------
+
+// Bodies stored before compression was turned on still read, and corrupt members don't
+// Expected result: FAIL
+TEST_F(CompressingFileSystemTest, PlainAndCorruptStoredBodies) {
+    auto inner = std::make_shared<FileSystem>(data_path);
+    bool created = false;
+    ASSERT_TRUE(inner->put_entity("Lists", "plain", body, created));
+    std::string corrupt = CompressingFileSystem::encode(body);
+    corrupt[corrupt.size() / 2] ^= 0x55;
+    ASSERT_TRUE(inner->put_entity("Lists", "corrupt", corrupt, created));
+
+    CompressingFileSystem store(inner);
+    EXPECT_EQ(store.read_entity("Lists", "plain").second, body);
+    StoredEntity entity;
+    ASSERT_TRUE(store.read_entity_stored("Lists", "plain", entity));
+    EXPECT_TRUE(entity.encoding.empty());
+    EXPECT_FALSE(store.read_entity("Lists", "corrupt").first);
+}
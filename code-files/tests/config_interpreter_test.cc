@@ -58,8 +58,166 @@ TEST_F(ConfigInterpreterTest, ExtractHandlerConfigs_ValidConfig) {
     EXPECT_EQ(result[1].args.at("doc_root"), "./files");
 }
 
+// Optional open file cache directives are copied into StaticFileHandler args
+// Expected result: PASS
+TEST_F(ConfigInterpreterTest, ExtractHandlerConfigs_OpenFileCacheArgs) {
+    std::ifstream out_config("test_configs/interpreter_configs/open_file_cache_config");
+    NginxConfig config;
+    process_config_file(out_config, config);
+    std::vector<ConfigStruct> result = extract_handler_configs(&config);
+
+    ASSERT_EQ(result.size(), 2);
+
+    EXPECT_EQ(result[0].args.at("open_file_cache"), "512");
+    EXPECT_EQ(result[0].args.at("open_file_cache_valid"), "10");
+    EXPECT_EQ(result[0].args.at("fingerprint"), "on");
+
+    // Directives are optional and left out of args when absent
+    EXPECT_EQ(result[1].args.count("open_file_cache"), 0);
+    EXPECT_EQ(result[1].args.count("open_file_cache_valid"), 0);
+    EXPECT_EQ(result[1].args.count("fingerprint"), 0);
+}
+
+// Optional storage, durability, cache, layout, index, id_scheme, ttl and compress directives are copied into CrudHandler args
+// Expected result: PASS
+TEST_F(ConfigInterpreterTest, ExtractHandlerConfigs_CrudStorageArg) {
+    std::ifstream out_config("test_configs/interpreter_configs/crud_storage_config");
+    NginxConfig config;
+    process_config_file(out_config, config);
+    std::vector<ConfigStruct> result = extract_handler_configs(&config);
+
+    ASSERT_EQ(result.size(), 2);
+    EXPECT_EQ(result[0].args.at("storage"), "log");
+    EXPECT_EQ(result[0].args.at("durable"), "on");
+    EXPECT_EQ(result[0].args.at("commit_window_us"), "500");
+    EXPECT_EQ(result[0].args.at("entity_cache"), "64m");
+    EXPECT_EQ(result[1].args.count("storage"), 0);
+    EXPECT_EQ(result[1].args.count("durable"), 0);
+    EXPECT_EQ(result[1].args.count("entity_cache"), 0);
+    EXPECT_EQ(result[0].args.count("layout"), 0);
+    EXPECT_EQ(result[1].args.at("layout"), "sharded");
+    EXPECT_EQ(result[0].args.count("index"), 0);
+    EXPECT_EQ(result[1].args.at("index"), "name,price,sku");
+    EXPECT_EQ(result[0].args.at("id_scheme"), "ulid");
+    EXPECT_EQ(result[1].args.count("id_scheme"), 0);
+    EXPECT_EQ(result[0].args.at("ttl"), "1800");
+    EXPECT_EQ(result[1].args.count("ttl"), 0);
+    EXPECT_EQ(result[0].args.at("compress"), "on");
+    EXPECT_EQ(result[1].args.count("compress"), 0);
+}
+
 // --------- Unhappy path tests ---------
 
+// Unknown CrudHandler storage backend
+// Expected result: FAIL
+TEST_F(ConfigInterpreterTest, InvalidCrudStorage) {
+    std::ifstream out_config("test_configs/interpreter_configs/invalid_crud_storage_config");
+    NginxConfig config;
+    process_config_file(out_config, config);
+    EXPECT_THROW({
+        extract_handler_configs(&config);
+    }, std::runtime_error);
+}
+
+// Unknown CrudHandler directory layout
+// Expected result: FAIL
+TEST_F(ConfigInterpreterTest, InvalidCrudLayout) {
+    std::ifstream out_config("test_configs/interpreter_configs/invalid_crud_layout_config");
+    NginxConfig config;
+    process_config_file(out_config, config);
+    EXPECT_THROW({
+        extract_handler_configs(&config);
+    }, std::runtime_error);
+}
+
+// Unknown CrudHandler id scheme
+// Expected result: FAIL
+TEST_F(ConfigInterpreterTest, InvalidCrudIdScheme) {
+    std::ifstream out_config("test_configs/interpreter_configs/invalid_crud_id_scheme_config");
+    NginxConfig config;
+    process_config_file(out_config, config);
+    EXPECT_THROW({
+        extract_handler_configs(&config);
+    }, std::runtime_error);
+}
+
+// CrudHandler ttl that isn't a number of seconds
+// Expected result: FAIL
+TEST_F(ConfigInterpreterTest, InvalidCrudTtl) {
+    std::ifstream out_config("test_configs/interpreter_configs/invalid_crud_ttl_config");
+    NginxConfig config;
+    process_config_file(out_config, config);
+    EXPECT_THROW({
+        extract_handler_configs(&config);
+    }, std::runtime_error);
+}
+
+// CrudHandler compress that isn't on or off
+// Expected result: FAIL
+TEST_F(ConfigInterpreterTest, InvalidCrudCompress) {
+    std::ifstream out_config("test_configs/interpreter_configs/invalid_crud_compress_config");
+    NginxConfig config;
+    process_config_file(out_config, config);
+    EXPECT_THROW({
+        extract_handler_configs(&config);
+    }, std::runtime_error);
+}
+
+// CrudHandler locations on one data_path, only one of them caching entities
+// Expected result: FAIL
+TEST_F(ConfigInterpreterTest, MixedCrudEntityCache) {
+    std::ifstream out_config("test_configs/interpreter_configs/mixed_crud_cache_config");
+    NginxConfig config;
+    process_config_file(out_config, config);
+    EXPECT_THROW({
+        extract_handler_configs(&config);
+    }, std::runtime_error);
+}
+
+// CrudHandler locations on one data_path declaring different index fields
+// Expected result: FAIL
+TEST_F(ConfigInterpreterTest, MixedCrudIndex) {
+    std::ifstream out_config("test_configs/interpreter_configs/mixed_crud_index_config");
+    NginxConfig config;
+    process_config_file(out_config, config);
+    EXPECT_THROW({
+        extract_handler_configs(&config);
+    }, std::runtime_error);
+}
+
+// CrudHandler locations on one data_path with different id schemes
+// Expected result: FAIL
+TEST_F(ConfigInterpreterTest, MixedCrudIdScheme) {
+    std::ifstream out_config("test_configs/interpreter_configs/mixed_crud_id_scheme_config");
+    NginxConfig config;
+    process_config_file(out_config, config);
+    EXPECT_THROW({
+        extract_handler_configs(&config);
+    }, std::runtime_error);
+}
+
+// CrudHandler locations on one data_path with different group commit windows
+// Expected result: FAIL
+TEST_F(ConfigInterpreterTest, MixedCrudCommitWindow) {
+    std::ifstream out_config("test_configs/interpreter_configs/mixed_crud_commit_window_config");
+    NginxConfig config;
+    process_config_file(out_config, config);
+    EXPECT_THROW({
+        extract_handler_configs(&config);
+    }, std::runtime_error);
+}
+
+// CrudHandler locations on one data_path where only one compresses bodies
+// Expected result: FAIL
+TEST_F(ConfigInterpreterTest, MixedCrudCompress) {
+    std::ifstream out_config("test_configs/interpreter_configs/mixed_crud_compress_config");
+    NginxConfig config;
+    process_config_file(out_config, config);
+    EXPECT_THROW({
+        extract_handler_configs(&config);
+    }, std::runtime_error);
+}
+
 // Invalid port number
 // Expected result: FAIL
 TEST_F(ConfigInterpreterTest, InvalidPortNumber) {
@@ -1,4 +1,5 @@
 #include "crud_handler.h"
+#include "log_file_system.h"
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include "request.h"
@@ -32,8 +33,8 @@ public:
 // Test fixture using dependency injection
 class CrudHandlerTest : public ::testing::Test {
 protected:
-    // We give PUT tests a real, writable temp dir because CrudHandler::put
-    // still writes directly using std::filesystem (beyond the interface).
+    // get_data_path() hands out a real, writable temp dir in case a handler
+    // path touches the disk beyond the interface.
     const std::string tmp_dir = "/tmp/crud_test_di/";
     std::shared_ptr<NiceMock<MockFileSystem>> mock_fs;
     CrudHandler handler;
@@ -84,7 +85,7 @@ TEST_F(CrudHandlerTest, MissingEntityReturns400) {
 // Expected result: PASS
 TEST_F(CrudHandlerTest, UnsupportedMethodReturns405) {
     request req;
-    req.method = "PATCH";               // not supported
+    req.method = "TRACE";               // not supported
     req.uri    = "/api/Shoes/1";
 
     auto res = handler.handle_request(req);
@@ -215,6 +216,76 @@ TEST_F(CrudHandlerTest, GetRequestWithoutIdReturnsListOfEntities) {
     EXPECT_NE(res->body.find("id2"), std::string::npos);
 }
 
+// Checks that ?limit= returns one sorted page and a cursor for the next
+TEST_F(CrudHandlerTest, GetRequestWithLimitReturnsPage) {
+    std::vector<std::string> ids = {"c", "a", "d", "b"};
+    EXPECT_CALL(*mock_fs, list_entities("Shoes"))
+        .WillRepeatedly(Return(std::make_pair(true, ids)));
+
+    request req;
+    req.method = "GET";
+    req.uri    = "/api/Shoes?limit=2";
+    auto first = handler.handle_request(req);
+    EXPECT_EQ(first->status_code, 200);
+    EXPECT_EQ(first->body, "{\"ids\": [\"a\", \"b\"], \"next\": \"b\"}\n");
+
+    req.uri = "/api/Shoes?limit=2&after=b";
+    auto last = handler.handle_request(req);
+    EXPECT_EQ(last->body, "{\"ids\": [\"c\", \"d\"], \"next\": null}\n");
+}
+
+// Checks that a bad limit is rejected
+TEST_F(CrudHandlerTest, GetRequestWithInvalidLimitReturns400) {
+    request req;
+    req.method = "GET";
+    for (const std::string uri : {"/api/Shoes?limit=0", "/api/Shoes?limit=-1", "/api/Shoes?limit=ten"}) {
+        req.uri = uri;
+        EXPECT_EQ(handler.handle_request(req)->status_code, 400) << uri;
+    }
+}
+
+// Checks that ?stream=true produces the full array through the body stream
+TEST_F(CrudHandlerTest, GetRequestWithStreamReturnsChunkedListing) {
+    std::vector<std::string> ids;
+    for (int i = 0; i < 2500; ++i) {
+        ids.push_back(std::to_string(100000 + i));
+    }
+    EXPECT_CALL(*mock_fs, list_entities("Shoes"))
+        .WillRepeatedly(Return(std::make_pair(true, ids)));
+
+    request req;
+    req.method = "GET";
+    req.uri    = "/api/Shoes?stream=true";
+    auto res = handler.handle_request(req);
+    ASSERT_EQ(res->status_code, 200);
+    ASSERT_TRUE(res->body_stream);
+
+    std::string body, chunk;
+    int chunks = 0;
+    while (res->body_stream(chunk)) {
+        body += chunk;
+        ++chunks;
+    }
+    EXPECT_EQ(chunks, 3);
+    EXPECT_EQ(body.front(), '[');
+    EXPECT_EQ(body.substr(body.size() - 2), "]\n");
+    EXPECT_NE(body.find("\"100000\", \"100001\""), std::string::npos);
+    EXPECT_NE(body.find("\"102499\"]"), std::string::npos);
+}
+
+// Checks that streaming an unknown type is a plain 404
+TEST_F(CrudHandlerTest, GetRequestWithStreamForUnknownTypeReturns404) {
+    EXPECT_CALL(*mock_fs, list_entities("Nope"))
+        .WillOnce(Return(std::make_pair(false, std::vector<std::string>{})));
+
+    request req;
+    req.method = "GET";
+    req.uri    = "/api/Nope?stream=true";
+    auto res = handler.handle_request(req);
+    EXPECT_EQ(res->status_code, 404);
+    EXPECT_FALSE(res->body_stream);
+}
+
 // --------------------------- PUT Tests ---------------------------
 
 // Checks if a PUT request without an ID returns a 400 Bad Request
@@ -264,6 +335,54 @@ TEST_F(CrudHandlerTest, PutRequestWithValidIdUpdatesEntity) {
 }
 
 
+// --------------------------- PATCH Tests ---------------------------
+
+// Checks that a merge patch adds, replaces and removes fields and keeps the rest
+TEST_F(CrudHandlerTest, PatchRequestMergesIntoEntity) {
+    EXPECT_CALL(*mock_fs, read_entity("Shoes", "123"))
+        .WillOnce(Return(std::make_pair(true, std::string("{\"size\":9,\"color\":{\"main\":\"red\",\"trim\":\"white\"}}"))));
+    EXPECT_CALL(*mock_fs, write_entity("Shoes", "123", "{\"color\":{\"main\":\"blue\"},\"laces\":true,\"size\":9}"))
+        .WillOnce(Return(true));
+
+    request req;
+    req.method = "PATCH";
+    req.uri    = "/api/Shoes/123";
+    req.headers["Content-Type"] = "application/merge-patch+json";
+    req.body   = "{\"color\": {\"main\": \"blue\", \"trim\": null}, \"laces\": true}";
+    auto res = handler.handle_request(req);
+
+    EXPECT_EQ(res->status_code, 200);
+    EXPECT_EQ(res->body, "{\"id\": \"123\"}\n");
+}
+
+// Checks that patching a missing entity returns 404 without writing
+TEST_F(CrudHandlerTest, PatchRequestForMissingEntityReturns404) {
+    EXPECT_CALL(*mock_fs, read_entity("Shoes", "nope"))
+        .WillOnce(Return(std::make_pair(false, std::string())));
+    EXPECT_CALL(*mock_fs, write_entity(_, _, _)).Times(0);
+
+    request req;
+    req.method = "PATCH";
+    req.uri    = "/api/Shoes/nope";
+    req.body   = "{\"size\": 10}";
+    EXPECT_EQ(handler.handle_request(req)->status_code, 404);
+}
+
+// Checks that JSON Patch documents and invalid JSON are refused
+TEST_F(CrudHandlerTest, PatchRequestRejectsJsonPatchAndInvalidJson) {
+    EXPECT_CALL(*mock_fs, write_entity(_, _, _)).Times(0);
+    request req;
+    req.method = "PATCH";
+    req.uri    = "/api/Shoes/123";
+    req.headers["Content-Type"] = "application/json-patch+json";
+    req.body   = "[{\"op\": \"remove\", \"path\": \"/size\"}]";
+    EXPECT_EQ(handler.handle_request(req)->status_code, 415);
+
+    req.headers.clear();
+    req.body = "{\"size\": ";
+    EXPECT_EQ(handler.handle_request(req)->status_code, 400);
+}
+
 // --------------------------- DELETE Tests ---------------------------
 
 // Checks if a DELETE request removes an existing entity
@@ -307,6 +426,24 @@ TEST_F(CrudHandlerTest, DeleteRequestWithoutIdReturns400) {
     EXPECT_EQ(res->reason_phrase, "Bad Request");
 }
 
+// Checks that ids which aren't a single path segment are rejected before they reach storage
+TEST_F(CrudHandlerTest, PathLikeIdsReturn400) {
+    const std::string data_path = tmp_dir + "store";
+    auto real = CrudHandler::create({{"data_path", data_path}});
+    const char* uris[] = {"/api/Shoes/a/b/c", "/api/Shoes/..", "/api/Shoes/.", "/api/../x/y", "/api/./x"};
+    for (const char* method : {"GET", "PUT", "PATCH", "DELETE"}) {
+        for (const char* uri : uris) {
+            request req;
+            req.method = method;
+            req.uri = uri;
+            req.body = "{\"a\": 1}";
+            EXPECT_EQ(real->handle_request(req)->status_code, 400) << method << " " << uri;
+        }
+    }
+    EXPECT_FALSE(std::filesystem::exists(data_path + "/Shoes"));
+    EXPECT_FALSE(std::filesystem::exists(tmp_dir + "x"));
+}
+
 // Checks if a DELETE request for an entity in a non-existent entity type still returns 404
 TEST_F(CrudHandlerTest, DeleteRequestForUnknownEntityTypeReturns404) {
     EXPECT_CALL(*mock_fs,
@@ -323,3 +460,239 @@ TEST_F(CrudHandlerTest, DeleteRequestForUnknownEntityTypeReturns404) {
     EXPECT_EQ(res->reason_phrase, "Not Found");
     EXPECT_EQ(res->body, "Entity not found\n");
 }
+
+// --------------------------- Conditional Request Tests ---------------------------
+
+// Checks that GET sends an ETag and answers 304 without a body when the client already has it
+TEST_F(CrudHandlerTest, GetRequestWithMatchingIfNoneMatchReturns304) {
+    const std::string stored = "{\"size\": 9}";
+    EXPECT_CALL(*mock_fs, read_entity("Shoes", "123"))
+        .WillRepeatedly(Return(std::make_pair(true, stored)));
+
+    request req;
+    req.method = "GET";
+    req.uri    = "/api/Shoes/123";
+    auto res = handler.handle_request(req);
+    EXPECT_EQ(res->status_code, 200);
+    EXPECT_EQ(res->headers["ETag"], entity_etag(stored));
+
+    req.headers["If-None-Match"] = "\"stale\", " + entity_etag(stored);
+    res = handler.handle_request(req);
+    EXPECT_EQ(res->status_code, 304);
+    EXPECT_TRUE(res->body.empty());
+
+    req.headers["If-None-Match"] = "\"stale\"";
+    EXPECT_EQ(handler.handle_request(req)->status_code, 200);
+}
+
+// Checks that PUT with If-Match writes only when the ETag is current, and 412s otherwise
+TEST_F(CrudHandlerTest, PutRequestWithIfMatchComparesAndSets) {
+    const std::string stored = "{\"size\": 9}";
+    EXPECT_CALL(*mock_fs, read_entity("Shoes", "123"))
+        .WillRepeatedly(Return(std::make_pair(true, stored)));
+    EXPECT_CALL(*mock_fs, write_entity("Shoes", "123", "{\"size\": 10}"))
+        .WillOnce(Return(true));
+
+    request req;
+    req.method = "PUT";
+    req.uri    = "/api/Shoes/123";
+    req.body   = "{\"size\": 10}";
+    req.headers["If-Match"] = "\"stale\"";
+    auto res = handler.handle_request(req);
+    EXPECT_EQ(res->status_code, 412);
+    EXPECT_EQ(res->headers["ETag"], entity_etag(stored));
+
+    req.headers["If-Match"] = entity_etag(stored);
+    res = handler.handle_request(req);
+    EXPECT_EQ(res->status_code, 200);
+    EXPECT_EQ(res->headers["ETag"], entity_etag(req.body));
+}
+
+// Checks that PATCH and DELETE with a stale If-Match leave the entity alone, and a missing one 412s
+TEST_F(CrudHandlerTest, PatchAndDeleteWithStaleIfMatchReturn412) {
+    EXPECT_CALL(*mock_fs, read_entity("Shoes", "123"))
+        .WillRepeatedly(Return(std::make_pair(true, std::string("{\"size\": 9}"))));
+    EXPECT_CALL(*mock_fs, read_entity("Shoes", "nope"))
+        .WillRepeatedly(Return(std::make_pair(false, std::string())));
+    EXPECT_CALL(*mock_fs, write_entity(_, _, _)).Times(0);
+    EXPECT_CALL(*mock_fs, delete_entity(_, _)).Times(0);
+
+    request req;
+    req.uri    = "/api/Shoes/123";
+    req.headers["If-Match"] = "\"stale\"";
+    req.method = "PATCH";
+    req.body   = "{\"size\": 10}";
+    EXPECT_EQ(handler.handle_request(req)->status_code, 412);
+    req.method = "DELETE";
+    req.body.clear();
+    EXPECT_EQ(handler.handle_request(req)->status_code, 412);
+
+    req.uri = "/api/Shoes/nope";
+    req.headers["If-Match"] = "*";
+    EXPECT_EQ(handler.handle_request(req)->status_code, 412);
+}
+
+// Checks that DELETE with a current If-Match removes the entity
+TEST_F(CrudHandlerTest, DeleteRequestWithMatchingIfMatchRemovesEntity) {
+    const std::string stored = "{\"size\": 9}";
+    EXPECT_CALL(*mock_fs, read_entity("Shoes", "123"))
+        .WillOnce(Return(std::make_pair(true, stored)));
+    EXPECT_CALL(*mock_fs, delete_entity("Shoes", "123"))
+        .WillOnce(Return(true));
+
+    request req;
+    req.method = "DELETE";
+    req.uri    = "/api/Shoes/123";
+    req.headers["If-Match"] = entity_etag(stored);
+    EXPECT_EQ(handler.handle_request(req)->status_code, 200);
+}
+
+// --------------------------- Batch Tests ---------------------------
+
+// Checks that a JSON array batch runs every operation and reports results in order
+TEST_F(CrudHandlerTest, BatchArrayRunsOperationsInOrder) {
+    EXPECT_CALL(*mock_fs, create_entity("Shoes"))
+        .WillOnce(Return(std::make_pair(true, std::string("new-id"))));
+    EXPECT_CALL(*mock_fs, write_entity("Shoes", "new-id", "{\"size\":9}"))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*mock_fs, read_entity("Shoes", "old-id"))
+        .WillOnce(Return(std::make_pair(true, std::string("{\"size\":8}"))));
+    EXPECT_CALL(*mock_fs, delete_entity("Shoes", "gone"))
+        .WillOnce(Return(false));
+
+    request req;
+    req.method = "POST";
+    req.uri    = "/api/Shoes/_batch";
+    req.body   = "[{\"op\": \"create\", \"body\": {\"size\": 9}},"
+                 " {\"op\": \"get\", \"id\": \"old-id\"},"
+                 " {\"op\": \"delete\", \"id\": \"gone\"},"
+                 " {\"op\": \"explode\"}]";
+    auto res = handler.handle_request(req);
+
+    EXPECT_EQ(res->status_code, 200);
+    EXPECT_EQ(res->body,
+              "[{\"status\": 201, \"id\": \"new-id\"}, "
+              "{\"status\": 200, \"id\": \"old-id\", \"body\": {\"size\":8}}, "
+              "{\"status\": 404, \"id\": \"gone\"}, "
+              "{\"status\": 400, \"error\": \"unknown op: explode\"}]\n");
+}
+
+// Checks that an NDJSON batch gets NDJSON results
+TEST_F(CrudHandlerTest, BatchNdjsonReturnsNdjson) {
+    EXPECT_CALL(*mock_fs, exists("Shoes", "a")).WillOnce(Return(false));
+    EXPECT_CALL(*mock_fs, write_entity("Shoes", "a", "{\"size\":1}")).WillOnce(Return(true));
+
+    request req;
+    req.method = "POST";
+    req.uri    = "/api/Shoes/_batch";
+    req.body   = "{\"op\": \"put\", \"id\": \"a\", \"body\": {\"size\": 1}}\n"
+                 "\n"
+                 "{\"op\": \"put\", \"id\": \"b\"}\n";
+    auto res = handler.handle_request(req);
+
+    EXPECT_EQ(res->status_code, 200);
+    EXPECT_EQ(res->headers["Content-Type"], "application/x-ndjson");
+    EXPECT_EQ(res->body,
+              "{\"status\": 201, \"id\": \"a\"}\n"
+              "{\"status\": 400, \"error\": \"missing JSON body\"}\n");
+}
+
+// Checks that a batch that isn't JSON is rejected as a whole
+TEST_F(CrudHandlerTest, BatchWithInvalidJsonReturns400) {
+    request req;
+    req.method = "POST";
+    req.uri    = "/api/Shoes/_batch";
+    for (const std::string body : {"[{\"op\": ", "", "[]"}) {
+        req.body = body;
+        EXPECT_EQ(handler.handle_request(req)->status_code, 400) << body;
+    }
+}
+
+// --------------------------- Export/Import Tests ---------------------------
+
+// Drains a streamed body
+static std::string read_stream(response& res) {
+    std::string body;
+    std::string chunk;
+    while (res.body_stream && res.body_stream(chunk)) {
+        body += chunk;
+    }
+    return body;
+}
+
+// Checks that an export imported into another store reproduces every entity, across backends
+TEST_F(CrudHandlerTest, ExportThenImportRoundTrips) {
+    CrudHandler source(std::make_shared<FileSystem>(tmp_dir + "files"));
+    request req;
+    req.method = "POST";
+    req.uri    = "/api/Shoes/_import";
+    req.body   = "{\"id\": \"a\", \"body\": {\"size\": 9}}\n"
+                 "\n"
+                 "{\"body\": {\"size\": 10}}\r\n"
+                 "{\"id\": \"a/b\", \"body\": {}}\n"
+                 "not json\n";
+    auto res = source.handle_request(req);
+    EXPECT_EQ(res->status_code, 200);
+    EXPECT_EQ(res->body, "{\"errors\":[{\"error\":\"invalid id\",\"line\":4},"
+                         "{\"error\":\"invalid JSON\",\"line\":5}],\"failed\":2,\"imported\":2}\n");
+
+    req.method = "GET";
+    req.uri    = "/api/Shoes/_export";
+    res = source.handle_request(req);
+    EXPECT_EQ(res->status_code, 200);
+    EXPECT_EQ(res->headers["Content-Type"], "application/x-ndjson");
+    std::string exported = read_stream(*res);
+    EXPECT_EQ(std::count(exported.begin(), exported.end(), '\n'), 2);
+    EXPECT_NE(exported.find("{\"id\": \"a\", \"body\": {\"size\":9}}\n"), std::string::npos);
+
+    CrudHandler target(std::make_shared<LogFileSystem>(tmp_dir + "log"));
+    req.method = "POST";
+    req.uri    = "/api/Shoes/_import";
+    req.body   = exported;
+    EXPECT_EQ(target.handle_request(req)->body, "{\"errors\":[],\"failed\":0,\"imported\":2}\n");
+    req.method = "GET";
+    req.uri    = "/api/Shoes/_export";
+    res = target.handle_request(req);
+    EXPECT_EQ(read_stream(*res), exported);
+}
+
+// Checks that top-level scalars, which POST accepts, survive an export and re-import
+TEST_F(CrudHandlerTest, ImportAcceptsScalarBodies) {
+    CrudHandler source(std::make_shared<FileSystem>(tmp_dir + "scalars"));
+    request req;
+    req.method = "POST";
+    req.uri    = "/api/Notes";
+    req.body   = "\"hello\"";
+    EXPECT_EQ(source.handle_request(req)->status_code, 201);
+    req.uri    = "/api/Notes/_import";
+    req.body   = "{\"id\": \"n\", \"body\": 42}\n"
+                 "{\"id\": \"z\", \"body\": null}\n";
+    EXPECT_EQ(source.handle_request(req)->body, "{\"errors\":[],\"failed\":0,\"imported\":2}\n");
+
+    req.method = "GET";
+    req.uri    = "/api/Notes/_export";
+    auto res = source.handle_request(req);
+    std::string exported = read_stream(*res);
+    EXPECT_EQ(std::count(exported.begin(), exported.end(), '\n'), 3);
+
+    CrudHandler target(std::make_shared<FileSystem>(tmp_dir + "scalars_copy"));
+    req.method = "POST";
+    req.uri    = "/api/Notes/_import";
+    req.body   = exported;
+    EXPECT_EQ(target.handle_request(req)->body, "{\"errors\":[],\"failed\":0,\"imported\":3}\n");
+    req.method = "GET";
+    req.uri    = "/api/Notes/n";
+    EXPECT_EQ(target.handle_request(req)->body, "42");
+}
+
+// Checks that exporting a type that doesn't exist is a plain 404
+TEST_F(CrudHandlerTest, ExportForUnknownEntityTypeReturns404) {
+    EXPECT_CALL(*mock_fs, list_entities("Nope"))
+        .WillOnce(Return(std::make_pair(false, std::vector<std::string>{})));
+    request req;
+    req.method = "GET";
+    req.uri    = "/api/Nope/_export";
+    auto res = handler.handle_request(req);
+    EXPECT_EQ(res->status_code, 404);
+    EXPECT_FALSE(res->body_stream);
+}
@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include "caching_file_system.h"
+#include "crud_handler.h"
+#include "entity_cache.h"
+#include "file_system.h"
+#include "request.h"
+#include "response.h"
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+// --------- Happy path tests ---------
+
+// A miss followed by an insert makes the next lookup a hit
+// Expected result: PASS
+TEST(EntityCacheTest, LookupAfterInsertHits) {
+    EntityCache cache(1 << 20);
+    std::string value;
+    uint64_t generation = 0;
+    EXPECT_FALSE(cache.lookup("Shoes", "1", value, generation));
+    cache.insert("Shoes", "1", "{\"size\": 9}", generation);
+    EXPECT_TRUE(cache.lookup("Shoes", "1", value, generation));
+    EXPECT_EQ(value, "{\"size\": 9}");
+
+    EntityCache::Stats stats = cache.stats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_GT(stats.bytes, 0u);
+}
+
+// Invalidating drops the entry
+// Expected result: PASS
+TEST(EntityCacheTest, InvalidateRemovesEntry) {
+    EntityCache cache(1 << 20);
+    std::string value;
+    uint64_t generation = 0;
+    cache.lookup("Shoes", "1", value, generation);
+    cache.insert("Shoes", "1", "old", generation);
+    cache.invalidate("Shoes", "1");
+    EXPECT_FALSE(cache.lookup("Shoes", "1", value, generation));
+    EXPECT_EQ(cache.stats().entries, 0u);
+    EXPECT_EQ(cache.stats().bytes, 0u);
+}
+
+// A body read before an invalidation is not cached, since it may predate the write
+// Expected result: PASS
+TEST(EntityCacheTest, InsertAfterInvalidateIsDropped) {
+    EntityCache cache(1 << 20);
+    std::string value;
+    uint64_t generation = 0;
+    cache.lookup("Shoes", "1", value, generation);
+    cache.invalidate("Shoes", "1");
+    cache.insert("Shoes", "1", "stale", generation);
+    EXPECT_FALSE(cache.lookup("Shoes", "1", value, generation));
+}
+
+// Staying under the budget evicts least recently used entries first
+// Expected result: PASS
+TEST(EntityCacheTest, EvictsLeastRecentlyUsedOverBudget) {
+    // Every entry lands in some shard; give each shard room for a handful of 1KB bodies
+    const size_t budget = EntityCache::kShards * 4 * 1024;
+    EntityCache cache(budget);
+    std::string body(1000, 'x');
+    for (int i = 0; i < 1000; ++i) {
+        std::string value;
+        uint64_t generation = 0;
+        cache.lookup("Cars", std::to_string(i), value, generation);
+        cache.insert("Cars", std::to_string(i), body, generation);
+    }
+    EntityCache::Stats stats = cache.stats();
+    EXPECT_LE(stats.bytes, budget);
+    EXPECT_GT(stats.evictions, 0u);
+    EXPECT_EQ(stats.entries + stats.evictions, 1000u);
+
+    // The newest entry survives
+    std::string value;
+    uint64_t generation = 0;
+    EXPECT_TRUE(cache.lookup("Cars", "999", value, generation));
+}
+
+// Bodies larger than a shard's budget are never cached
+// Expected result: PASS
+TEST(EntityCacheTest, OversizedBodyIsNotCached) {
+    EntityCache cache(EntityCache::kShards * 1024);
+    std::string value;
+    uint64_t generation = 0;
+    cache.lookup("Cars", "1", value, generation);
+    cache.insert("Cars", "1", std::string(4096, 'x'), generation);
+    EXPECT_EQ(cache.stats().entries, 0u);
+}
+
+// Sizes accept plain bytes and k/m/g suffixes
+// Expected result: PASS
+TEST(EntityCacheTest, ParsesCacheSizes) {
+    EXPECT_EQ(CrudHandler::parse_cache_size("4096"), 4096u);
+    EXPECT_EQ(CrudHandler::parse_cache_size("512k"), 512u << 10);
+    EXPECT_EQ(CrudHandler::parse_cache_size("64M"), 64u << 20);
+    EXPECT_EQ(CrudHandler::parse_cache_size("1g"), 1u << 30);
+    EXPECT_EQ(CrudHandler::parse_cache_size("0"), 0u);
+    EXPECT_THROW(CrudHandler::parse_cache_size("12q"), std::invalid_argument);
+    EXPECT_THROW(CrudHandler::parse_cache_size("big"), std::invalid_argument);
+    EXPECT_THROW(CrudHandler::parse_cache_size("-1"), std::invalid_argument);
+    EXPECT_THROW(CrudHandler::parse_cache_size(" 64m"), std::invalid_argument);
+}
+
+// Fixture wiring a CrudHandler to a cached FileSystem
+class CachedCrudTest : public ::testing::Test {
+protected:
+    const std::string data_path = "/tmp/entity_cache_test";
+
+    void SetUp() override {
+        fs::remove_all(data_path);
+        fs::create_directories(data_path);
+    }
+
+    void TearDown() override {
+        fs::remove_all(data_path);
+    }
+
+    std::unique_ptr<response> send(RequestHandler& handler, const std::string& method,
+                                   const std::string& uri, const std::string& body = "") {
+        request req;
+        req.method = method;
+        req.uri = uri;
+        req.body = body;
+        return handler.handle_request(req);
+    }
+};
+
+// Repeated GETs are served from the cache; PUT and DELETE invalidate it
+// Expected result: PASS
+TEST_F(CachedCrudTest, GetHitsUntilWriteInvalidates) {
+    auto store = std::make_shared<FileSystem>(data_path);
+    CrudHandler handler(std::make_shared<CachingFileSystem>(store, std::make_shared<EntityCache>(1 << 20)));
+
+    auto created = send(handler, "PUT", "/api/Shoes/1", "{\"size\": 9}");
+    ASSERT_EQ(created->status_code, 201);
+
+    auto first = send(handler, "GET", "/api/Shoes/1");
+    EXPECT_EQ(first->headers["X-Cache"], "MISS");
+    auto second = send(handler, "GET", "/api/Shoes/1");
+    EXPECT_EQ(second->headers["X-Cache"], "HIT");
+    EXPECT_EQ(second->body, "{\"size\": 9}");
+
+    // Change the file behind the cache's back: a hit proves the disk wasn't read
+    store->write_entity("Shoes", "1", "{\"size\": 0}");
+    EXPECT_EQ(send(handler, "GET", "/api/Shoes/1")->body, "{\"size\": 9}");
+
+    send(handler, "PUT", "/api/Shoes/1", "{\"size\": 10}");
+    auto updated = send(handler, "GET", "/api/Shoes/1");
+    EXPECT_EQ(updated->headers["X-Cache"], "MISS");
+    EXPECT_EQ(updated->body, "{\"size\": 10}");
+
+    send(handler, "DELETE", "/api/Shoes/1");
+    EXPECT_EQ(send(handler, "GET", "/api/Shoes/1")->status_code, 404);
+}
+
+// Handlers built from config for the same data path share one cache
+// Expected result: PASS
+TEST_F(CachedCrudTest, HandlersFromConfigShareCache) {
+    std::unordered_map<std::string, std::string> args = {
+        {"data_path", data_path}, {"entity_cache", "1m"}};
+    auto writer = CrudHandler::create(args);
+    auto reader = CrudHandler::create(args);
+
+    send(*writer, "PUT", "/api/Cars/7", "{\"wheels\": 4}");
+    send(*reader, "GET", "/api/Cars/7");
+    EXPECT_EQ(send(*reader, "GET", "/api/Cars/7")->headers["X-Cache"], "HIT");
+
+    // A write through another handler invalidates what the reader sees
+    send(*writer, "PUT", "/api/Cars/7", "{\"wheels\": 3}");
+    auto res = send(*reader, "GET", "/api/Cars/7");
+    EXPECT_EQ(res->headers["X-Cache"], "MISS");
+    EXPECT_EQ(res->body, "{\"wheels\": 3}");
+}
+
+// Without the directive there is no cache and no X-Cache header
+// Expected result: PASS
+TEST_F(CachedCrudTest, NoCacheByDefault) {
+    auto handler = CrudHandler::create({{"data_path", data_path}});
+    send(*handler, "PUT", "/api/Cars/7", "{\"wheels\": 4}");
+    auto res = send(*handler, "GET", "/api/Cars/7");
+    EXPECT_EQ(res->status_code, 200);
+    EXPECT_EQ(res->headers.count("X-Cache"), 0u);
+}
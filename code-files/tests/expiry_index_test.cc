@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+#include "crud_handler.h"
+#include "expiry_index.h"
+#include "file_system.h"
+#include "request.h"
+#include "response.h"
+#include <filesystem>
+#include <future>
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+class ExpiryIndexTest : public ::testing::Test {
+protected:
+    const std::string data_path = "/tmp/expiry_index_test";
+    const ExpiryIndex::Clock::time_point now = ExpiryIndex::Clock::now();
+
+    void SetUp() override {
+        fs::remove_all(data_path);
+        fs::create_directories(data_path);
+    }
+
+    void TearDown() override {
+        fs::remove_all(data_path);
+    }
+
+    void put(FileSystemInterface& store, const std::string& id) {
+        bool created = false;
+        ASSERT_TRUE(store.put_entity("Sessions", id, "{}", created));
+    }
+};
+
+// --------- Happy path tests ---------
+
+// Entities are expired once their deadline passes, until it's moved or cleared
+// Expected result: PASS
+TEST_F(ExpiryIndexTest, ExpiredFollowsDeadlines) {
+    ExpiryIndex index;
+    EXPECT_FALSE(index.expired("Sessions", "a", now));
+    index.set("Sessions", "a", now + 10s);
+    EXPECT_FALSE(index.expired("Sessions", "a", now));
+    EXPECT_TRUE(index.expired("Sessions", "a", now + 10s));
+    index.set("Sessions", "a", now + 20s);
+    EXPECT_FALSE(index.expired("Sessions", "a", now + 10s));
+    index.clear("Sessions", "a");
+    EXPECT_FALSE(index.expired("Sessions", "a", now + 1h));
+    EXPECT_EQ(index.size(), 0u);
+}
+
+// reap() deletes only expired entities and reports each one
+// Expected result: PASS
+TEST_F(ExpiryIndexTest, ReapDeletesExpiredEntities) {
+    FileSystem store(data_path);
+    put(store, "old");
+    put(store, "new");
+    ExpiryIndex index;
+    index.set("Sessions", "old", now - 1s);
+    index.set("Sessions", "new", now + 1h);
+
+    std::vector<std::string> reaped;
+    EXPECT_EQ(index.reap(store, [&reaped](const std::string&, const std::string& id) { reaped.push_back(id); }, now), 1u);
+    EXPECT_EQ(reaped, std::vector<std::string>{"old"});
+    EXPECT_FALSE(store.exists("Sessions", "old"));
+    EXPECT_TRUE(store.exists("Sessions", "new"));
+    EXPECT_EQ(index.size(), 1u);
+}
+
+// Deadlines are journaled, so a reopened index still knows them
+// Expected result: PASS
+TEST_F(ExpiryIndexTest, JournalSurvivesReopen) {
+    const std::string journal = data_path + "/.expiry";
+    {
+        ExpiryIndex index(journal);
+        index.set("Sessions", "a", now + 1h);
+        index.set("Sessions", "b", now + 1h);
+        index.set("Sessions", "a", now - 1s);
+        index.clear("Sessions", "b");
+    }
+    ExpiryIndex reopened(journal);
+    EXPECT_EQ(reopened.size(), 1u);
+    EXPECT_TRUE(reopened.expired("Sessions", "a", now));
+}
+
+// The reaper thread deletes an entity shortly after its deadline
+// Expected result: PASS
+TEST_F(ExpiryIndexTest, ReaperDeletesInBackground) {
+    auto store = std::make_shared<FileSystem>(data_path);
+    put(*store, "a");
+    ExpiryIndex index;
+    std::promise<std::string> reaped;
+    index.start_reaper(store, [&reaped](const std::string&, const std::string& id) { reaped.set_value(id); });
+    index.set("Sessions", "a", ExpiryIndex::Clock::now() + 50ms);
+
+    auto result = reaped.get_future();
+    ASSERT_EQ(result.wait_for(2s), std::future_status::ready);
+    EXPECT_EQ(result.get(), "a");
+    EXPECT_FALSE(store->exists("Sessions", "a"));
+}
+
+// A CrudHandler records X-TTL, hides expired entities and renews on PUT
+// Expected result: PASS
+TEST_F(ExpiryIndexTest, CrudHandlerExpiresEntities) {
+    auto handler = CrudHandler::create({{"data_path", data_path}});
+    auto index = ExpiryIndex::shared(data_path);
+    request req;
+    req.method = "PUT";
+    req.uri = "/api/Sessions/s1";
+    req.body = "{\"user\": \"joe\"}";
+    req.headers["X-TTL"] = "3600";
+    EXPECT_EQ(handler->handle_request(req)->status_code, 201);
+    EXPECT_FALSE(index->expired("Sessions", "s1"));
+    EXPECT_TRUE(index->expired("Sessions", "s1", ExpiryIndex::Clock::now() + 2h));
+
+    // Expired but not reaped yet: reads see it as gone, and a PUT brings it back as new
+    index->set("Sessions", "s1", ExpiryIndex::Clock::now() - 1s);
+    req.method = "GET";
+    EXPECT_EQ(handler->handle_request(req)->status_code, 404);
+    req.method = "PATCH";
+    EXPECT_EQ(handler->handle_request(req)->status_code, 404);
+    req.method = "PUT";
+    req.headers.clear();
+    EXPECT_EQ(handler->handle_request(req)->status_code, 201);
+    req.method = "GET";
+    EXPECT_EQ(handler->handle_request(req)->status_code, 200);
+    EXPECT_EQ(index->size(), 0u);
+}
+
+// Listings, field queries, export and the change feed leave out expired entities too,
+// and deleting one is a 404
+// Expected result: PASS
+TEST_F(ExpiryIndexTest, CrudHandlerHidesExpiredEntitiesEverywhere) {
+    const std::string path = data_path + "/hidden";
+    auto handler = CrudHandler::create({{"data_path", path}, {"index", "user"}});
+    auto index = ExpiryIndex::shared(path);
+    request req;
+    req.method = "PUT";
+    req.body = "{\"user\": \"joe\"}";
+    for (const std::string id : {"s1", "s2"}) {
+        req.uri = "/api/Sessions/" + id;
+        EXPECT_EQ(handler->handle_request(req)->status_code, 201);
+    }
+    index->set("Sessions", "s1", ExpiryIndex::Clock::now() - 1s);
+
+    req.method = "GET";
+    req.body.clear();
+    for (const std::string uri : {"/api/Sessions", "/api/Sessions?limit=10", "/api/Sessions?user=joe"}) {
+        req.uri = uri;
+        std::string body = handler->handle_request(req)->body;
+        EXPECT_EQ(body.find("s1"), std::string::npos) << uri;
+        EXPECT_NE(body.find("s2"), std::string::npos) << uri;
+    }
+    req.uri = "/api/Sessions?stream=true";
+    auto res = handler->handle_request(req);
+    std::string streamed;
+    std::string chunk;
+    while (res->body_stream(chunk)) {
+        streamed += chunk;
+    }
+    EXPECT_EQ(streamed, "[\"s2\"]\n");
+    req.uri = "/api/Sessions/_export";
+    res = handler->handle_request(req);
+    std::string exported;
+    while (res->body_stream(chunk)) {
+        exported += chunk;
+    }
+    EXPECT_EQ(exported.find("s1"), std::string::npos);
+    req.uri = "/api/Sessions/_changes";
+    EXPECT_NE(handler->handle_request(req)->body.find("\"id\": \"s1\", \"deleted\": true"), std::string::npos);
+
+    // Deleting it is a 404, but it's gone afterwards either way
+    req.method = "DELETE";
+    req.uri = "/api/Sessions/s1";
+    EXPECT_EQ(handler->handle_request(req)->status_code, 404);
+    EXPECT_FALSE(fs::exists(path + "/Sessions/s1"));
+    EXPECT_EQ(index->size(), 0u);
+}
+
+// Locations that never use a TTL don't write a journal, and memory storage doesn't touch the disk
+// Expected result: PASS
+TEST_F(ExpiryIndexTest, NoJournalWithoutDeadlines) {
+    ExpiryIndex index(data_path + "/.expiry");
+    EXPECT_FALSE(index.expired("Sessions", "a", now));
+    EXPECT_FALSE(fs::exists(data_path + "/.expiry"));
+    index.set("Sessions", "a", now + 1h);
+    EXPECT_TRUE(fs::exists(data_path + "/.expiry"));
+
+    const std::string memory_path = data_path + "/memory";
+    auto handler = CrudHandler::create({{"data_path", memory_path}, {"storage", "memory"}});
+    request req;
+    req.method = "PUT";
+    req.uri = "/api/Sessions/a";
+    req.body = "{}";
+    req.headers["X-TTL"] = "60";
+    EXPECT_EQ(handler->handle_request(req)->status_code, 201);
+    EXPECT_FALSE(fs::exists(memory_path));
+}
+
+// --------- Unhappy path tests ---------
+
+// A deadline for an entity that's already gone is dropped without a delete
+// Expected result: FAIL
+TEST_F(ExpiryIndexTest, ReapDropsMissingEntities) {
+    FileSystem store(data_path);
+    ExpiryIndex index;
+    index.set("Sessions", "gone", now - 1s);
+    EXPECT_EQ(index.reap(store, nullptr, now), 0u);
+    EXPECT_EQ(index.size(), 0u);
+}
+
+// An X-TTL that isn't a number of seconds is a 400
+// Expected result: FAIL
+TEST_F(ExpiryIndexTest, CrudHandlerRejectsBadTtl) {
+    auto handler = CrudHandler::create({{"data_path", data_path}});
+    request req;
+    req.method = "POST";
+    req.uri = "/api/Sessions";
+    req.body = "{}";
+    req.headers["X-TTL"] = "soon";
+    EXPECT_EQ(handler->handle_request(req)->status_code, 400);
+}
@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include "crud_handler.h"
+#include "field_index.h"
+#include "file_system.h"
+#include "log_file_system.h"
+#include "request.h"
+#include "response.h"
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+class FieldIndexTest : public ::testing::Test {
+protected:
+    const std::string data_path = "/tmp/field_index_test";
+
+    void SetUp() override {
+        fs::remove_all(data_path);
+        fs::create_directories(data_path);
+    }
+
+    void TearDown() override {
+        fs::remove_all(data_path);
+    }
+
+    // Writes an entity under a chosen id, creating its type directory if needed
+    void put(FileSystemInterface& store, const std::string& id, const std::string& data) {
+        bool created = false;
+        ASSERT_TRUE(store.put_entity("Products", id, data, created));
+    }
+
+    std::vector<std::string> find(FieldIndex& index, const FileSystemInterface& store,
+                                  const std::map<std::string, std::string>& filters) {
+        std::vector<std::string> ids;
+        EXPECT_TRUE(index.find("Products", filters, ids, store));
+        return ids;
+    }
+};
+
+// --------- Happy path tests ---------
+
+// Entities already in storage are found once the type is loaded
+// Expected result: PASS
+TEST_F(FieldIndexTest, LoadsExistingEntities) {
+    FileSystem store(data_path);
+    put(store, "1", "{\"name\": \"Mouse\", \"price\": 10}");
+    put(store, "2", "{\"name\": \"Keyboard\", \"price\": 10}");
+    put(store, "3", "{\"name\": \"Mouse\", \"price\": 25}");
+
+    FieldIndex index({"name", "price"});
+    EXPECT_EQ(find(index, store, {{"name", "Mouse"}}), (std::vector<std::string>{"1", "3"}));
+    EXPECT_EQ(find(index, store, {{"price", "10"}}), (std::vector<std::string>{"1", "2"}));
+    EXPECT_EQ(find(index, store, {{"name", "Mouse"}, {"price", "10"}}), (std::vector<std::string>{"1"}));
+    EXPECT_TRUE(find(index, store, {{"name", "Monitor"}}).empty());
+}
+
+// refresh() follows updates and deletes
+// Expected result: PASS
+TEST_F(FieldIndexTest, RefreshTracksWrites) {
+    FileSystem store(data_path);
+    put(store, "1", "{\"name\": \"Mouse\"}");
+    FieldIndex index({"name"});
+    EXPECT_EQ(find(index, store, {{"name", "Mouse"}}).size(), 1u);
+
+    put(store, "2", "{\"name\": \"Mouse\"}");
+    index.refresh("Products", "2", store);
+    put(store, "1", "{\"name\": \"Trackpad\"}");
+    index.refresh("Products", "1", store);
+    EXPECT_EQ(find(index, store, {{"name", "Mouse"}}), (std::vector<std::string>{"2"}));
+    EXPECT_EQ(find(index, store, {{"name", "Trackpad"}}), (std::vector<std::string>{"1"}));
+
+    store.delete_entity("Products", "2");
+    index.refresh("Products", "2", store);
+    EXPECT_TRUE(find(index, store, {{"name", "Mouse"}}).empty());
+}
+
+// warm() builds every type the log holds, so a restart starts with complete indexes
+// Expected result: PASS
+TEST_F(FieldIndexTest, WarmRebuildsFromLog) {
+    {
+        LogFileSystem store(data_path);
+        put(store, "1", "{\"name\": \"Mouse\"}");
+        bool created = false;
+        store.put_entity("Users", "1", "{\"name\": \"Mouse\"}", created);
+    }
+    LogFileSystem reopened(data_path);
+    EXPECT_EQ(reopened.list_entity_types().size(), 2u);
+
+    FieldIndex index({"name"});
+    index.warm(reopened);
+    // Changes after the warm-up are only seen through refresh
+    put(reopened, "2", "{\"name\": \"Mouse\"}");
+    EXPECT_EQ(find(index, reopened, {{"name", "Mouse"}}), (std::vector<std::string>{"1"}));
+    index.refresh("Products", "2", reopened);
+    EXPECT_EQ(find(index, reopened, {{"name", "Mouse"}}), (std::vector<std::string>{"1", "2"}));
+}
+
+// Directive values split on commas or spaces, without duplicates
+// Expected result: PASS
+TEST_F(FieldIndexTest, ParseFields) {
+    EXPECT_EQ(FieldIndex::parse_fields("name,price name"), (std::vector<std::string>{"name", "price"}));
+    EXPECT_TRUE(FieldIndex::parse_fields(" , ").empty());
+}
+
+// A CrudHandler with an index answers field queries and keeps them current
+// Expected result: PASS
+TEST_F(FieldIndexTest, CrudHandlerFiltersByField) {
+    auto handler = CrudHandler::create({{"data_path", data_path}, {"index", "name"}});
+    request req;
+    req.method = "PUT";
+    req.uri = "/api/Products/a";
+    req.body = "{\"name\": \"Mouse\"}";
+    EXPECT_EQ(handler->handle_request(req)->status_code, 201);
+    req.uri = "/api/Products/b";
+    req.body = "{\"name\": \"Desk Lamp\"}";
+    EXPECT_EQ(handler->handle_request(req)->status_code, 201);
+
+    req.method = "GET";
+    req.body.clear();
+    req.uri = "/api/Products?name=Mouse";
+    auto res = handler->handle_request(req);
+    EXPECT_EQ(res->status_code, 200);
+    EXPECT_EQ(res->body, "[\"a\"]\n");
+    req.uri = "/api/Products?name=Desk%20Lamp";
+    EXPECT_EQ(handler->handle_request(req)->body, "[\"b\"]\n");
+
+    req.method = "DELETE";
+    req.uri = "/api/Products/a";
+    EXPECT_EQ(handler->handle_request(req)->status_code, 200);
+    req.method = "GET";
+    req.uri = "/api/Products?name=Mouse";
+    EXPECT_EQ(handler->handle_request(req)->body, "[]\n");
+}
+
+// Numbers match however they are spelled, in the body or the query
+// Expected result: PASS
+TEST_F(FieldIndexTest, NumbersMatchAcrossSpellings) {
+    FileSystem store(data_path);
+    put(store, "1", "{\"price\": 10.0}");
+    put(store, "2", "{\"price\": 10}");
+    put(store, "3", "{\"price\": \"10\"}");
+    put(store, "4", "{\"price\": 10.5}");
+    put(store, "5", "{\"price\": \"ten\"}");
+
+    FieldIndex index({"price"});
+    EXPECT_EQ(find(index, store, {{"price", "10"}}), (std::vector<std::string>{"1", "2", "3"}));
+    EXPECT_EQ(find(index, store, {{"price", "1e1"}}), (std::vector<std::string>{"1", "2", "3"}));
+    EXPECT_EQ(find(index, store, {{"price", "10.50"}}), (std::vector<std::string>{"4"}));
+    EXPECT_EQ(find(index, store, {{"price", "ten"}}), (std::vector<std::string>{"5"}));
+}
+
+// Query parameters that aren't indexed fields don't filter the listing
+// Expected result: PASS
+TEST_F(FieldIndexTest, CrudHandlerIgnoresUnindexedParameters) {
+    auto handler = CrudHandler::create({{"data_path", data_path + "/unindexed"}});
+    request req;
+    req.method = "PUT";
+    req.uri = "/api/Products/a";
+    req.body = "{\"color\": \"blue\"}";
+    EXPECT_EQ(handler->handle_request(req)->status_code, 201);
+    req.method = "GET";
+    req.body.clear();
+    req.uri = "/api/Products?color=red&_=12345";
+    auto res = handler->handle_request(req);
+    EXPECT_EQ(res->status_code, 200);
+    EXPECT_NE(res->body.find("\"a\""), std::string::npos);
+}
+
+// --------- Unhappy path tests ---------
+
+// Querying a type that doesn't exist is a 404, as for plain listings
+// Expected result: FAIL
+TEST_F(FieldIndexTest, UnknownTypeNotFound) {
+    FileSystem store(data_path);
+    FieldIndex index({"name"});
+    std::vector<std::string> ids;
+    EXPECT_FALSE(index.find("Nope", {{"name", "x"}}, ids, store));
+}
@@ -0,0 +1,493 @@
+#include <gtest/gtest.h>
+#include "file_system.h"
+#include "log_file_system.h"
+#include "memory_file_system.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Fixture giving each test an empty data directory
+class FileSystemTest : public ::testing::Test {
+protected:
+    const std::string data_path = "/tmp/file_system_test";
+
+    void SetUp() override {
+        fs::remove_all(data_path);
+        fs::create_directories(data_path);
+    }
+
+    void TearDown() override {
+        fs::remove_all(data_path);
+    }
+};
+
+// --------- Happy path tests ---------
+
+// Durable writes replace the entity atomically and leave no temp files behind
+// Expected result: PASS
+TEST_F(FileSystemTest, DurableWriteReplacesEntity) {
+    FileSystem store(data_path, GroupCommit::for_directory(data_path, std::chrono::microseconds(0)));
+    auto [created, id] = store.create_entity("Shoes");
+    ASSERT_TRUE(created);
+    EXPECT_TRUE(store.write_entity("Shoes", id, "{\"size\": 9}"));
+    EXPECT_TRUE(store.write_entity("Shoes", id, "{\"size\": 10}"));
+    EXPECT_EQ(store.read_entity("Shoes", id).second, "{\"size\": 10}");
+    EXPECT_TRUE(fs::is_empty(fs::path(data_path) / ".tmp"));
+    EXPECT_EQ(store.list_entities("Shoes").second, std::vector<std::string>{id});
+    EXPECT_TRUE(store.delete_entity("Shoes", id));
+    EXPECT_FALSE(store.exists("Shoes", id));
+}
+
+// Concurrent durable writers share group commits
+// Expected result: PASS
+TEST_F(FileSystemTest, ConcurrentDurableWritesShareFlushes) {
+    // Own directory so the process-wide group commit is created with this window
+    std::string path = data_path + "/concurrent";
+    fs::create_directories(path);
+    auto commit = GroupCommit::for_directory(path, std::chrono::milliseconds(2));
+    FileSystem store(path, commit);
+    std::vector<std::string> ids;
+    for (int i = 0; i < 8; ++i) {
+        ids.push_back(store.create_entity("Cars").second);
+    }
+    GroupCommit::Stats before = commit->stats();
+
+    std::vector<std::thread> writers;
+    for (const auto& id : ids) {
+        writers.emplace_back([&store, id]() {
+            EXPECT_TRUE(store.write_entity("Cars", id, "{\"id\": \"" + id + "\"}"));
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    GroupCommit::Stats after = commit->stats();
+    EXPECT_EQ(after.requests - before.requests, 16u); // data flush + rename flush per write
+    EXPECT_LT(after.flushes - before.flushes, 16u);
+    for (const auto& id : ids) {
+        EXPECT_EQ(store.read_entity("Cars", id).second, "{\"id\": \"" + id + "\"}");
+    }
+}
+
+// PUT creates an entity under the given id and reports whether it existed
+// Expected result: PASS
+TEST_F(FileSystemTest, PutCreatesThenOverwrites) {
+    FileSystem store(data_path);
+    bool created = false;
+    EXPECT_TRUE(store.put_entity("Shoes", "abc", "{\"v\": 1}", created));
+    EXPECT_TRUE(created);
+    EXPECT_TRUE(store.put_entity("Shoes", "abc", "{\"v\": 2}", created));
+    EXPECT_FALSE(created);
+    EXPECT_EQ(store.read_entity("Shoes", "abc").second, "{\"v\": 2}");
+}
+
+// Many threads PUT, GET and DELETE the same few ids. Each value is internally
+// consistent (a writer tag repeated to a fixed length), so a torn or interleaved
+// write shows up as a mixed or short value.
+void hammer(FileSystemInterface& store) {
+    const int kThreads = 12;
+    const int kIterations = 400;
+    const std::vector<std::string> ids = {"hot-1", "hot-2", "hot-3"};
+    const size_t kValueSize = 2048;
+    std::atomic<int> bad_reads{0};
+    std::atomic<int> bad_puts{0};
+
+    auto value_for = [kValueSize](int writer) { return std::string(kValueSize, static_cast<char>('a' + writer)); };
+    auto consistent = [kValueSize](const std::string& value) {
+        return value.size() == kValueSize && value.find_first_not_of(value[0]) == std::string::npos;
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < kIterations; ++i) {
+                const std::string& id = ids[(t + i) % ids.size()];
+                switch ((t * 7 + i) % 4) {
+                    case 0:
+                    case 1: {
+                        bool created = false;
+                        if (!store.put_entity("Hot", id, value_for(t), created)) {
+                            ++bad_puts;
+                        }
+                        break;
+                    }
+                    case 2: {
+                        auto [found, value] = store.read_entity("Hot", id);
+                        if (found && !consistent(value)) {
+                            ++bad_reads;
+                        }
+                        break;
+                    }
+                    case 3:
+                        store.delete_entity("Hot", id);
+                        break;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(bad_puts.load(), 0);
+    EXPECT_EQ(bad_reads.load(), 0);
+    for (const auto& id : ids) {
+        auto [found, value] = store.read_entity("Hot", id);
+        EXPECT_EQ(found, store.exists("Hot", id));
+        if (found) {
+            EXPECT_TRUE(consistent(value)) << id;
+        }
+    }
+}
+
+// Concurrent access to the same ids never exposes a partial entity (file backend)
+// Expected result: PASS
+TEST_F(FileSystemTest, ConcurrentAccessStaysConsistent) {
+    FileSystem store(data_path);
+    hammer(store);
+}
+
+// Concurrent access to the same ids never exposes a partial entity (log backend)
+// Expected result: PASS
+TEST_F(FileSystemTest, ConcurrentLogAccessStaysConsistent) {
+    LogFileSystem store(data_path + "/log");
+    hammer(store);
+}
+
+// Concurrent access to the same ids never exposes a partial entity (memory backend)
+// Expected result: PASS
+TEST_F(FileSystemTest, ConcurrentMemoryAccessStaysConsistent) {
+    MemoryFileSystem store(data_path);
+    hammer(store);
+}
+
+// The sharded layout stores entities two hashed directories down and lists them all
+// Expected result: PASS
+TEST_F(FileSystemTest, ShardedLayoutStoresEntitiesInHashedDirectories) {
+    FileSystem store(data_path, nullptr, FileSystem::Layout::kSharded);
+    auto [created, id] = store.create_entity("Shoes");
+    ASSERT_TRUE(created);
+    EXPECT_TRUE(store.write_entity("Shoes", id, "{\"size\": 9}"));
+    EXPECT_TRUE(fs::is_regular_file(fs::path(data_path) / "Shoes" / FileSystem::shard_dir(id) / id));
+    EXPECT_FALSE(fs::exists(fs::path(data_path) / "Shoes" / id));
+
+    bool put_created = false;
+    EXPECT_TRUE(store.put_entity("Shoes", "custom", "{}", put_created));
+    EXPECT_TRUE(put_created);
+    EXPECT_TRUE(store.exists("Shoes", "custom"));
+    EXPECT_EQ(store.read_entity("Shoes", id).second, "{\"size\": 9}");
+
+    auto [listed, ids] = store.list_entities("Shoes");
+    EXPECT_TRUE(listed);
+    std::sort(ids.begin(), ids.end());
+    std::vector<std::string> expected = {id, "custom"};
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(ids, expected);
+
+    EXPECT_TRUE(store.delete_entity("Shoes", id));
+    EXPECT_FALSE(store.exists("Shoes", id));
+}
+
+// Shard directories are stable two-level hex paths
+// Expected result: PASS
+TEST_F(FileSystemTest, ShardDirIsStable) {
+    std::string dir = FileSystem::shard_dir("0d3b1c2a-1111-4222-8333-944455556666");
+    EXPECT_EQ(dir.size(), 5u);
+    EXPECT_EQ(dir[2], '/');
+    EXPECT_EQ(dir, FileSystem::shard_dir("0d3b1c2a-1111-4222-8333-944455556666"));
+    EXPECT_NE(FileSystem::shard_dir("a"), FileSystem::shard_dir("b"));
+}
+
+// Migrating flat data to sharded and back keeps every entity readable, and rerunning is a no-op
+// Expected result: PASS
+TEST_F(FileSystemTest, MigrateBetweenLayouts) {
+    std::vector<std::string> ids;
+    {
+        FileSystem flat(data_path);
+        for (int i = 0; i < 50; ++i) {
+            auto [created, id] = flat.create_entity(i % 2 ? "Cars" : "Shoes");
+            flat.write_entity(i % 2 ? "Cars" : "Shoes", id, std::to_string(i));
+            ids.push_back(id);
+        }
+    }
+
+    EXPECT_EQ(FileSystem::migrate(data_path, FileSystem::Layout::kSharded), 50u);
+    EXPECT_EQ(FileSystem::migrate(data_path, FileSystem::Layout::kSharded), 0u);
+    {
+        FileSystem sharded(data_path, nullptr, FileSystem::Layout::kSharded);
+        for (int i = 0; i < 50; ++i) {
+            EXPECT_EQ(sharded.read_entity(i % 2 ? "Cars" : "Shoes", ids[i]).second, std::to_string(i));
+        }
+        EXPECT_EQ(sharded.list_entities("Cars").second.size(), 25u);
+    }
+
+    EXPECT_EQ(FileSystem::migrate(data_path, FileSystem::Layout::kFlat), 50u);
+    FileSystem flat(data_path);
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_EQ(flat.read_entity(i % 2 ? "Cars" : "Shoes", ids[i]).second, std::to_string(i));
+    }
+    // No shard directories are left behind
+    for (const auto& entry : fs::directory_iterator(fs::path(data_path) / "Shoes")) {
+        EXPECT_TRUE(entry.is_regular_file()) << entry.path();
+    }
+}
+
+// Ids that equal a shard directory name survive migrating in both directions
+// Expected result: PASS
+TEST_F(FileSystemTest, MigrateIdsNamedLikeShardDirectories) {
+    std::vector<std::string> ids;
+    {
+        FileSystem flat(data_path);
+        for (const std::string id : {"alpha", "beta", "gamma"}) {
+            bool created = false;
+            std::string dir = FileSystem::shard_dir(id).substr(0, 2);
+            ASSERT_TRUE(flat.put_entity("Cars", id, id, created));
+            ASSERT_TRUE(flat.put_entity("Cars", dir, dir, created));
+            ids.push_back(id);
+            ids.push_back(dir);
+        }
+    }
+
+    EXPECT_EQ(FileSystem::migrate(data_path, FileSystem::Layout::kSharded), ids.size());
+    {
+        FileSystem sharded(data_path, nullptr, FileSystem::Layout::kSharded);
+        for (const auto& id : ids) {
+            EXPECT_EQ(sharded.read_entity("Cars", id).second, id);
+        }
+    }
+
+    EXPECT_EQ(FileSystem::migrate(data_path, FileSystem::Layout::kFlat), ids.size());
+    FileSystem flat(data_path);
+    for (const auto& id : ids) {
+        EXPECT_EQ(flat.read_entity("Cars", id).second, id);
+    }
+    EXPECT_EQ(flat.list_entities("Cars").second.size(), ids.size());
+}
+
+// Pages through a type in id order, picking up creates and deletes after the first page
+void page_through(FileSystemInterface& store) {
+    std::vector<std::string> created;
+    for (int i = 0; i < 25; ++i) {
+        bool is_new = false;
+        std::string id = "id" + std::to_string(100 + i);
+        ASSERT_TRUE(store.put_entity("Pages", id, "{}", is_new));
+        created.push_back(id);
+    }
+    std::vector<std::string> page;
+    bool more = false;
+    ASSERT_TRUE(store.list_entities_page("Pages", "", 10, page, more));
+    EXPECT_EQ(page, std::vector<std::string>(created.begin(), created.begin() + 10));
+    EXPECT_TRUE(more);
+
+    // Changes after the index is built show up in later pages
+    store.delete_entity("Pages", "id111");
+    bool is_new = false;
+    store.put_entity("Pages", "id999", "{}", is_new);
+
+    ASSERT_TRUE(store.list_entities_page("Pages", page.back(), 10, page, more));
+    EXPECT_EQ(page.front(), "id110");
+    EXPECT_EQ(page[1], "id112");
+    ASSERT_TRUE(store.list_entities_page("Pages", page.back(), 10, page, more));
+    EXPECT_EQ(page.back(), "id999");
+    EXPECT_FALSE(more);
+
+    EXPECT_FALSE(store.list_entities_page("Missing", "", 10, page, more));
+}
+
+// Paged listing over the file backend's sorted index
+// Expected result: PASS
+TEST_F(FileSystemTest, ListEntitiesPageFile) {
+    FileSystem store(data_path + "/paged");
+    page_through(store);
+}
+
+// Paged listing over the log backend's ordered index
+// Expected result: PASS
+TEST_F(FileSystemTest, ListEntitiesPageLog) {
+    LogFileSystem store(data_path + "/paged_log");
+    page_through(store);
+}
+
+// Paged listing over the memory backend's sorted id sets
+// Expected result: PASS
+TEST_F(FileSystemTest, ListEntitiesPageMemory) {
+    MemoryFileSystem store(data_path);
+    page_through(store);
+}
+
+// Runs a mixed batch and checks each operation saw the ones before it
+void run_batch(FileSystemInterface& store) {
+    bool created = false;
+    ASSERT_TRUE(store.put_entity("Batch", "existing", "{\"v\": 0}", created));
+    std::vector<BatchOp> ops(5);
+    ops[0] = {BatchOp::kCreate, "Batch", "", "{\"v\": 1}"};
+    ops[1] = {BatchOp::kPut, "Batch", "existing", "{\"v\": 2}"};
+    ops[2] = {BatchOp::kGet, "Batch", "existing", ""};
+    ops[3] = {BatchOp::kDelete, "Batch", "existing", ""};
+    ops[4] = {BatchOp::kGet, "Batch", "existing", ""};
+    ASSERT_TRUE(store.apply_batch(ops));
+
+    EXPECT_TRUE(ops[0].ok);
+    EXPECT_FALSE(ops[0].id.empty());
+    EXPECT_EQ(store.read_entity("Batch", ops[0].id).second, "{\"v\": 1}");
+    EXPECT_TRUE(ops[1].ok);
+    EXPECT_FALSE(ops[1].created);
+    EXPECT_EQ(ops[2].data, "{\"v\": 2}");
+    EXPECT_TRUE(ops[3].ok);
+    EXPECT_FALSE(ops[4].ok);
+    EXPECT_FALSE(store.exists("Batch", "existing"));
+}
+
+// Batches on the file backend, plain and durable
+// Expected result: PASS
+TEST_F(FileSystemTest, ApplyBatchFile) {
+    FileSystem plain(data_path + "/batch");
+    run_batch(plain);
+    std::string durable_path = data_path + "/batch_durable";
+    fs::create_directories(durable_path);
+    auto commit = GroupCommit::for_directory(durable_path, std::chrono::microseconds(0));
+    FileSystem durable(durable_path, commit);
+    GroupCommit::Stats before = commit->stats();
+    run_batch(durable);
+    // put_entity in run_batch flushes twice, the batch itself twice more
+    EXPECT_EQ(commit->stats().requests - before.requests, 4u);
+    EXPECT_TRUE(fs::is_empty(fs::path(durable_path) / ".tmp"));
+}
+
+// Batches on the log backend
+// Expected result: PASS
+TEST_F(FileSystemTest, ApplyBatchLog) {
+    LogFileSystem store(data_path + "/batch_log");
+    run_batch(store);
+}
+
+// Batches on the memory backend
+// Expected result: PASS
+TEST_F(FileSystemTest, ApplyBatchMemory) {
+    MemoryFileSystem store(data_path);
+    run_batch(store);
+}
+
+// Concurrent read-modify-write updates of one entity never lose an increment
+void increment_concurrently(FileSystemInterface& store) {
+    bool created = false;
+    ASSERT_TRUE(store.put_entity("Counter", "c", "0", created));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&store]() {
+            for (int i = 0; i < 100; ++i) {
+                bool found = false;
+                store.update_entity("Counter", "c", [](std::string& data) {
+                    data = std::to_string(std::stoi(data) + 1);
+                    return true;
+                }, found);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(store.read_entity("Counter", "c").second, "800");
+
+    // A declined mutation and a missing entity both leave storage alone
+    bool found = false;
+    EXPECT_FALSE(store.update_entity("Counter", "c", [](std::string& data) { data = "x"; return false; }, found));
+    EXPECT_TRUE(found);
+    EXPECT_EQ(store.read_entity("Counter", "c").second, "800");
+    EXPECT_FALSE(store.update_entity("Counter", "missing", [](std::string&) { return true; }, found));
+    EXPECT_FALSE(found);
+
+    // A compare-and-delete only removes the contents it was checked against
+    EXPECT_FALSE(store.delete_entity_if("Counter", "c", [](const std::string& data) { return data == "799"; }, found));
+    EXPECT_TRUE(found);
+    EXPECT_TRUE(store.delete_entity_if("Counter", "c", [](const std::string& data) { return data == "800"; }, found));
+    EXPECT_FALSE(store.exists("Counter", "c"));
+}
+
+// Atomic updates on the file backend
+// Expected result: PASS
+TEST_F(FileSystemTest, UpdateEntityIsAtomicFile) {
+    FileSystem store(data_path);
+    increment_concurrently(store);
+}
+
+// Atomic updates on the log backend
+// Expected result: PASS
+TEST_F(FileSystemTest, UpdateEntityIsAtomicLog) {
+    LogFileSystem store(data_path + "/update_log");
+    increment_concurrently(store);
+}
+
+// Atomic updates on the memory backend
+// Expected result: PASS
+TEST_F(FileSystemTest, UpdateEntityIsAtomicMemory) {
+    MemoryFileSystem store(data_path);
+    increment_concurrently(store);
+}
+
+// Atomic updates with durable writes, which retry when another write gets in first
+// Expected result: PASS
+TEST_F(FileSystemTest, UpdateEntityIsAtomicDurable) {
+    // A no-op flush keeps the test fast; the retry logic is what's being checked
+    FileSystem store(data_path, std::make_shared<GroupCommit>([]() { return true; }, std::chrono::microseconds(0)));
+    increment_concurrently(store);
+}
+
+// A durable create-then-write costs two group commits, and the entity's lock isn't held
+// while they're waited on
+// Expected result: PASS
+TEST_F(FileSystemTest, DurableWriteReleasesLockDuringCommit) {
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<bool> block{false};
+    std::atomic<bool> waiting{false};
+    auto commit = std::make_shared<GroupCommit>([&block, &waiting, released]() {
+        if (block) {
+            waiting = true;
+            released.wait();
+        }
+        return true;
+    }, std::chrono::microseconds(0));
+    FileSystem store(data_path, commit);
+
+    auto [created, id] = store.create_entity("Shoes");
+    ASSERT_TRUE(created);
+    EXPECT_TRUE(store.write_entity("Shoes", id, "{\"size\": 9}"));
+    EXPECT_EQ(commit->stats().requests, 2u);
+
+    block = true;
+    std::thread writer([&store, &id = id]() { EXPECT_TRUE(store.write_entity("Shoes", id, "{\"size\": 10}")); });
+    while (!waiting) {
+        std::this_thread::yield();
+    }
+    // The writer is parked in a commit; reads of the entity must not wait for it
+    auto read = std::async(std::launch::async, [&store, &id = id]() { return store.read_entity("Shoes", id).second; });
+    EXPECT_EQ(read.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    release.set_value();
+    writer.join();
+    EXPECT_EQ(store.read_entity("Shoes", id).second, "{\"size\": 10}");
+}
+
+// --------- Unhappy path tests ---------
+
+// Durable writes still require an existing entity
+// Expected result: PASS
+TEST_F(FileSystemTest, DurableWriteToMissingEntityFails) {
+    FileSystem store(data_path, GroupCommit::for_directory(data_path, std::chrono::microseconds(0)));
+    store.create_entity("Shoes");
+    EXPECT_FALSE(store.write_entity("Shoes", "missing", "{}"));
+}
+
+// Only "flat" and "sharded" are layouts
+// Expected result: PASS
+TEST_F(FileSystemTest, ParseLayoutRejectsUnknownValues) {
+    EXPECT_EQ(FileSystem::parse_layout("flat"), FileSystem::Layout::kFlat);
+    EXPECT_EQ(FileSystem::parse_layout("sharded"), FileSystem::Layout::kSharded);
+    EXPECT_THROW(FileSystem::parse_layout("nested"), std::invalid_argument);
+}
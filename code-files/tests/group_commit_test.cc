@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include "group_commit.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// --------- Happy path tests ---------
+
+// Concurrent callers share flushes instead of each issuing their own
+// Expected result: PASS
+TEST(GroupCommitTest, BatchesConcurrentSyncs) {
+    std::atomic<int> flushes{0};
+    GroupCommit commit([&flushes]() {
+        ++flushes;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        return true;
+    }, std::chrono::milliseconds(2));
+
+    std::vector<std::thread> writers;
+    for (int i = 0; i < 16; ++i) {
+        writers.emplace_back([&commit]() { EXPECT_TRUE(commit.sync()); });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    GroupCommit::Stats stats = commit.stats();
+    EXPECT_EQ(stats.requests, 16u);
+    EXPECT_EQ(stats.flushes, static_cast<uint64_t>(flushes.load()));
+    EXPECT_LT(stats.flushes, 16u);
+}
+
+// A sync that arrives while a flush is running waits for the next one
+// Expected result: PASS
+TEST(GroupCommitTest, LateArrivalWaitsForNextFlush) {
+    std::atomic<int> flushes{0};
+    std::atomic<bool> in_flush{false};
+    GroupCommit commit([&]() {
+        in_flush = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        in_flush = false;
+        ++flushes;
+        return true;
+    }, std::chrono::microseconds(0));
+
+    std::thread first([&commit]() { commit.sync(); });
+    while (!in_flush) {
+        std::this_thread::yield();
+    }
+    commit.sync();
+    first.join();
+    EXPECT_EQ(flushes.load(), 2);
+}
+
+// --------- Unhappy path tests ---------
+
+// Once a flush fails, every later sync reports failure
+// Expected result: PASS
+TEST(GroupCommitTest, FailureIsSticky) {
+    bool fail = true;
+    GroupCommit commit([&fail]() { return !fail; }, std::chrono::microseconds(0));
+    EXPECT_FALSE(commit.sync());
+    fail = false;
+    EXPECT_FALSE(commit.sync());
+}
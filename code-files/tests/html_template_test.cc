@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include "html_template.h"
+#include "quiz_pages.h"
+#include <stdexcept>
+
+// --------- Happy path tests ---------
+
+// Slot values are escaped and a slot may appear more than once
+// Expected result: PASS
+TEST(HtmlTemplateTest, RendersEscapedSlots) {
+    HtmlTemplate page("<a href=\"/quiz/{{id}}\">{{id}}</a><p>{{text}}</p>", {"id", "text"});
+    std::string html = page.render({"a\"b", "<You're & me>"});
+    EXPECT_EQ(html, "<a href=\"/quiz/a&quot;b\">a&quot;b</a><p>&lt;You&#39;re &amp; me&gt;</p>");
+    EXPECT_EQ(page.size({"a\"b", "<You're & me>"}), html.size());
+}
+
+// A template without slots renders as-is, including one that starts or ends with a slot
+// Expected result: PASS
+TEST(HtmlTemplateTest, RendersEdgeSlotsAndPlainText) {
+    EXPECT_EQ(HtmlTemplate("</div></body></html>", {}).render({}), "</div></body></html>");
+    EXPECT_EQ(HtmlTemplate("{{a}}-{{b}}", {"a", "b"}).render({"1", "2"}), "1-2");
+    EXPECT_EQ(HtmlTemplate("", {}).render({}), "");
+}
+
+// compose() writes several templates, repeated as needed, into one page
+// Expected result: PASS
+TEST(HtmlTemplateTest, ComposeBuildsThePage) {
+    HtmlTemplate open("<ul>", {});
+    HtmlTemplate item("<li>{{name}}</li>", {"name"});
+    HtmlTemplate close("</ul>", {});
+    std::string html = HtmlTemplate::compose([&](auto&& emit) {
+        emit(open, {});
+        for (const char* name : {"x", "y&z"}) {
+            emit(item, {name});
+        }
+        emit(close, {});
+    });
+    EXPECT_EQ(html, "<ul><li>x</li><li>y&amp;z</li></ul>");
+}
+
+// Quiz pages escape the quiz id wherever it appears
+// Expected result: PASS
+TEST(HtmlTemplateTest, QuizPagesEscapeQuizId) {
+    std::string html = render_no_result_page("x\"><script>");
+    EXPECT_NE(html.find("Oops! You didn't answer any questions."), std::string::npos);
+    EXPECT_NE(html.find("href=\"/quiz/x&quot;&gt;&lt;script&gt;\""), std::string::npos);
+    EXPECT_EQ(html.find("<script>"), std::string::npos);
+}
+
+// --------- Unhappy path tests ---------
+
+// A slot without a closing brace pair is rejected
+// Expected result: FAIL
+TEST(HtmlTemplateTest, RejectsUnterminatedSlot) {
+    EXPECT_THROW(HtmlTemplate("<p>{{title</p>", {"title"}), std::invalid_argument);
+}
+
+// A slot naming an undeclared parameter is rejected
+// Expected result: FAIL
+TEST(HtmlTemplateTest, RejectsUnknownSlot) {
+    EXPECT_THROW(HtmlTemplate("<p>{{titel}}</p>", {"title"}), std::invalid_argument);
+}
+
+// Rendering with the wrong number of values is rejected
+// Expected result: FAIL
+TEST(HtmlTemplateTest, RejectsWrongArgumentCount) {
+    HtmlTemplate page("<p>{{a}}{{b}}</p>", {"a", "b"});
+    EXPECT_THROW(page.render({"1"}), std::invalid_argument);
+    EXPECT_THROW(page.size({"1", "2", "3"}), std::invalid_argument);
+}
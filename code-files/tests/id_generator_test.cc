@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include "file_system.h"
+#include "id_generator.h"
+#include <algorithm>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+// --------- Happy path tests ---------
+
+// ULIDs use the Crockford alphabet and put the timestamp first
+// Expected result: PASS
+TEST(IdGeneratorTest, EncodesUlid) {
+    EXPECT_EQ(IdGenerator::encode_ulid(0, 0, 0), std::string(26, '0'));
+    // Timestamp from the ULID spec's example
+    EXPECT_EQ(IdGenerator::encode_ulid(1469918176385ULL, 0, 0).substr(0, 10), "01ARYZ6S41");
+    EXPECT_EQ(IdGenerator::encode_ulid(0xFFFFFFFFFFFFULL, 0xFFFF, ~0ULL), "7ZZZZZZZZZZZZZZZZZZZZZZZZZ");
+
+    std::string id = IdGenerator::ulid();
+    ASSERT_EQ(id.size(), 26u);
+    EXPECT_EQ(id.find_first_not_of("0123456789ABCDEFGHJKMNPQRSTVWXYZ"), std::string::npos);
+}
+
+// ULIDs from one thread strictly increase, even many per millisecond
+// Expected result: PASS
+TEST(IdGeneratorTest, UlidsIncreaseWithinThread) {
+    std::string previous = IdGenerator::ulid();
+    for (int i = 0; i < 100000; ++i) {
+        std::string id = IdGenerator::ulid();
+        ASSERT_LT(previous, id);
+        previous = id;
+    }
+}
+
+// Threads with their own state still never collide
+// Expected result: PASS
+TEST(IdGeneratorTest, IdsAreUniqueAcrossThreads) {
+    for (auto scheme : {IdGenerator::Scheme::kUuid, IdGenerator::Scheme::kUlid}) {
+        std::set<std::string> ids;
+        std::mutex mutex;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&]() {
+                std::vector<std::string> local;
+                for (int i = 0; i < 10000; ++i) {
+                    local.push_back(IdGenerator::next(scheme));
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                ids.insert(local.begin(), local.end());
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        EXPECT_EQ(ids.size(), 40000u);
+    }
+}
+
+// UUIDs keep the usual version 4 format
+// Expected result: PASS
+TEST(IdGeneratorTest, UuidFormat) {
+    std::string id = IdGenerator::uuid();
+    ASSERT_EQ(id.size(), 36u);
+    EXPECT_EQ(id[14], '4');
+    EXPECT_EQ(id[8], '-');
+}
+
+// With ULIDs, a sorted listing is creation order
+// Expected result: PASS
+TEST(IdGeneratorTest, UlidListingFollowsCreationOrder) {
+    const std::string data_path = "/tmp/id_generator_test";
+    fs::remove_all(data_path);
+    FileSystem store(data_path, nullptr, FileSystem::Layout::kFlat, IdGenerator::Scheme::kUlid);
+    std::vector<std::string> created;
+    for (int i = 0; i < 50; ++i) {
+        created.push_back(store.create_entity("Shoes").second);
+    }
+    std::vector<std::string> page;
+    bool more = false;
+    ASSERT_TRUE(store.list_entities_page("Shoes", "", 100, page, more));
+    EXPECT_EQ(page, created);
+    fs::remove_all(data_path);
+}
+
+// --------- Unhappy path tests ---------
+
+// Unknown schemes are rejected
+// Expected result: FAIL
+TEST(IdGeneratorTest, ParseSchemeRejectsUnknownValues) {
+    EXPECT_EQ(IdGenerator::parse_scheme("ulid"), IdGenerator::Scheme::kUlid);
+    EXPECT_THROW(IdGenerator::parse_scheme("uuidv7"), std::invalid_argument);
+}
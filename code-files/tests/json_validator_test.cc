@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "json_validator.h"
+#include <string>
+#include <vector>
+
+// --------- Happy path tests ---------
+
+// Accepts every kind of JSON value, nested and at the top level
+// Expected result: PASS
+TEST(JsonValidatorTest, AcceptsValidDocuments) {
+    std::vector<std::string> valid = {
+        "{}", "[]", "0", "-0", "12.5e-3", "1E+2", "\"\"", "true", "false", "null",
+        "  {\"a\": [1, 2, {\"b\": null}], \"c\": \"d\"}  \n",
+        "{\"name\": \"Mouse\", \"price\": 25, \"tags\": [\"usb\", \"wireless\"]}",
+        "[[[[[]]]], {}, [{}]]",
+        "\"escapes \\\" \\\\ \\/ \\b \\f \\n \\r \\t \\u00e9 \\uD83D\\uDE00\"",
+        "\"caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80\"",
+    };
+    for (const auto& doc : valid) {
+        EXPECT_TRUE(JsonValidator::validate(doc)) << doc;
+    }
+}
+
+// Long strings and indentation take the vectorized paths, including their tails
+// Expected result: PASS
+TEST(JsonValidatorTest, AcceptsLongStringsAndWhitespace) {
+    for (size_t length : {15, 16, 17, 31, 32, 33, 1000}) {
+        std::string text(length, 'a');
+        text[length / 2] = '\\';
+        text.insert(length / 2 + 1, "n");
+        std::string doc = "{\n" + std::string(length, ' ') + "\"key\": \"" + text + "\"\n}";
+        EXPECT_TRUE(JsonValidator::validate(doc)) << length;
+    }
+}
+
+// Nesting up to the limit is fine
+// Expected result: PASS
+TEST(JsonValidatorTest, AcceptsMaxDepth) {
+    std::string doc = std::string(JsonValidator::kMaxDepth, '[') + std::string(JsonValidator::kMaxDepth, ']');
+    EXPECT_TRUE(JsonValidator::validate(doc));
+}
+
+// --------- Unhappy path tests ---------
+
+// Rejects malformed documents
+// Expected result: PASS
+TEST(JsonValidatorTest, RejectsInvalidDocuments) {
+    std::vector<std::string> invalid = {
+        "", "   ", "{", "}", "[1,]", "[,1]", "{\"a\" 1}", "{\"a\": 1,}", "{a: 1}", "{\"a\": 1]",
+        "01", "1.", ".5", "-", "1e", "+1", "tru", "nul", "True", "[1 2]", "{} {}", "\"open",
+        "\"bad \\x escape\"", "\"\\u12G4\"", "\"tab\there\"", "'single'", "[\"a\"]]", "NaN",
+    };
+    for (const auto& doc : invalid) {
+        EXPECT_FALSE(JsonValidator::validate(doc)) << doc;
+    }
+}
+
+// Rejects invalid UTF-8 inside strings, even past a vectorized run
+// Expected result: PASS
+TEST(JsonValidatorTest, RejectsInvalidUtf8) {
+    std::vector<std::string> invalid = {
+        "\"\xff\"", "\"\xc3\"", "\"\xc0\xaf\"", "\"\xe0\x80\xaf\"", "\"\xed\xa0\x80\"",
+        "\"\xf4\x90\x80\x80\"", "\"0123456789abcdef\x80\"",
+    };
+    for (const auto& doc : invalid) {
+        EXPECT_FALSE(JsonValidator::validate(doc)) << doc;
+    }
+}
+
+// Rejects nesting past the limit
+// Expected result: PASS
+TEST(JsonValidatorTest, RejectsTooDeep) {
+    size_t depth = JsonValidator::kMaxDepth + 1;
+    EXPECT_FALSE(JsonValidator::validate(std::string(depth, '[') + std::string(depth, ']')));
+}
+
+// Reports where the document went wrong
+// Expected result: PASS
+TEST(JsonValidatorTest, ReportsErrorOffset) {
+    size_t offset = 0;
+    EXPECT_FALSE(JsonValidator::validate("{\"a\": [1, 2,, 3]}", &offset));
+    EXPECT_EQ(offset, 12u);
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "log_file_system.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+// Fixture giving each test an empty data directory
+class LogFileSystemTest : public ::testing::Test {
+protected:
+    const std::string data_path = "/tmp/log_file_system_test";
+
+    void SetUp() override {
+        fs::remove_all(data_path);
+    }
+
+    void TearDown() override {
+        fs::remove_all(data_path);
+    }
+};
+
+// --------- Happy path tests ---------
+
+// Create, write, read, list and delete go through the log and index
+// Expected result: PASS
+TEST_F(LogFileSystemTest, CrudRoundTrip) {
+    LogFileSystem store(data_path);
+    auto [created, id] = store.create_entity("Shoes");
+    ASSERT_TRUE(created);
+    EXPECT_TRUE(store.exists("Shoes", id));
+    EXPECT_EQ(store.read_entity("Shoes", id), std::make_pair(true, std::string("")));
+
+    EXPECT_TRUE(store.write_entity("Shoes", id, "{\"size\": 10}"));
+    EXPECT_EQ(store.read_entity("Shoes", id).second, "{\"size\": 10}");
+
+    auto [listed, ids] = store.list_entities("Shoes");
+    EXPECT_TRUE(listed);
+    EXPECT_EQ(ids, std::vector<std::string>{id});
+
+    EXPECT_TRUE(store.delete_entity("Shoes", id));
+    EXPECT_FALSE(store.exists("Shoes", id));
+    EXPECT_FALSE(store.read_entity("Shoes", id).first);
+    EXPECT_FALSE(store.delete_entity("Shoes", id));
+}
+
+// Reopening the log replays it into the same state
+// Expected result: PASS
+TEST_F(LogFileSystemTest, RecoversStateOnReopen) {
+    std::string kept, removed;
+    {
+        LogFileSystem store(data_path);
+        kept = store.create_entity("Books").second;
+        removed = store.create_entity("Books").second;
+        store.write_entity("Books", kept, "{\"v\": 1}");
+        store.write_entity("Books", kept, "{\"v\": 2}");
+        store.delete_entity("Books", removed);
+    }
+    LogFileSystem store(data_path);
+    EXPECT_EQ(store.read_entity("Books", kept).second, "{\"v\": 2}");
+    EXPECT_FALSE(store.exists("Books", removed));
+    EXPECT_EQ(store.list_entities("Books").second.size(), 1u);
+}
+
+// A checkpoint drops superseded records but keeps every live entity readable
+// Expected result: PASS
+TEST_F(LogFileSystemTest, CheckpointCompactsLog) {
+    LogFileSystem store(data_path);
+    std::string id = store.create_entity("Notes").second;
+    for (int i = 0; i < 100; ++i) {
+        store.write_entity("Notes", id, "{\"version\": " + std::to_string(i) + "}");
+    }
+    uint64_t before = store.log_size();
+    ASSERT_TRUE(store.checkpoint());
+    EXPECT_LT(store.log_size(), before / 10);
+    EXPECT_EQ(store.read_entity("Notes", id).second, "{\"version\": 99}");
+
+    // Appends after the checkpoint land in the new file and survive a reopen
+    store.write_entity("Notes", id, "{\"version\": 100}");
+    LogFileSystem reopened(data_path);
+    EXPECT_EQ(reopened.read_entity("Notes", id).second, "{\"version\": 100}");
+}
+
+// Enough dead records trigger a checkpoint on their own
+// Expected result: PASS
+TEST_F(LogFileSystemTest, CheckpointsAutomatically) {
+    LogFileSystem store(data_path, 1024);
+    std::string id = store.create_entity("Notes").second;
+    std::string payload(200, 'x');
+    for (int i = 0; i < 50; ++i) {
+        store.write_entity("Notes", id, "\"" + payload + std::to_string(i) + "\"");
+    }
+    EXPECT_LT(store.log_size(), 4096u);
+    EXPECT_EQ(store.read_entity("Notes", id).second, "\"" + payload + "49\"");
+}
+
+// --------- Unhappy path tests ---------
+
+// A torn record at the tail (crash mid-append) is truncated on recovery
+// Expected result: PASS
+TEST_F(LogFileSystemTest, TruncatesTornTail) {
+    std::string id;
+    uint64_t good_size;
+    {
+        LogFileSystem store(data_path);
+        id = store.create_entity("Cars").second;
+        store.write_entity("Cars", id, "{\"make\": \"Honda\"}");
+        good_size = store.log_size();
+    }
+    {
+        std::ofstream log(fs::path(data_path) / "entities.log", std::ios::binary | std::ios::app);
+        log << "\x12\x34\x56\x78\x01garbage";
+    }
+    LogFileSystem store(data_path);
+    EXPECT_EQ(store.log_size(), good_size);
+    EXPECT_EQ(fs::file_size(fs::path(data_path) / "entities.log"), good_size);
+    EXPECT_EQ(store.read_entity("Cars", id).second, "{\"make\": \"Honda\"}");
+}
+
+// A corrupted record stops replay at the last record that checks out
+// Expected result: PASS
+TEST_F(LogFileSystemTest, StopsAtCorruptRecord) {
+    std::string first;
+    uint64_t first_size;
+    {
+        LogFileSystem store(data_path);
+        first = store.create_entity("Cars").second;
+        first_size = store.log_size();
+        store.create_entity("Cars");
+    }
+    {
+        // Flip a byte inside the second record's payload
+        std::fstream log(fs::path(data_path) / "entities.log", std::ios::binary | std::ios::in | std::ios::out);
+        log.seekp(static_cast<std::streamoff>(first_size + 20));
+        log.put('#');
+    }
+    LogFileSystem store(data_path);
+    EXPECT_EQ(store.log_size(), first_size);
+    EXPECT_TRUE(store.exists("Cars", first));
+    EXPECT_EQ(store.list_entities("Cars").second.size(), 1u);
+}
+
+// Writes require an existing entity, like the file-per-entity backend
+// Expected result: PASS
+TEST_F(LogFileSystemTest, WriteToMissingEntityFails) {
+    LogFileSystem store(data_path);
+    EXPECT_FALSE(store.write_entity("Ghosts", "nope", "{}"));
+    EXPECT_FALSE(store.list_entities("Ghosts").first);
+}
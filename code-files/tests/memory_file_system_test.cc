@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "crud_handler.h"
+#include "memory_file_system.h"
+#include "request.h"
+#include "response.h"
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+class MemoryFileSystemTest : public ::testing::Test {
+protected:
+    const std::string data_path = "/tmp/memory_file_system_test";
+
+    void SetUp() override {
+        fs::remove_all(data_path);
+    }
+
+    void TearDown() override {
+        fs::remove_all(data_path);
+    }
+};
+
+// --------- Happy path tests ---------
+
+// A created entity is empty until written, and is gone after a delete
+// Expected result: PASS
+TEST_F(MemoryFileSystemTest, CreateWriteReadDelete) {
+    MemoryFileSystem store(data_path);
+    auto [ok, id] = store.create_entity("Shoes");
+    ASSERT_TRUE(ok);
+    EXPECT_EQ(store.read_entity("Shoes", id), std::make_pair(true, std::string()));
+    EXPECT_TRUE(store.write_entity("Shoes", id, "{\"size\": 10}"));
+    EXPECT_EQ(store.read_entity("Shoes", id).second, "{\"size\": 10}");
+    EXPECT_EQ(store.list_entities("Shoes").second, std::vector<std::string>{id});
+
+    EXPECT_TRUE(store.delete_entity("Shoes", id));
+    EXPECT_FALSE(store.exists("Shoes", id));
+    EXPECT_TRUE(store.list_entities("Shoes").second.empty());
+    EXPECT_FALSE(fs::exists(data_path));
+}
+
+// Types are listed in name order, and ids are generated with the configured scheme
+// Expected result: PASS
+TEST_F(MemoryFileSystemTest, ListsTypesAndUsesIdScheme) {
+    MemoryFileSystem store(data_path, IdGenerator::Scheme::kUlid);
+    bool created = false;
+    store.put_entity("Shoes", "a", "{}", created);
+    store.put_entity("Cars", "b", "{}", created);
+    EXPECT_EQ(store.list_entity_types(), (std::vector<std::string>{"Cars", "Shoes"}));
+    // ULIDs are 26 characters
+    EXPECT_EQ(store.create_entity("Cars").second.size(), 26u);
+}
+
+// Handlers created with storage memory share one store per data path and write no files
+// Expected result: PASS
+TEST_F(MemoryFileSystemTest, CrudHandlerUsesSharedStore) {
+    std::unordered_map<std::string, std::string> args = {{"data_path", data_path}, {"storage", "memory"}};
+    request req;
+    req.method = "PUT";
+    req.uri = "/api/Shoes/s1";
+    req.body = "{\"size\": 10}";
+    EXPECT_EQ(CrudHandler::create(args)->handle_request(req)->status_code, 201);
+
+    req.method = "GET";
+    auto res = CrudHandler::create(args)->handle_request(req);
+    EXPECT_EQ(res->status_code, 200);
+    EXPECT_EQ(res->body, "{\"size\": 10}");
+    EXPECT_TRUE(MemoryFileSystem::shared(data_path)->exists("Shoes", "s1"));
+    EXPECT_FALSE(fs::exists(fs::path(data_path) / "Shoes"));
+}
+
+// --------- Unhappy path tests ---------
+
+// Writes and deletes of entities that don't exist fail without creating them
+// Expected result: FAIL
+TEST_F(MemoryFileSystemTest, MissingEntitiesFail) {
+    MemoryFileSystem store(data_path);
+    EXPECT_FALSE(store.write_entity("Shoes", "missing", "{}"));
+    EXPECT_FALSE(store.delete_entity("Shoes", "missing"));
+    EXPECT_FALSE(store.read_entity("Shoes", "missing").first);
+    EXPECT_FALSE(store.list_entities("Shoes").first);
+    EXPECT_TRUE(store.list_entity_types().empty());
+}
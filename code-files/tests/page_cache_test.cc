@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "page_cache.h"
+#include "quiz_handler.h"
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+class PageCacheTest : public ::testing::Test {
+protected:
+    const fs::path quiz_root = fs::temp_directory_path() / "page_cache_test";
+
+    void SetUp() override {
+        fs::remove_all(quiz_root);
+        fs::create_directories(quiz_root);
+    }
+
+    void TearDown() override {
+        fs::remove_all(quiz_root);
+    }
+
+    request get(const std::string& uri) {
+        request req;
+        req.method = "GET";
+        req.uri = uri;
+        req.http_version = "HTTP/1.1";
+        return req;
+    }
+};
+
+// --------- Happy path tests ---------
+
+// A page is rendered once per source object
+// Expected result: PASS
+TEST_F(PageCacheTest, RendersOncePerSource) {
+    PageCache cache;
+    int renders = 0;
+    auto render = [&renders]() { return "<p>" + std::to_string(++renders) + "</p>"; };
+    auto source = std::make_shared<int>(1);
+
+    auto page = cache.get("/quiz", source, render);
+    EXPECT_EQ(cache.get("/quiz", source, render), page);
+    EXPECT_EQ(page->body, "<p>1</p>");
+    EXPECT_EQ(page->content_length, "8");
+    EXPECT_EQ(renders, 1);
+
+    auto changed = cache.get("/quiz", std::make_shared<int>(1), render);
+    EXPECT_EQ(changed->body, "<p>2</p>");
+    EXPECT_NE(changed->etag, page->etag);
+    EXPECT_EQ(cache.size(), 1u);
+}
+
+// serve_page answers a matching If-None-Match with a bodyless 304
+// Expected result: PASS
+TEST_F(PageCacheTest, ServePageHonorsIfNoneMatch) {
+    RenderedPage page("<p>quiz</p>");
+    request req = get("/quiz");
+    response res;
+    serve_page(req, page, res);
+    EXPECT_EQ(res.status_code, 200);
+    EXPECT_EQ(res.body, "<p>quiz</p>");
+    EXPECT_EQ(res.headers["Content-Length"], "11");
+    EXPECT_EQ(res.headers["ETag"], page.etag);
+
+    req.headers["If-None-Match"] = page.etag;
+    response not_modified;
+    serve_page(req, page, not_modified);
+    EXPECT_EQ(not_modified.status_code, 304);
+    EXPECT_TRUE(not_modified.body.empty());
+}
+
+// QuizHandler's listing keeps its ETag until the set of quizzes changes
+// Expected result: PASS
+TEST_F(PageCacheTest, QuizListingChangesWithQuizSet) {
+    std::ofstream(quiz_root / "dining.json") << "{\"title\": \"Dining\"}";
+    auto first = QuizHandler(quiz_root.string()).handle_request(get("/quiz"));
+    ASSERT_EQ(first->status_code, 200);
+    auto again = QuizHandler(quiz_root.string()).handle_request(get("/quiz"));
+    EXPECT_EQ(again->headers["ETag"], first->headers["ETag"]);
+
+    std::ofstream(quiz_root / "majors.json") << "{\"title\": \"Majors\"}";
+    auto added = QuizHandler(quiz_root.string()).handle_request(get("/quiz"));
+    EXPECT_NE(added->headers["ETag"], first->headers["ETag"]);
+    EXPECT_NE(added->body.find("/quiz/majors"), std::string::npos);
+}
+
+// --------- Unhappy path tests ---------
+
+// A stale ETag gets the full quiz page, not a 304
+// Expected result: FAIL
+TEST_F(PageCacheTest, StaleEtagGetsFullPage) {
+    std::ofstream(quiz_root / "dining.json") << "{\"title\": \"Dining\"}";
+    request req = get("/quiz/dining");
+    req.headers["If-None-Match"] = "\"0000000000000000\"";
+    auto res = QuizHandler(quiz_root.string()).handle_request(req);
+    EXPECT_EQ(res->status_code, 200);
+    EXPECT_NE(res->body.find("Dining"), std::string::npos);
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include "quiz_catalog.h"
+#include "quiz_handler.h"
+#include "request.h"
+#include "response.h"
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+class QuizCatalogTest : public ::testing::Test {
+protected:
+    const fs::path quiz_root = fs::temp_directory_path() / "quiz_catalog_test";
+
+    void SetUp() override {
+        fs::remove_all(quiz_root);
+        fs::create_directories(quiz_root);
+    }
+
+    void TearDown() override {
+        fs::remove_all(quiz_root);
+    }
+
+    void write_quiz(const std::string& id, const std::string& title) {
+        std::ofstream file(quiz_root / (id + ".json"));
+        file << R"({"title": ")" << title << R"(", "questions": [{"prompt": "Pick one", "image": "q0.jpg",
+            "options": [{"text": "BPlate", "value": "bplate"}]}],
+            "results": {"bplate": {"title": "You're B-Plate!", "description": "On top of everything."}}})";
+    }
+};
+
+// --------- Happy path tests ---------
+
+// Quiz JSON is reduced to the fields the pages render, with missing ones empty
+// Expected result: PASS
+TEST_F(QuizCatalogTest, ParseKeepsRenderedFields) {
+    Quiz quiz = QuizCatalog::parse(R"({"title": "Dining", "questions": [{"prompt": "Pick one", "image": "q0.jpg",
+        "options": [{"text": "BPlate", "value": "bplate"}]}],
+        "results": {"bplate": {"title": "You're B-Plate!", "description": "On top of everything."}}})");
+    EXPECT_EQ(quiz.title, "Dining");
+    ASSERT_EQ(quiz.questions.size(), 1u);
+    EXPECT_EQ(quiz.questions[0].image, "q0.jpg");
+    ASSERT_EQ(quiz.questions[0].options.size(), 1u);
+    EXPECT_EQ(quiz.questions[0].options[0].value, "bplate");
+    EXPECT_EQ(quiz.results.at("bplate").title, "You're B-Plate!");
+    EXPECT_TRUE(quiz.results.at("bplate").image.empty());
+
+    EXPECT_TRUE(QuizCatalog::parse("{}").questions.empty());
+}
+
+// Repeated lookups share one parsed quiz until the file changes or is invalidated
+// Expected result: PASS
+TEST_F(QuizCatalogTest, ReloadsOnlyWhenChanged) {
+    write_quiz("dining", "Dining");
+    QuizCatalog catalog(quiz_root.string());
+    auto first = catalog.find("dining");
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(catalog.find("dining"), first);
+
+    write_quiz("dining", "Dining Halls");
+    auto rewritten = catalog.find("dining");
+    ASSERT_NE(rewritten, first);
+    EXPECT_EQ(rewritten->title, "Dining Halls");
+
+    catalog.invalidate("dining");
+    auto reloaded = catalog.find("dining");
+    EXPECT_NE(reloaded, rewritten);
+    EXPECT_EQ(reloaded->title, "Dining Halls");
+}
+
+// The listing follows the directory, in id order, and stays the same object while it doesn't change
+// Expected result: PASS
+TEST_F(QuizCatalogTest, ListFollowsDirectory) {
+    write_quiz("majors", "Majors");
+    write_quiz("dining", "Dining");
+    std::ofstream(quiz_root / "dining.jpg") << "jpg";
+    QuizCatalog catalog(quiz_root.string());
+    auto quizzes = catalog.list();
+    ASSERT_EQ(quizzes->size(), 2u);
+    EXPECT_EQ((*quizzes)[0].id, "dining");
+    EXPECT_TRUE((*quizzes)[0].has_image);
+    EXPECT_FALSE((*quizzes)[1].has_image);
+    EXPECT_EQ(catalog.list(), quizzes);
+
+    fs::remove(quiz_root / "majors.json");
+    EXPECT_EQ(catalog.list()->size(), 1u);
+}
+
+// QuizHandler serves quiz pages from the shared catalog
+// Expected result: PASS
+TEST_F(QuizCatalogTest, QuizHandlerUsesSharedCatalog) {
+    write_quiz("dining", "Dining");
+    request req;
+    req.method = "GET";
+    req.uri = "/quiz/dining";
+    auto res = QuizHandler(quiz_root.string()).handle_request(req);
+    EXPECT_EQ(res->status_code, 200);
+    EXPECT_NE(res->body.find("Dining"), std::string::npos);
+    EXPECT_NE(QuizCatalog::shared(quiz_root.string())->find("dining"), nullptr);
+}
+
+// --------- Unhappy path tests ---------
+
+// A missing quiz is nullptr; a malformed one throws
+// Expected result: FAIL
+TEST_F(QuizCatalogTest, MissingAndMalformedQuizzes) {
+    QuizCatalog catalog(quiz_root.string());
+    EXPECT_EQ(catalog.find("unknown"), nullptr);
+
+    std::ofstream(quiz_root / "broken.json") << "{ invalid json ";
+    EXPECT_THROW(catalog.find("broken"), std::runtime_error);
+    EXPECT_THROW(QuizCatalog::parse(R"({"questions": 5})"), std::runtime_error);
+
+    QuizCatalog missing_root((quiz_root / "missing").string());
+    EXPECT_THROW(missing_root.list(), std::filesystem::filesystem_error);
+}
+
+// Aliases of a quiz's id, and ids reaching outside quiz_root, find nothing
+// Expected result: FAIL
+TEST_F(QuizCatalogTest, RejectsAliasedIds) {
+    write_quiz("dining", "Dining");
+    fs::create_directories(quiz_root / "sub");
+    write_quiz("sub/nested", "Nested");
+    QuizCatalog catalog(quiz_root.string());
+    ASSERT_NE(catalog.find("dining"), nullptr);
+    for (const char* id : {"./dining", ".//dining", "././dining", "sub/nested", "../quiz_catalog_test/dining",
+                           ".hidden", ""}) {
+        EXPECT_EQ(catalog.find(id), nullptr) << id;
+        EXPECT_FALSE(QuizCatalog::valid_id(id)) << id;
+    }
+}
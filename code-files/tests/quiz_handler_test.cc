@@ -1,5 +1,6 @@
 #include "gtest/gtest.h"
 #include "quiz_handler.h"
+#include "page_cache.h"
 #include "request.h"
 #include "response.h"
 
@@ -85,6 +86,22 @@ TEST_F(QuizHandlerTest, NonexistentQuizReturns404) {
     EXPECT_EQ(res->body, "Quiz not found.");
 }
 
+// Test that aliases of a quiz id get a 404 rather than another cached copy of its page
+TEST_F(QuizHandlerTest, AliasedQuizIdReturns404) {
+    write_quiz_json(temp_dir / "dining.json");
+    QuizHandler handler(temp_dir.string());
+    auto pages = PageCache::shared(std::filesystem::canonical(temp_dir).string());
+    EXPECT_EQ(handler.handle_request(make_get_request("/quiz/dining"))->status_code, 200);
+    size_t cached = pages->size();
+
+    for (const char* uri : {"/quiz/./dining", "/quiz/.//dining", "/quiz/././dining", "/quiz/"}) {
+        auto res = handler.handle_request(make_get_request(uri));
+        EXPECT_EQ(res->status_code, 404) << uri;
+        EXPECT_EQ(res->body, "Quiz not found.");
+    }
+    EXPECT_EQ(pages->size(), cached);
+}
+
 // Test that invalid JSON in a quiz file results in a 500 Internal Server Error
 TEST_F(QuizHandlerTest, MalformedQuizJsonReturns500) {
     std::ofstream file(temp_dir / "broken.json");
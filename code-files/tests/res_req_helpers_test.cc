@@ -50,4 +50,55 @@ TEST(SessionTestFixture, SerializeResponseBasic) {
 
     // Expected Result: PASS if calling the serialize response function from res_req_helpers.h is the same as the format shown right above
     EXPECT_EQ(serialize_response(res), expected_response);
-}
\ No newline at end of file
+}
+// header lookup ignores case
+TEST(ResReqHelpersTest, GetHeaderIsCaseInsensitive) {
+    request req;
+    req.headers["accept-encoding"] = "gzip";
+    // Expected Result: PASS if the header is found regardless of case
+    EXPECT_EQ(get_header(req, "Accept-Encoding"), "gzip");
+    // Expected Result: PASS if a missing header yields an empty string
+    EXPECT_EQ(get_header(req, "If-None-Match"), "");
+}
+
+// Accept-Encoding honors listed codings and q=0 refusals
+TEST(ResReqHelpersTest, AcceptsEncodingParsesList) {
+    request req;
+    req.headers["Accept-Encoding"] = "deflate;q=0.5, gzip , br;q=0";
+    // Expected Result: PASS if listed codings are accepted
+    EXPECT_TRUE(accepts_encoding(req, "gzip"));
+    EXPECT_TRUE(accepts_encoding(req, "deflate"));
+    // Expected Result: PASS if q=0 and unlisted codings are refused
+    EXPECT_FALSE(accepts_encoding(req, "br"));
+    EXPECT_FALSE(accepts_encoding(req, "zstd"));
+}
+
+// Accept-Encoding prefers an explicit coding over *, wherever each appears
+TEST(ResReqHelpersTest, AcceptsEncodingPrefersExplicitCoding) {
+    request req;
+    req.headers["Accept-Encoding"] = "*;q=0, gzip";
+    // Expected Result: PASS if gzip is accepted despite the earlier *;q=0
+    EXPECT_TRUE(accepts_encoding(req, "gzip"));
+    EXPECT_FALSE(accepts_encoding(req, "br"));
+
+    req.headers["Accept-Encoding"] = "gzip;q=0, *";
+    // Expected Result: PASS if gzip;q=0 refuses gzip even though * comes later
+    EXPECT_FALSE(accepts_encoding(req, "gzip"));
+    EXPECT_TRUE(accepts_encoding(req, "br"));
+
+    req.headers["Accept-Encoding"] = "gzip; q=0.0";
+    // Expected Result: PASS if q=0 with whitespace before it is a refusal
+    EXPECT_FALSE(accepts_encoding(req, "gzip"));
+}
+
+// entity tag lists match by strong or weak comparison
+TEST(ResReqHelpersTest, EtagMatchesParsesList) {
+    // Expected Result: PASS if any listed tag, or *, matches
+    EXPECT_TRUE(etag_matches("\"a1\", \"b2\"", "\"b2\"", false));
+    EXPECT_TRUE(etag_matches("*", "\"b2\"", false));
+    EXPECT_TRUE(etag_matches("W/\"b2\"", "\"b2\"", true));
+    // Expected Result: PASS if weak tags fail a strong comparison and other tags never match
+    EXPECT_FALSE(etag_matches("W/\"b2\"", "\"b2\"", false));
+    EXPECT_FALSE(etag_matches("\"a1\"", "\"b2\"", true));
+    EXPECT_FALSE(etag_matches("", "\"b2\"", true));
+}
@@ -1,5 +1,6 @@
 #include "gtest/gtest.h"
 #include "result_handler.h"
+#include "page_cache.h"
 #include "request.h"
 #include "response.h"
 
@@ -124,3 +125,58 @@ TEST_F(ResultHandlerTest, NoAnswersReturnsFriendlyMessage) {
     EXPECT_NE(res->body.find("/quiz/dining"), std::string::npos);
 }
 
+
+// Test that a submission and its share link serve the same memoized page, and a repeat share-link GET gets a 304
+TEST_F(ResultHandlerTest, ShareLinkServesMemoizedResultPage) {
+    write_ucla_dining_quiz_json(temp_dir / "dining.json");
+
+    auto submitted = ResultHandler(temp_dir.string()).handle_request(make_post_request("quiz_id=dining&q1=bplate"));
+    ASSERT_EQ(submitted->status_code, 200);
+    EXPECT_FALSE(submitted->headers["ETag"].empty());
+
+    request share = make_post_request("");
+    share.method = "GET";
+    share.uri = "/quiz/submit?quiz_id=dining&result=bplate";
+    auto shared = ResultHandler(temp_dir.string()).handle_request(share);
+    EXPECT_EQ(shared->status_code, 200);
+    EXPECT_EQ(shared->body, submitted->body);
+    EXPECT_EQ(shared->headers["ETag"], submitted->headers["ETag"]);
+
+    share.headers["If-None-Match"] = shared->headers["ETag"];
+    auto repeat = ResultHandler(temp_dir.string()).handle_request(share);
+    EXPECT_EQ(repeat->status_code, 304);
+    EXPECT_TRUE(repeat->body.empty());
+}
+
+// Test that a share link for a result the quiz doesn't define returns 404
+TEST_F(ResultHandlerTest, ShareLinkForUnknownResultReturns404) {
+    write_ucla_dining_quiz_json(temp_dir / "dining.json");
+
+    request share = make_post_request("");
+    share.method = "GET";
+    share.uri = "/quiz/submit?quiz_id=dining&result=covel";
+    auto res = ResultHandler(temp_dir.string()).handle_request(share);
+    EXPECT_EQ(res->status_code, 404);
+    EXPECT_EQ(res->body, "Result not found in quiz.");
+}
+
+// Test that aliases of a quiz id, submitted or shared, get a 404 and render nothing
+TEST_F(ResultHandlerTest, AliasedQuizIdReturns404) {
+    write_ucla_dining_quiz_json(temp_dir / "dining.json");
+    ResultHandler handler(temp_dir.string());
+    auto pages = PageCache::shared(std::filesystem::canonical(temp_dir).string());
+    ASSERT_EQ(handler.handle_request(make_post_request("quiz_id=dining&q1=bplate"))->status_code, 200);
+    size_t cached = pages->size();
+
+    for (const char* alias : {"./dining", ".//dining", "././dining"}) {
+        auto res = handler.handle_request(make_post_request(std::string("quiz_id=") + alias + "&q1=bplate"));
+        EXPECT_EQ(res->status_code, 404) << alias;
+        EXPECT_EQ(res->body, "Quiz not found.");
+
+        request share = make_post_request("");
+        share.method = "GET";
+        share.uri = std::string("/quiz/submit?quiz_id=") + alias + "&result=bplate";
+        EXPECT_EQ(handler.handle_request(share)->status_code, 404) << alias;
+    }
+    EXPECT_EQ(pages->size(), cached);
+}
@@ -1,11 +1,15 @@
 #include <gtest/gtest.h>
 #include <boost/asio.hpp>
+#include <algorithm>
+#include <filesystem>
 #include <thread>
 #include <string>
 #include "session.h"
 #include "request_handler_factory.h"
 #include "trie.h"
 #include "not_found_handler.h"
+#include "crud_handler.h"
+#include "file_system.h"
 #include <boost/log/sinks/text_ostream_backend.hpp>
 #include <boost/log/sinks/sync_frontend.hpp>
 #include <boost/log/expressions.hpp>
@@ -70,10 +74,17 @@ protected:
 
 
 
+      ConfigStruct* crudConfig = new ConfigStruct;
+      crudConfig->uri = "/api";
+      crudConfig->handler = "CrudHandler";
+      crudConfig->args["data_path"] = "/tmp/session_test_crud";
+      trie_root->insert(crudConfig->uri, crudConfig);
+
       RequestHandlerFactory factory;
       factory.register_factory("EchoHandler", &EchoHandler::create);
       factory.register_factory("StaticFileHandler", &StaticFileHandler::create);
       factory.register_factory("NotFoundHandler", &NotFoundHandler::create);
+      factory.register_factory("CrudHandler", &CrudHandler::create);
 
       // Move factory and trie_root into lambda capture
       acceptor.async_accept([&server_io, trie_root, &factory](const boost::system::error_code& error, tcp::socket peer_socket) {
@@ -217,6 +228,101 @@ TEST_F(SessionTestFixture, LongestPrefixWins) {
   EXPECT_TRUE(response.find("This is from static-longer") != std::string::npos);
 }
 
+// Waits for the whole Content-Length body even when it spans many reads
+// Expected result: PASS
+TEST_F(SessionTestFixture, ReadsBodyUpToContentLength) {
+  std::string body(100000, 'x');
+  body += "END";
+  const std::string request =
+      "POST /echo HTTP/1.1\r\n"
+      "Host: localhost\r\n"
+      "Content-Length: " + std::to_string(body.size()) + "\r\n"
+      "\r\n";
+  boost::asio::write(socket, boost::asio::buffer(request));
+  // Send the body in pieces so the server sees the headers before all of it
+  boost::asio::write(socket, boost::asio::buffer(body.data(), 5000));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  boost::asio::write(socket, boost::asio::buffer(body.data() + 5000, body.size() - 5000));
+
+  boost::system::error_code ec;
+  boost::asio::streambuf response_buf;
+  boost::asio::read(socket, response_buf, ec);
+  std::string response((std::istreambuf_iterator<char>(&response_buf)), std::istreambuf_iterator<char>());
+  EXPECT_NE(response.find("200 OK"), std::string::npos);
+  EXPECT_NE(response.find(body), std::string::npos);
+}
+
+// Streams a listing with chunked transfer encoding
+// Expected result: PASS
+TEST_F(SessionTestFixture, StreamsChunkedListing) {
+  FileSystem store("/tmp/session_test_crud");
+  for (int i = 0; i < 1500; ++i) {
+    bool created = false;
+    store.put_entity("Streamed", "id" + std::to_string(10000 + i), "{}", created);
+  }
+
+  const std::string request =
+      "GET /api/Streamed?stream=true HTTP/1.1\r\n"
+      "Host: localhost\r\n"
+      "\r\n";
+  boost::asio::write(socket, boost::asio::buffer(request));
+  boost::system::error_code ec;
+  boost::asio::streambuf response_buf;
+  boost::asio::read(socket, response_buf, ec); // until the server closes
+  std::string response((std::istreambuf_iterator<char>(&response_buf)), std::istreambuf_iterator<char>());
+  std::filesystem::remove_all("/tmp/session_test_crud");
+
+  size_t header_end = response.find("\r\n\r\n");
+  ASSERT_NE(header_end, std::string::npos);
+  EXPECT_NE(response.find("Transfer-Encoding: chunked"), std::string::npos);
+
+  // Reassemble the chunks
+  std::string body;
+  size_t pos = header_end + 4;
+  while (true) {
+    size_t line_end = response.find("\r\n", pos);
+    ASSERT_NE(line_end, std::string::npos);
+    size_t size = std::stoul(response.substr(pos, line_end - pos), nullptr, 16);
+    if (size == 0) {
+      break;
+    }
+    body += response.substr(line_end + 2, size);
+    pos = line_end + 2 + size + 2;
+  }
+  EXPECT_EQ(body.substr(0, 18), "[\"id10000\", \"id100");
+  EXPECT_EQ(body.substr(body.size() - 11), "\"id11499\"]\n");
+  EXPECT_EQ(std::count(body.begin(), body.end(), ','), 1499);
+}
+
+// Pushes changes to an event stream as they happen
+// Expected result: PASS
+TEST_F(SessionTestFixture, StreamsChangeEvents) {
+  const std::string request =
+      "GET /api/Events/_changes?feed=eventsource&since=now&heartbeat=100 HTTP/1.1\r\n"
+      "Host: localhost\r\n"
+      "\r\n";
+  boost::asio::write(socket, boost::asio::buffer(request));
+  boost::asio::streambuf response_buf;
+  boost::asio::read_until(socket, response_buf, "\r\n\r\n");
+
+  // Write from another handler on the same data path while the stream is parked
+  auto handler = CrudHandler::create({{"data_path", "/tmp/session_test_crud"}});
+  struct request put;
+  put.method = "PUT";
+  put.uri = "/api/Events/e1";
+  put.body = "{}";
+  EXPECT_EQ(handler->handle_request(put)->status_code, 201);
+
+  boost::asio::read_until(socket, response_buf, "event: change");
+  boost::asio::read_until(socket, response_buf, "\n\n");
+  std::string response((std::istreambuf_iterator<char>(&response_buf)), std::istreambuf_iterator<char>());
+  std::filesystem::remove_all("/tmp/session_test_crud");
+
+  EXPECT_NE(response.find("Content-Type: text/event-stream"), std::string::npos);
+  EXPECT_NE(response.find("Transfer-Encoding: chunked"), std::string::npos);
+  EXPECT_NE(response.find("\"id\": \"e1\", \"deleted\": false}"), std::string::npos);
+}
+
 // Logs ResponseMetrics Line
 // Expected result: PASS. Correct information is given in log. 
 TEST_F(SessionTestFixture, LogsResponseMetricsLine) {
@@ -1,7 +1,14 @@
 #include <gtest/gtest.h>
 #include "static_file_handler.h"
+#include "asset_manifest.h"
 #include "request.h"
 #include "response.h"
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 // Fixture for StaticFileHandler tests
 class StaticFileHandlerTest : public ::testing::Test {
@@ -218,3 +225,252 @@ TEST_F(StaticFileHandlerTest, ServesJpgFile) {
     EXPECT_EQ(data[0], 0xFF);
     EXPECT_EQ(data[1], 0xD8);
 }
+
+// checks that repeated 404 probes are answered from a negative cache entry
+// Expected result: PASS
+TEST(StaticFileHandlerOpenFileCacheTest, CachesMissingFiles) {
+    std::filesystem::path root = std::filesystem::temp_directory_path() / "static_negative_cache_test";
+    std::filesystem::create_directories(root);
+    StaticFileHandler handler("/static", root.string(), 16, std::chrono::seconds(60));
+    auto cache = OpenFileCache::shared(root.string(), 16, std::chrono::seconds(60));
+
+    request req;
+    req.method = "GET";
+    req.uri = "/static/wp-login.php";
+    req.http_version = "HTTP/1.1";
+
+    EXPECT_EQ(handler.handle_request(req)->status_code, 404);
+    OpenFileCache::Stats first = cache->stats();
+    EXPECT_EQ(handler.handle_request(req)->status_code, 404);
+    OpenFileCache::Stats second = cache->stats();
+
+    EXPECT_EQ(second.hits, first.hits + 1);
+    EXPECT_EQ(second.syscalls, first.syscalls);
+    std::filesystem::remove_all(root);
+}
+
+// checks that a changed file is picked up once its cache entry expires
+// Expected result: PASS
+TEST(StaticFileHandlerOpenFileCacheTest, RevalidatesChangedFiles) {
+    std::filesystem::path root = std::filesystem::temp_directory_path() / "static_revalidate_test";
+    std::filesystem::create_directories(root);
+    std::ofstream(root / "page.txt") << "old";
+
+    // Zero validity window: every request revalidates with a stat
+    StaticFileHandler handler("/static", root.string(), 16, std::chrono::milliseconds(0));
+
+    request req;
+    req.method = "GET";
+    req.uri = "/static/page.txt";
+    req.http_version = "HTTP/1.1";
+
+    EXPECT_EQ(handler.handle_request(req)->body, "old");
+    std::filesystem::remove(root / "page.txt");
+    std::ofstream(root / "page.txt") << "new content";
+    EXPECT_EQ(handler.handle_request(req)->body, "new content");
+
+    std::filesystem::remove(root / "page.txt");
+    EXPECT_EQ(handler.handle_request(req)->status_code, 404);
+    std::filesystem::remove_all(root);
+}
+
+// checks that a FIFO under the root is answered with a 404 instead of blocking in open()
+// Expected result: FAIL
+TEST(StaticFileHandlerOpenFileCacheTest, RejectsFifo) {
+    std::filesystem::path root = std::filesystem::temp_directory_path() / "static_fifo_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    ASSERT_EQ(::mkfifo((root / "pipe").c_str(), 0644), 0);
+    StaticFileHandler handler("/static", root.string(), 16, std::chrono::seconds(60));
+
+    request req;
+    req.method = "GET";
+    req.uri = "/static/pipe";
+    req.http_version = "HTTP/1.1";
+
+    auto status = std::async(std::launch::async, [&]() { return handler.handle_request(req)->status_code; });
+    ASSERT_EQ(status.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(status.get(), 404);
+    std::filesystem::remove_all(root);
+}
+
+// checks that a fingerprinted URL serves the original file with an immutable Cache-Control
+// Expected result: PASS
+TEST(StaticFileHandlerFingerprintTest, ServesFingerprintedAssetsAsImmutable) {
+    std::filesystem::path root = std::filesystem::temp_directory_path() / "static_fingerprint_test";
+    std::filesystem::create_directories(root / "quizzes");
+    std::ofstream(root / "quizzes" / "styles.css") << "body { color: blue; }";
+
+    AssetManifest::install(std::make_shared<AssetManifest>("/assets", root.string()));
+    StaticFileHandler handler("/assets", root.string());
+
+    std::string url = AssetManifest::url("/assets/quizzes/styles.css");
+    EXPECT_NE(url, "/assets/quizzes/styles.css");
+    EXPECT_EQ(url.rfind("/assets/quizzes/styles.", 0), 0u);
+    EXPECT_EQ(url.substr(url.size() - 4), ".css");
+
+    request req;
+    req.method = "GET";
+    req.uri = url;
+    req.http_version = "HTTP/1.1";
+    std::unique_ptr<response> res = handler.handle_request(req);
+    EXPECT_EQ(res->status_code, 200);
+    EXPECT_EQ(res->body, "body { color: blue; }");
+    EXPECT_EQ(res->headers.at("Content-Type"), "text/css");
+    EXPECT_EQ(res->headers.at("Cache-Control"), AssetManifest::kImmutableCacheControl);
+
+    // The plain name still works but isn't marked immutable
+    req.uri = "/assets/quizzes/styles.css";
+    res = handler.handle_request(req);
+    EXPECT_EQ(res->status_code, 200);
+    EXPECT_EQ(res->headers.count("Cache-Control"), 0u);
+
+    AssetManifest::clear();
+    std::filesystem::remove_all(root);
+}
+
+// checks that a file changed after startup is no longer immutable under its old name and gets a new one
+// Expected result: PASS
+TEST(StaticFileHandlerFingerprintTest, ChangedFileLosesImmutability) {
+    std::filesystem::path root = std::filesystem::temp_directory_path() / "static_fingerprint_stale_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    std::ofstream(root / "app.js") << "v1";
+
+    AssetManifest::install(std::make_shared<AssetManifest>("/assets", root.string()));
+    StaticFileHandler handler("/assets", root.string(), 16, std::chrono::milliseconds(0));
+    std::string old_url = AssetManifest::url("/assets/app.js");
+
+    std::ofstream(root / "app.js") << "version two";
+    request req;
+    req.method = "GET";
+    req.uri = old_url;
+    req.http_version = "HTTP/1.1";
+    std::unique_ptr<response> res = handler.handle_request(req);
+    EXPECT_EQ(res->status_code, 200);
+    EXPECT_EQ(res->body, "version two");
+    EXPECT_EQ(res->headers.count("Cache-Control"), 0u);
+
+    // The new contents get a new name, which is immutable again
+    std::string new_url = AssetManifest::url("/assets/app.js");
+    EXPECT_NE(new_url, old_url);
+    req.uri = new_url;
+    res = handler.handle_request(req);
+    EXPECT_EQ(res->body, "version two");
+    EXPECT_EQ(res->headers.at("Cache-Control"), AssetManifest::kImmutableCacheControl);
+    req.uri = old_url;
+    EXPECT_EQ(handler.handle_request(req)->headers.count("Cache-Control"), 0u);
+
+    AssetManifest::clear();
+    std::filesystem::remove_all(root);
+}
+
+// checks that nested mount points resolve to the longest matching manifest
+// Expected result: PASS
+TEST(StaticFileHandlerFingerprintTest, UrlUsesLongestMount) {
+    std::filesystem::path root = std::filesystem::temp_directory_path() / "static_fingerprint_nested_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "inner");
+    std::ofstream(root / "inner" / "a.css") << "outer copy";
+    std::ofstream(root / "a.css") << "inner copy";
+    AssetManifest::install(std::make_shared<AssetManifest>("/assets", root.string()));
+    auto inner = std::make_shared<AssetManifest>("/assets/inner", root.string());
+    AssetManifest::install(inner);
+
+    EXPECT_EQ(AssetManifest::url("/assets/inner/a.css"), inner->fingerprinted_url("a.css"));
+    EXPECT_EQ(AssetManifest::url("/assets/inner/missing.css"), "/assets/inner/missing.css");
+
+    AssetManifest::clear();
+    std::filesystem::remove_all(root);
+}
+
+// checks that the fingerprint changes with the content and unknown URLs pass through
+// Expected result: PASS
+TEST(StaticFileHandlerFingerprintTest, FingerprintTracksContent) {
+    std::filesystem::path root = std::filesystem::temp_directory_path() / "static_fingerprint_change_test";
+    std::filesystem::create_directories(root);
+    std::ofstream(root / "app.js") << "v1";
+    AssetManifest first("/assets", root.string());
+    std::ofstream(root / "app.js") << "v2";
+    AssetManifest second("/assets", root.string());
+
+    EXPECT_NE(first.fingerprinted_url("app.js"), second.fingerprinted_url("app.js"));
+    EXPECT_EQ(first.fingerprinted_url("missing.js"), "");
+    EXPECT_EQ(AssetManifest::fingerprint_name("LICENSE", "abc"), "LICENSE.abc");
+    EXPECT_EQ(AssetManifest::fingerprint_name("a.b/.env", "abc"), "a.b/.env.abc");
+    EXPECT_EQ(AssetManifest::url("/assets/app.js"), "/assets/app.js");
+    std::filesystem::remove_all(root);
+}
+
+// checks that the async path delivers the same response whether the read runs inline or on the pool
+// Expected result: PASS
+TEST_F(StaticFileHandlerTest, AsyncReadDeliversFile) {
+    request req;
+    req.method = "GET";
+    req.uri = "/static/index.txt";
+    req.http_version = "HTTP/1.1";
+
+    std::promise<std::unique_ptr<response>> promise;
+    std::future<std::unique_ptr<response>> future = promise.get_future();
+    handler.handle_request_async(req, [&promise](std::unique_ptr<response> res) {
+        promise.set_value(std::move(res));
+    });
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+
+    std::unique_ptr<response> res = future.get();
+    std::unique_ptr<response> expected = handler.handle_request(req);
+    EXPECT_EQ(res->status_code, 200);
+    EXPECT_EQ(res->headers.at("Content-Type"), "text/plain");
+    EXPECT_EQ(res->body, expected->body);
+}
+
+// checks that a file whose tail has left the page cache still arrives whole, the pool carrying
+// on after the cached prefix the event loop already read
+// Expected result: PASS
+TEST(StaticFileHandlerAsyncTest, AsyncReadResumesPartlyCachedFile) {
+    std::filesystem::path root = std::filesystem::temp_directory_path() / "static_partly_cached_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    std::string contents;
+    for (int i = 0; contents.size() < (1 << 20); ++i) {
+        contents += "line " + std::to_string(i) + "\n";
+    }
+    std::ofstream(root / "big.txt", std::ios::binary) << contents;
+    int fd = ::open((root / "big.txt").c_str(), O_RDONLY);
+    ASSERT_GE(fd, 0);
+    ::fsync(fd);
+    // Drops the second half where the filesystem allows it; either way the body must be whole
+    ::posix_fadvise(fd, contents.size() / 2, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+    StaticFileHandler handler("/static", root.string(), 16, std::chrono::seconds(60));
+
+    request req;
+    req.method = "GET";
+    req.uri = "/static/big.txt";
+    req.http_version = "HTTP/1.1";
+
+    std::promise<std::unique_ptr<response>> promise;
+    std::future<std::unique_ptr<response>> future = promise.get_future();
+    handler.handle_request_async(req, [&promise](std::unique_ptr<response> res) {
+        promise.set_value(std::move(res));
+    });
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    std::unique_ptr<response> res = future.get();
+    EXPECT_EQ(res->status_code, 200);
+    EXPECT_EQ(res->body, contents);
+    std::filesystem::remove_all(root);
+}
+
+// checks that a missing file completes before handle_request_async returns
+// Expected result: PASS
+TEST_F(StaticFileHandlerTest, AsyncMissingFileCompletesInline) {
+    request req;
+    req.method = "GET";
+    req.uri = "/static/missing.txt";
+    req.http_version = "HTTP/1.1";
+
+    std::unique_ptr<response> res;
+    handler.handle_request_async(req, [&res](std::unique_ptr<response> done) { res = std::move(done); });
+    ASSERT_NE(res, nullptr);
+    EXPECT_EQ(res->status_code, 404);
+}